@@ -0,0 +1,937 @@
+/**
+ * SuperPico Digital - host-native pipeline simulation
+ *
+ * Runs the real capture loop (video_capture_run on "Core 0"), the real
+ * scanline/vsync callbacks and audio_pipeline_process (on "Core 1", driven
+ * by the simulated HDMI scanout) against a synthetic SNES PPU2/S-DSP, then
+ * reports frame rate, dropped/corrupt lines and audio underruns.
+ *
+ * Usage: superpico-host-sim [--mode 480p|240p|720p] [--frames N]
+ *                           [--warmup N] [--check] [--bench]
+ *                           [--interlace] [--deinterlace weave|bob] [--pal]
+ *                           [--overscan] [--dropout MS]
+ *                           [--calibrate] [--skew NS] [--first-dot N]
+ *                           [--scaler integer|square|8:7|4:3]
+ *                           [--latency low|frame|safe|race]
+ *
+ * --dropout freezes the console for MS milliseconds a third of the way into
+ * the run (mid-frame, mid-line). The check then wants the no-signal screen
+ * once capture has had time to notice, a single signal loss, and a relock
+ * within SIM_RELOCK_BUDGET_FRAMES source frames of the console coming back;
+ * output frames in between are not checked, nor, for an interlaced source,
+ * the fields field detection takes to lock again. The outage also moves the
+ * console against the output, as on hardware; a 239-line PAL source can land
+ * where the line ring has too little slack and the reader catches up with one
+ * tear per frame.
+ *
+ * --skew and --first-dot model a console whose colour lines settle later, or
+ * whose first pixel follows HBLANK by a different dot count, than the
+ * capture program's default phase expects (see snes_signal_gen.h). With
+ * --calibrate the run starts with an eye scan; the check then wants the scan
+ * to finish on the bus's first dot with a sample point inside its eye, and
+ * leaves the scan's frames (plus SIM_CALIBRATE_SETTLE_FRAMES) unchecked.
+ * Sysclk follows the output mode as in main.c, so the PIO cycle the sample
+ * delay steps by is the one the hardware would use.
+ *
+ * --scaler picks the 720p picture size. With a fill setting only output
+ * lines inside one source row are checked, at the centre pixel (which starts
+ * exactly on SNES x = 128), and hires lines show their pairs averaged.
+ *
+ * --latency frame (or safe) scans out whole frames (see video_pipeline.h):
+ * hires lines show their pairs averaged and 448i is shown as bob. The report
+ * adds the frames the pipeline dropped and repeated, which should match the
+ * checker's skipped and repeated counts. --latency race has the genlock hold
+ * scanout LATENCY_RACE_LINES behind capture; the check then wants the
+ * smallest latency of the last SIM_LATENCY_TAIL_FRAMES output frames within
+ * a line of that. Every run reports the capture-to-scanout latency and its
+ * histogram.
+ *
+ * --check judges a run of at least SIM_CHECK_MIN_FRAMES output frames and
+ * refuses shorter ones, which end before audio and the genlock have settled.
+ */
+
+#include "hardware/clocks.h"
+#include "pico/multicore.h"
+#include "pico/stdlib.h"
+
+#include "pico_hdmi/hstx_data_island_queue.h"
+#include "pico_hdmi/video_output_rt.h"
+
+#include "audio/audio_pipeline.h"
+#include "config.h"
+#include "experiments/capture_bench.h"
+#include "experiments/menu_diag_experiment.h"
+#include "osd/fast_osd.h"
+#include "video/genlock.h"
+#include "video/snes_timing.h"
+#include "video/video_capture.h"
+#include "video/video_config.h"
+#include "video/video_modes_50hz.h"
+#include "video/video_pipeline.h"
+
+#include "sim_hal.h"
+#include "sim_hdmi.h"
+#include "snes_signal_gen.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Console power-on lands mid-frame relative to Pico boot.
+#define SIM_SNES_ORIGIN_PS 1234567890ULL
+#define SIM_DEFAULT_FRAMES 600U
+#define SIM_DEFAULT_WARMUP 8U
+// --dropout: start at frames / 3 nominal 60 Hz frames plus an odd offset,
+// and how long capture may take to notice (a wait for the top of frame times
+// out after 25 ms) and to relock.
+#define SIM_DROPOUT_FRAME_PS 16683333333ULL
+#define SIM_DROPOUT_PHASE_PS 5432109876ULL
+#define SIM_DROPOUT_DETECT_PS 30000000000ULL
+#define SIM_RELOCK_BUDGET_FRAMES 3U
+#define SIM_FIELD_RELOCK_FRAMES 6U
+#define SIM_CALIBRATE_SETTLE_FRAMES 4U
+#define SIM_LATENCY_TAIL_FRAMES 60U
+// Audio unmutes about 180 output frames in (the pipeline's HSTX settle and
+// warm-up frames), and the genlock locks around then; --check refuses runs
+// too short to reach both with margin, rather than failing them.
+#define SIM_CHECK_MIN_FRAMES 300U
+
+typedef struct {
+    uint32_t frames;
+    uint32_t warmup;
+    bool check;
+    bool bench;
+    bool interlace;
+    bool pal;
+    bool overscan;
+    uint32_t dropout_ms;
+    bool calibrate;
+    uint32_t skew_ns;
+    uint32_t first_dot;
+#if ENABLE_INTERLACE
+    video_pipeline_deinterlace_t deinterlace;
+#endif
+    video_pipeline_scaler_t scaler;
+    video_pipeline_latency_t latency;
+    video_pipeline_reboot_mode_t mode;
+} sim_options_t;
+
+typedef struct {
+    uint64_t lines_checked;
+    uint64_t lines_dropped;
+    uint64_t lines_corrupt;
+    uint64_t frames_checked;
+    uint64_t frames_torn;
+    uint64_t frames_repeated;
+    uint64_t frames_skipped;
+    uint64_t audio_underruns;
+    uint64_t audio_di_last;
+    bool audio_seen_running;
+    bool audio_streaming; // as of the last output frame
+    int32_t frame_g5;       // source frame id seen on the current output frame
+    int32_t prev_frame_g5;
+    int32_t frame_top;      // --overscan: canvas row of SNES line 0 on this output frame
+    uint32_t frame_lines;   // --overscan: source height the pipeline centred for
+    uint64_t frames_recentred_late;
+    uint64_t frames_miscentred;
+    uint64_t host_start_ns;
+    uint64_t sim_start_ps;
+    // --dropout
+    uint64_t dropout_start_ps;
+    uint64_t dropout_end_ps;
+    uint64_t frame_start_ps; // current output frame
+    uint64_t frame_ps;       // output frame period
+    bool frame_unchecked;    // straddles the outage or the relock
+    bool frame_no_signal;    // inside the outage: must be the no-signal screen
+    uint64_t no_signal_lines;
+    uint64_t frozen_lines;
+    // --calibrate
+    uint32_t calibrate_settle; // output frames left to skip after the scan
+    video_pipeline_latency_stats_t latency_tail; // last SIM_LATENCY_TAIL_FRAMES output frames
+} sim_report_t;
+
+static sim_options_t s_opts = {
+    .frames = SIM_DEFAULT_FRAMES,
+    .warmup = SIM_DEFAULT_WARMUP,
+    .check = false,
+    .first_dot = SNES_GEN_FIRST_PIXEL_DOT,
+    .mode = VIDEO_PIPELINE_REBOOT_MODE_480P,
+};
+static sim_report_t s_report;
+// Output row (before vertical scaling) of SNES line 0: the capture window
+// centred in the 240-row canvas, itself centred in the mode (288 rows at 576p).
+// With --overscan the window follows the source height, so only the canvas
+// margin is fixed and each output frame's top is worked out from its pixels.
+static uint32_t s_row_offset = V_OFFSET;
+static uint32_t s_mode_margin = 0;
+// 720p fill scaler: source rows stretched to the 720 lines.
+static uint32_t s_fit_rows = SNES_V_ACTIVE;
+
+// =============================================================================
+// Checker
+// =============================================================================
+
+static bool fit_scaler(void)
+{
+    return s_opts.mode == VIDEO_PIPELINE_REBOOT_MODE_720P && s_opts.scaler != VIDEO_PIPELINE_SCALER_INTEGER;
+}
+
+// Modes that show a 448i source's fields as they come, and hires lines
+// averaged to 256 px.
+static bool shows_lores_fields(void)
+{
+    return s_opts.mode == VIDEO_PIPELINE_REBOOT_MODE_240P || fit_scaler();
+}
+
+// Whole frames store hires lines averaged too.
+static bool averages_hires(void)
+{
+    return ENABLE_HIRES && (shows_lores_fields() || s_opts.latency == VIDEO_PIPELINE_LATENCY_FRAME);
+}
+
+// Canvas row an output line shows. Under a fill scaler, lines that straddle
+// two rows blend them and map to none (UINT32_MAX).
+static uint32_t output_to_source_line(uint32_t active_line)
+{
+    if (fit_scaler()) {
+        const uint32_t r = (active_line * s_fit_rows) / 720U;
+        if ((active_line + 1U) * s_fit_rows > (r + 1U) * 720U) {
+            return UINT32_MAX;
+        }
+        return ((FRAME_HEIGHT - s_fit_rows) / 2U) + r;
+    }
+    switch (s_opts.mode) {
+    case VIDEO_PIPELINE_REBOOT_MODE_240P:
+        return active_line;
+    case VIDEO_PIPELINE_REBOOT_MODE_720P:
+        return active_line / 3U;
+    default:
+        return active_line >> 1;
+    }
+}
+
+static inline uint16_t line_pixel(const uint32_t *line, uint32_t idx)
+{
+    const uint32_t word = line[idx / 2U];
+    return (uint16_t)((idx & 1U) ? (word >> 16) : (word & 0xFFFFU));
+}
+
+// Expected output pixel at the centre (SNES x = 128): hires lines show their
+// main sample 1:1 at 480p/720p and the blended pair at 240p (and through
+// the 720p fill scaler).
+static uint16_t expected_centre(uint32_t frame_g5, uint32_t snes_line)
+{
+    const uint16_t main_px = snes_gen_expected_hires_rgb565(frame_g5, snes_line, 256U);
+    if (averages_hires() && snes_gen_line_is_hires(snes_line)) {
+        return snes_gen_average_rgb565(main_px, snes_gen_expected_hires_rgb565(frame_g5, snes_line, 257U));
+    }
+    return main_px;
+}
+
+// The output pixel after the centre one is the hires sub-pixel at 480p (1:1)
+// and 720p (a a b), and a repeat of the centre pixel on lores lines.
+// Without ENABLE_HIRES only the main samples are captured.
+static bool check_hires_neighbour(uint32_t frame_g5, uint32_t snes_line, const uint32_t *line, uint32_t words)
+{
+    if (averages_hires()) {
+        return true;
+    }
+    const uint32_t offset = (s_opts.mode == VIDEO_PIPELINE_REBOOT_MODE_720P) ? 2U : 1U;
+    const uint32_t x2 = ENABLE_HIRES ? 257U : 256U;
+    return line_pixel(line, words + offset) == snes_gen_expected_hires_rgb565(frame_g5, snes_line, x2);
+}
+
+#if ENABLE_INTERLACE
+// 448i source. The field a pixel came from is the LSB of its frame id (g),
+// so weave must show field (il & 1) on interlaced line il and bob the current
+// field shifted by its parity. 240p and the fill scaler show fields as they
+// come.
+static void check_interlaced_line(uint32_t active_line, const uint32_t *line, uint32_t words)
+{
+    const uint16_t px = line_pixel(line, words);
+    s_report.lines_checked++;
+    if (px == 0x7BEFU) {
+        s_report.lines_dropped++;
+        return;
+    }
+
+    // SNES lines this output line may show: one per field under bob.
+    uint32_t il = active_line;
+    if (s_opts.mode == VIDEO_PIPELINE_REBOOT_MODE_720P) {
+        il = (active_line * 2U) / 3U;
+    }
+    const uint32_t row = output_to_source_line(active_line) - s_row_offset;
+    uint32_t rows[2] = {row, row};
+    if (!shows_lores_fields()) {
+        rows[0] = (il >> 1) - s_row_offset;
+        rows[1] = (s_opts.deinterlace == VIDEO_PIPELINE_DEINTERLACE_BOB) ? ((il - 1U) >> 1) - s_row_offset : rows[0];
+    }
+    bool has_hole = false;
+    for (uint32_t i = 0; i < 2U; i++) {
+        if (rows[i] >= snes_gen_active_lines() - SNES_GEN_FADE_LINES) {
+            return; // border, or faded band (g no longer carries the field)
+        }
+        has_hole |= !snes_gen_pixel_valid(rows[i], 128U);
+    }
+    if (px == 0U) {
+        if (!has_hole) {
+            s_report.lines_corrupt++;
+        }
+        return;
+    }
+
+    const uint32_t g5 = (px >> 6) & 0x1FU;
+    const uint32_t field = g5 & 1U;
+    uint32_t snes_line = rows[0];
+    if (!shows_lores_fields()) {
+        if (s_opts.deinterlace == VIDEO_PIPELINE_DEINTERLACE_BOB) {
+            snes_line = rows[field];
+        } else if (field != (il & 1U)) {
+            s_report.lines_corrupt++;
+            return;
+        }
+    }
+    if (!snes_gen_pixel_valid(snes_line, 128U)) {
+        s_report.lines_corrupt++;
+        return;
+    }
+    // Interlaced lines are stored at 256 px: hires pairs arrive blended.
+    // The raw ring keeps them at capture width, like progressive lines.
+    // Without ENABLE_HIRES there is only the main sample.
+    uint16_t expected = snes_gen_expected_hires_rgb565(g5, snes_line, 256U);
+    const bool blended = ENABLE_HIRES && (!ENABLE_RAW_CAPTURE_RING || shows_lores_fields());
+    if (blended && snes_gen_line_is_hires(snes_line)) {
+        expected = snes_gen_average_rgb565(expected, snes_gen_expected_hires_rgb565(g5, snes_line, 257U));
+    }
+    if (px != expected) {
+        s_report.lines_corrupt++;
+    }
+}
+#endif
+
+// --overscan: the first full-brightness pixel that matches SNES line
+// (row - top) for a 224- or 239-line window fixes where this output frame put
+// the picture. The two tops differ by 8 lines, so r tells them apart.
+static bool resolve_frame_top(uint32_t active_line, const uint32_t *line, uint32_t words)
+{
+    static const uint32_t heights[2] = {SNES_V_ACTIVE, SNES_V_ACTIVE_OVERSCAN};
+    const uint16_t px = line_pixel(line, words);
+    const uint32_t g5 = (px >> 6) & 0x1FU;
+    const uint32_t row = output_to_source_line(active_line) - s_mode_margin;
+    for (uint32_t i = 0; i < 2U; i++) {
+        const uint32_t top = (FRAME_HEIGHT - heights[i]) / 2U;
+        const uint32_t snes_line = row - top;
+        if (snes_line < snes_gen_frame_active_lines(g5) - SNES_GEN_FADE_LINES && snes_gen_pixel_valid(snes_line, 128U) &&
+            px == expected_centre(g5, snes_line)) {
+            s_report.frame_top = (int32_t)top;
+            s_report.frame_lines = heights[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t relock_budget_us(void)
+{
+    const uint32_t field_lines = snes_gen_pal() ? SNES_V_TOTAL_PAL_INTERLACE : SNES_V_TOTAL_INTERLACE;
+    return (SIM_RELOCK_BUDGET_FRAMES * field_lines * snes_gen_line_ps()) / 1000000ULL;
+}
+
+// --dropout: the output frame starting at start_ps is checked as usual, must
+// show the no-signal screen, or is left alone.
+static void classify_dropout_frame(uint64_t start_ps)
+{
+    s_report.frame_unchecked = false;
+    s_report.frame_no_signal = false;
+    const uint64_t settle_ps = (relock_budget_us() * 1000000ULL) +
+                               (s_opts.interlace ? SIM_FIELD_RELOCK_FRAMES * SIM_DROPOUT_FRAME_PS : 0U) +
+                               s_report.frame_ps;
+    if (s_opts.dropout_ms == 0U || start_ps + s_report.frame_ps <= s_report.dropout_start_ps ||
+        start_ps >= s_report.dropout_end_ps + settle_ps) {
+        return;
+    }
+    if (start_ps >= s_report.dropout_start_ps + SIM_DROPOUT_DETECT_PS &&
+        start_ps + s_report.frame_ps <= s_report.dropout_end_ps) {
+        s_report.frame_no_signal = true;
+    } else {
+        s_report.frame_unchecked = true;
+    }
+    // Frame ids restart their sequence after the outage.
+    s_report.prev_frame_g5 = -1;
+}
+
+// --calibrate: while the scan moves the sample point the picture is wrong by
+// design; the new phase applies between frames, so skip a few after it.
+static void classify_calibration_frame(void)
+{
+    if (!s_opts.calibrate) {
+        return;
+    }
+    video_capture_calibration_t cal;
+    video_capture_get_calibration(&cal);
+    if (cal.busy) {
+        s_report.calibrate_settle = SIM_CALIBRATE_SETTLE_FRAMES;
+    }
+    if (s_report.calibrate_settle == 0U) {
+        return;
+    }
+    s_report.calibrate_settle--;
+    s_report.frame_unchecked = true;
+    s_report.prev_frame_g5 = -1;
+}
+
+// Inside the outage the picture area is grey; rows 8..231 are in it for
+// either window height.
+static void check_no_signal_line(uint32_t active_line, const uint32_t *line, uint32_t words)
+{
+    const uint32_t row = output_to_source_line(active_line) - s_mode_margin;
+    if (row < (FRAME_HEIGHT - SNES_V_ACTIVE) / 2U || row >= (FRAME_HEIGHT + SNES_V_ACTIVE) / 2U) {
+        return;
+    }
+    if (line_pixel(line, words) == 0x7BEFU) {
+        s_report.no_signal_lines++;
+    } else {
+        s_report.frozen_lines++;
+    }
+}
+
+static void check_line(uint32_t frame, uint32_t active_line, const uint32_t *line, uint32_t words)
+{
+    if (frame <= s_opts.warmup || osd_visible || s_report.frame_unchecked) {
+        return;
+    }
+    if (s_report.frame_no_signal) {
+        check_no_signal_line(active_line, line, words);
+        return;
+    }
+#if ENABLE_INTERLACE
+    if (s_opts.interlace) {
+        check_interlaced_line(active_line, line, words);
+        return;
+    }
+#endif
+    uint32_t row_offset = s_row_offset;
+    uint32_t window_lines = snes_gen_active_lines();
+    uint32_t content_lines = window_lines;
+    if (s_opts.overscan) {
+        if (s_report.frame_top < 0 && !resolve_frame_top(active_line, line, words)) {
+            return;
+        }
+        row_offset = s_mode_margin + (uint32_t)s_report.frame_top;
+        window_lines = s_report.frame_lines;
+        content_lines = (s_report.frame_g5 >= 0) ? snes_gen_frame_active_lines((uint32_t)s_report.frame_g5)
+                                                 : window_lines;
+    }
+    const uint32_t snes_line = output_to_source_line(active_line) - row_offset;
+    if (snes_line >= window_lines) {
+        return;
+    }
+
+    // The output centre is SNES x = 128 in every mode.
+    const uint16_t px = line_pixel(line, words); // words * 2 pixels / 2
+
+    s_report.lines_checked++;
+    if (px == 0x7BEFU) {
+        s_report.lines_dropped++;
+        return;
+    }
+    if (!snes_gen_pixel_valid(snes_line, 128U) || snes_line >= content_lines) {
+        // Mode 7 hole, or the blanked tail of a 224-line frame shown in a
+        // 239-line window.
+        if (px != 0U) {
+            s_report.lines_corrupt++;
+        }
+        return;
+    }
+    if (snes_line >= content_lines - SNES_GEN_FADE_LINES) {
+        if (ENABLE_RAW_CAPTURE_RING && ENABLE_BRIGHTNESS) {
+            // The raw ring converts with the brightness latched at the top
+            // of the frame: an HDMA fade band shows unfaded.
+            return;
+        }
+        // Faded band: green is scaled too, so compare against the frame id
+        // taken from the full-brightness lines above.
+        if (s_report.frame_g5 >= 0 && (px != expected_centre((uint32_t)s_report.frame_g5, snes_line) ||
+                                       !check_hires_neighbour((uint32_t)s_report.frame_g5, snes_line, line, words))) {
+            s_report.lines_corrupt++;
+        }
+        return;
+    }
+    const uint32_t g5 = (px >> 6) & 0x1FU;
+    if (px != expected_centre(g5, snes_line) || !check_hires_neighbour(g5, snes_line, line, words)) {
+        s_report.lines_corrupt++;
+        return;
+    }
+    if (s_report.frame_g5 < 0) {
+        s_report.frame_g5 = (int32_t)g5;
+    } else if (s_report.frame_g5 != (int32_t)g5 && s_report.frame_g5 >= 0) {
+        s_report.frames_torn++;
+        s_report.frame_g5 = -2; // count each frame once
+    }
+}
+
+static void print_report(const char *reason);
+
+static void on_frame(uint32_t frame)
+{
+    if (frame == 1U) {
+        s_report.sim_start_ps = sim_now_ps();
+        s_report.host_start_ns = sim_host_ns();
+    }
+
+    // Close out the previous output frame.
+    if (s_report.frame_g5 >= 0) {
+        const uint32_t g5 = (uint32_t)s_report.frame_g5;
+        uint32_t delta = 1U;
+        s_report.frames_checked++;
+        if (s_report.prev_frame_g5 >= 0) {
+            delta = (g5 - (uint32_t)s_report.prev_frame_g5) & 0x1FU;
+            if (delta == 0U) {
+                s_report.frames_repeated++;
+            } else if (delta > 1U) {
+                s_report.frames_skipped += delta - 1U;
+            }
+        }
+        s_report.prev_frame_g5 = s_report.frame_g5;
+
+        // The pipeline centres on the newest height Core 0 had counted at
+        // output vsync: after a switch that is still the previous frame's, or
+        // a skipped frame's when the reader caught up past it.
+        if (s_opts.overscan && s_report.frame_top >= 0 && s_report.frame_lines != snes_gen_frame_active_lines(g5)) {
+            bool late = false;
+            for (uint32_t back = 1U; back <= ((delta > 1U) ? delta : 1U); back++) {
+                late |= (s_report.frame_lines == snes_gen_frame_active_lines((g5 - back) & 0x1FU));
+            }
+            if (late) {
+                s_report.frames_recentred_late++;
+            } else {
+                s_report.frames_miscentred++;
+            }
+        }
+    }
+    s_report.frame_g5 = -1;
+    s_report.frame_top = -1;
+    if (frame > 1U) {
+        s_report.frame_ps = sim_now_ps() - s_report.frame_start_ps;
+    }
+    s_report.frame_start_ps = sim_now_ps();
+    classify_dropout_frame(s_report.frame_start_ps);
+    classify_calibration_frame();
+
+    // Underruns only count while the pipeline claims to be streaming audio,
+    // from one output frame to the next (a rearm mutes it in between).
+    sim_hdmi_stats_t hdmi;
+    audio_pipeline_diag_t diag;
+    sim_hdmi_get_stats(&hdmi);
+    audio_pipeline_get_diag(&diag);
+    const bool streaming = diag.running && !diag.muted && frame > s_opts.warmup;
+    if (streaming && s_report.audio_streaming) {
+        s_report.audio_underruns += hdmi.di_underruns - s_report.audio_di_last;
+    }
+    s_report.audio_seen_running |= streaming;
+    s_report.audio_streaming = streaming;
+    s_report.audio_di_last = hdmi.di_underruns;
+
+    // Latency over the tail of the run, once the genlock has settled.
+    if (frame == s_opts.frames - SIM_LATENCY_TAIL_FRAMES || frame > s_opts.frames) {
+        video_pipeline_take_latency_stats(&s_report.latency_tail);
+    }
+    if (frame > s_opts.frames) {
+        host_sim_finish(NULL);
+    }
+}
+
+// =============================================================================
+// Report
+// =============================================================================
+
+static int report_failures(void)
+{
+    sim_capture_stats_t cap;
+    sim_get_capture_stats(&cap);
+    int failures = 0;
+    if (s_report.lines_checked == 0U) {
+        failures++;
+    }
+    if (s_report.lines_dropped != 0U || s_report.lines_corrupt != 0U || s_report.frames_torn != 0U ||
+        s_report.frames_miscentred != 0U) {
+        failures++;
+    }
+    if (cap.capture_overruns != 0U) {
+        failures++;
+    }
+    if (!s_report.audio_seen_running || s_report.audio_underruns != 0U) {
+        failures++;
+    }
+#if ENABLE_GENLOCK
+    // Output frames must end the run phase-locked to the console's.
+    genlock_status_t lock;
+    genlock_get_status(&lock);
+    if (!lock.locked) {
+        failures++;
+    }
+#endif
+    // Only an outage longer than detection plus two output frames has a
+    // whole frame of no-signal screen in it. A shorter one may pass as a
+    // late frame (the raw ring only times whole frames).
+    const bool dropout_shows_screen = s_report.dropout_end_ps - s_report.dropout_start_ps >
+                                      SIM_DROPOUT_DETECT_PS + (2U * s_report.frame_ps);
+    const uint32_t losses = video_capture_get_signal_losses();
+    if (s_opts.dropout_ms != 0U &&
+        ((dropout_shows_screen && (s_report.no_signal_lines == 0U || losses == 0U)) || s_report.frozen_lines != 0U ||
+         losses > 1U || !video_capture_has_signal() || video_capture_get_relock_us() > relock_budget_us())) {
+        failures++;
+    }
+    if (s_opts.latency == VIDEO_PIPELINE_LATENCY_RACE) {
+        // Racing the beam: the closest line of the tail frames sits within a
+        // line of the set distance.
+        const int32_t line_us = (int32_t)(SNES_REGION_LINE_NS(video_capture_get_region()) / 1000U);
+        const int32_t off_us = (int32_t)s_report.latency_tail.min_us - ((int32_t)LATENCY_RACE_LINES * line_us);
+        if (s_report.latency_tail.lines == 0U || off_us > line_us || off_us < -line_us) {
+            failures++;
+        }
+    }
+    if (s_opts.calibrate) {
+        video_capture_calibration_t cal;
+        video_capture_get_calibration(&cal);
+        const uint32_t eye_lo_ns = (uint32_t)(SNES_GEN_EYE_OPEN_PS / 1000U) + s_opts.skew_ns;
+        const uint32_t eye_hi_ns = (uint32_t)(SNES_GEN_EYE_CLOSE_PS / 1000U) + s_opts.skew_ns;
+        if (cal.busy || !cal.done || cal.skip != s_opts.first_dot || cal.sample_ns < eye_lo_ns ||
+            cal.sample_ns > eye_hi_ns) {
+            failures++;
+        }
+    }
+    return failures;
+}
+
+static void print_report(const char *reason)
+{
+    sim_capture_stats_t cap;
+    sim_hdmi_stats_t hdmi;
+    audio_pipeline_diag_t diag;
+    sim_get_capture_stats(&cap);
+    sim_hdmi_get_stats(&hdmi);
+    audio_pipeline_get_diag(&diag);
+
+    const double sim_s = (double)(sim_now_ps() - s_report.sim_start_ps) / 1e12;
+    const double host_s = (double)(sim_host_ns() - s_report.host_start_ns) / 1e9;
+
+    printf("=== superpico-host-sim: %s ===\n", video_output_active_mode->name);
+    if (reason) {
+        printf("stopped:         %s\n", reason);
+    }
+    const double timed_frames = (hdmi.frames > 0U) ? (double)(hdmi.frames - 1U) : 0.0;
+    printf("output frames:   %llu in %.3f s simulated (%.2f fps), %.2f fps host throughput\n",
+           (unsigned long long)hdmi.frames, sim_s, sim_s > 0.0 ? timed_frames / sim_s : 0.0,
+           host_s > 0.0 ? timed_frames / host_s : 0.0);
+    printf("capture:         %llu lines (%lu hires), %llu overruns, convert %.0f ns/line avg, %llu ns max\n",
+           (unsigned long long)cap.lines_captured, (unsigned long)video_capture_get_hires_line_count(),
+           (unsigned long long)cap.capture_overruns,
+           cap.convert_lines ? (double)cap.convert_ns_total / (double)cap.convert_lines : 0.0,
+           (unsigned long long)cap.convert_ns_max);
+    printf("core 0:          %s, busy %.0f ns/frame avg\n",
+           ENABLE_RAW_CAPTURE_RING ? "raw ring (Core 1 converts)" : "converts at capture",
+           cap.frames ? (double)cap.core0_busy_ns / (double)cap.frames : 0.0);
+    printf("scanout:         %.0f ns/line avg, %llu ns max\n",
+           hdmi.active_lines ? (double)hdmi.scanline_ns_total / (double)hdmi.active_lines : 0.0,
+           (unsigned long long)hdmi.scanline_ns_max);
+    printf("line ring:       %u lines, %lu bytes; %lu output lines lapped, %lu not ready\n", (unsigned)LINE_RING_SIZE,
+           (unsigned long)video_pipeline_get_ring_bytes(), (unsigned long)video_pipeline_get_ring_overruns(),
+           (unsigned long)video_pipeline_get_ring_not_ready());
+#if ENABLE_INDEXED_LINES
+    video_capture_line_store_t store;
+    video_capture_get_line_store(&store);
+    const uint32_t stored = store.indexed_lines + store.wide_lines;
+    printf("line store:      %lu indexed, %lu rgb565; %.0f bytes/line avg (rgb565 lores: %u), max %lu colours\n",
+           (unsigned long)store.indexed_lines, (unsigned long)store.wide_lines,
+           stored ? (double)store.bytes / (double)stored : 0.0, SNES_H_ACTIVE * 2U, (unsigned long)store.max_colors);
+#endif
+    printf("lines:           %llu checked, %llu dropped, %llu corrupt\n", (unsigned long long)s_report.lines_checked,
+           (unsigned long long)s_report.lines_dropped, (unsigned long long)s_report.lines_corrupt);
+    printf("frames:          %llu checked, %llu torn, %llu repeated, %llu skipped\n",
+           (unsigned long long)s_report.frames_checked, (unsigned long long)s_report.frames_torn,
+           (unsigned long long)s_report.frames_repeated, (unsigned long long)s_report.frames_skipped);
+#if ENABLE_GENLOCK
+    genlock_status_t lock;
+    genlock_get_status(&lock);
+    printf("genlock:         %s after %lu locks, SNES %.4f Hz, trim %+.2f lines/frame, phase %+ld us, jitter %lu us p-p\n",
+           lock.locked ? "locked" : "unlocked", (unsigned long)lock.locks,
+           lock.period_q8 ? 256e6 / (double)lock.period_q8 : 0.0, lock.trim_q8 / 256.0, (long)lock.phase_us,
+           (unsigned long)lock.jitter_us);
+#endif
+    if (!ENABLE_RAW_CAPTURE_RING) {
+        video_pipeline_latency_stats_t lat;
+        video_pipeline_get_latency_stats(&lat);
+        printf("latency:         %lu lines, min %lu us, avg %lu us, max %lu us; last %u frames %lu/%lu/%lu us\n",
+               (unsigned long)lat.lines, (unsigned long)lat.min_us, (unsigned long)lat.avg_us,
+               (unsigned long)lat.max_us, SIM_LATENCY_TAIL_FRAMES, (unsigned long)s_report.latency_tail.min_us,
+               (unsigned long)s_report.latency_tail.avg_us, (unsigned long)s_report.latency_tail.max_us);
+        // Occupied bins only, as "from ms: share of lines".
+        const uint32_t *hist = video_pipeline_get_latency_histogram();
+        printf("histogram:      ");
+        for (uint32_t bin = 0; bin < VIDEO_PIPELINE_LATENCY_BINS; bin++) {
+            if (hist[bin] != 0U && lat.lines != 0U) {
+                printf(" %.1f:%.1f%%", (bin * VIDEO_PIPELINE_LATENCY_BIN_US) / 1000.0,
+                       (100.0 * hist[bin]) / (double)lat.lines);
+            }
+        }
+        printf("\n");
+    }
+    if (s_opts.latency == VIDEO_PIPELINE_LATENCY_FRAME) {
+        printf("frame buffer:    %lu dropped, %lu repeated\n", (unsigned long)video_pipeline_get_frames_dropped(),
+               (unsigned long)video_pipeline_get_frames_repeated());
+    }
+    if (s_opts.overscan) {
+        printf("overscan:        %llu frames centred on the previous height, %llu mis-centred\n",
+               (unsigned long long)s_report.frames_recentred_late, (unsigned long long)s_report.frames_miscentred);
+    }
+    if (s_opts.dropout_ms != 0U) {
+        printf("dropout:         %lu ms, %llu no-signal lines, %llu frozen; %lu losses, relock %.1f ms (budget %.1f)\n",
+               (unsigned long)s_opts.dropout_ms, (unsigned long long)s_report.no_signal_lines,
+               (unsigned long long)s_report.frozen_lines, (unsigned long)video_capture_get_signal_losses(),
+               video_capture_get_relock_us() / 1000.0, relock_budget_us() / 1000.0);
+    }
+    if (s_opts.calibrate) {
+        video_capture_calibration_t cal;
+        video_capture_get_calibration(&cal);
+        printf("calibrate:       %s, skip %u, delay %u/%u (%u ns), eye %u-%u ns; bus first dot %lu, skew %lu ns\n",
+               cal.busy ? "busy" : (cal.done ? "done" : "not run"), cal.skip, cal.delay, cal.delay_max, cal.sample_ns,
+               cal.eye_lo_ns, cal.eye_hi_ns, (unsigned long)s_opts.first_dot, (unsigned long)s_opts.skew_ns);
+    }
+    printf("audio:           %s, %lu samples out, %llu underruns, %lu overflows, %lu rearms\n",
+           diag.running ? (diag.muted ? "muted" : "running") : "stopped", (unsigned long)diag.samples_output,
+           (unsigned long long)s_report.audio_underruns, (unsigned long)diag.overflows,
+           (unsigned long)diag.rearm_count);
+}
+
+void host_sim_finish(const char *reason)
+{
+    print_report(reason);
+    fflush(stdout);
+    if (s_opts.check) {
+        const int failures = report_failures();
+        printf("check:           %s\n", failures ? "FAIL" : "PASS");
+        fflush(stdout);
+        exit(failures ? 1 : 0);
+    }
+    exit(0);
+}
+
+// =============================================================================
+// Main (mirrors main.c init order)
+// =============================================================================
+
+static void combined_background_task(void)
+{
+    audio_pipeline_process();
+    menu_diag_experiment_tick_background();
+}
+
+static const video_mode_t *mode_for(video_pipeline_reboot_mode_t mode, snes_region_t region)
+{
+    const bool pal = (region == SNES_REGION_PAL);
+    switch (mode) {
+    case VIDEO_PIPELINE_REBOOT_MODE_240P:
+        return &video_mode_240_p;
+    case VIDEO_PIPELINE_REBOOT_MODE_720P:
+        return pal ? &video_mode_720_p50 : &video_mode_720_p;
+    default:
+        return pal ? &video_mode_576_p : &video_mode_480_p;
+    }
+}
+
+// main.c's configure_system_clock_for_mode.
+static uint32_t sys_clk_khz_for(video_pipeline_reboot_mode_t mode, snes_region_t region)
+{
+    const bool pal = (region == SNES_REGION_PAL);
+    switch (mode) {
+    case VIDEO_PIPELINE_REBOOT_MODE_240P:
+        return 126000U;
+    case VIDEO_PIPELINE_REBOOT_MODE_720P:
+        return 372000U;
+    default:
+        return pal ? 270000U : 252000U;
+    }
+}
+
+static uint32_t mode_margin_for(const video_mode_t *mode)
+{
+    const uint32_t v = mode->v_active_lines;
+    const uint32_t rows = (v == 720U) ? v / 3U : (v <= 288U) ? v : v / 2U;
+    return (rows - FRAME_HEIGHT) / 2U;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [--mode 480p|240p|720p] [--frames N] [--warmup N] [--check] [--bench]\n"
+            "       [--interlace] [--deinterlace weave|bob] [--pal] [--overscan] [--dropout MS]\n"
+            "       [--calibrate] [--skew NS] [--first-dot N] [--scaler integer|square|8:7|4:3]\n"
+            "       [--latency low|frame|safe|race]\n",
+            argv0);
+    exit(2);
+}
+
+static void parse_args(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            const char *m = argv[++i];
+            if (strcmp(m, "480p") == 0) {
+                s_opts.mode = VIDEO_PIPELINE_REBOOT_MODE_480P;
+            } else if (strcmp(m, "240p") == 0) {
+                s_opts.mode = VIDEO_PIPELINE_REBOOT_MODE_240P;
+            } else if (strcmp(m, "720p") == 0) {
+                s_opts.mode = VIDEO_PIPELINE_REBOOT_MODE_720P;
+            } else {
+                usage(argv[0]);
+            }
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            s_opts.frames = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            s_opts.warmup = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--check") == 0) {
+            s_opts.check = true;
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            s_opts.bench = true;
+        } else if (strcmp(argv[i], "--interlace") == 0 && ENABLE_INTERLACE) {
+            s_opts.interlace = true;
+        } else if (strcmp(argv[i], "--pal") == 0) {
+            s_opts.pal = true;
+        } else if (strcmp(argv[i], "--overscan") == 0) {
+            s_opts.overscan = true;
+        } else if (strcmp(argv[i], "--dropout") == 0 && i + 1 < argc) {
+            s_opts.dropout_ms = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--calibrate") == 0) {
+            s_opts.calibrate = true;
+        } else if (strcmp(argv[i], "--skew") == 0 && i + 1 < argc) {
+            s_opts.skew_ns = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--first-dot") == 0 && i + 1 < argc) {
+            s_opts.first_dot = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--scaler") == 0 && i + 1 < argc) {
+            static const char *const names[VIDEO_PIPELINE_SCALER_COUNT] = {"integer", "square", "8:7", "4:3"};
+            const char *m = argv[++i];
+            s_opts.scaler = VIDEO_PIPELINE_SCALER_COUNT;
+            for (uint32_t n = 0; n < VIDEO_PIPELINE_SCALER_COUNT; n++) {
+                if (strcmp(m, names[n]) == 0) {
+                    s_opts.scaler = (video_pipeline_scaler_t)n;
+                }
+            }
+            if (s_opts.scaler == VIDEO_PIPELINE_SCALER_COUNT) {
+                usage(argv[0]);
+            }
+        } else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc) {
+            const char *m = argv[++i];
+            if (strcmp(m, "low") == 0) {
+                s_opts.latency = VIDEO_PIPELINE_LATENCY_LOW;
+            } else if ((strcmp(m, "frame") == 0 || strcmp(m, "safe") == 0) && LINE_RING_FRAME_BUFFERS) {
+                s_opts.latency = VIDEO_PIPELINE_LATENCY_FRAME;
+            } else if (strcmp(m, "race") == 0 && video_pipeline_latency_supported(VIDEO_PIPELINE_LATENCY_RACE)) {
+                s_opts.latency = VIDEO_PIPELINE_LATENCY_RACE;
+            } else {
+                usage(argv[0]);
+            }
+#if ENABLE_INTERLACE
+        } else if (strcmp(argv[i], "--deinterlace") == 0 && i + 1 < argc) {
+            const char *m = argv[++i];
+            if (strcmp(m, "weave") == 0) {
+                s_opts.deinterlace = VIDEO_PIPELINE_DEINTERLACE_WEAVE;
+            } else if (strcmp(m, "bob") == 0) {
+                s_opts.deinterlace = VIDEO_PIPELINE_DEINTERLACE_BOB;
+            } else {
+                usage(argv[0]);
+            }
+#endif
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (s_opts.overscan && s_opts.interlace) {
+        fprintf(stderr, "--overscan is checked on progressive sources only\n");
+        exit(2);
+    }
+    if (s_opts.check && s_opts.frames < SIM_CHECK_MIN_FRAMES) {
+        fprintf(stderr, "--check needs --frames %u or more: audio and the genlock settle about 180 frames in\n",
+                SIM_CHECK_MIN_FRAMES);
+        exit(2);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    parse_args(argc, argv);
+
+    sim_hal_init();
+    snes_gen_init(SIM_SNES_ORIGIN_PS);
+    snes_gen_set_brightness_applied(ENABLE_BRIGHTNESS);
+    snes_gen_set_interlace(s_opts.interlace);
+    snes_gen_set_pal(s_opts.pal);
+    snes_gen_set_overscan_switch(s_opts.overscan);
+    snes_gen_set_bus(s_opts.first_dot, (uint64_t)s_opts.skew_ns * 1000U);
+    if (s_opts.dropout_ms != 0U) {
+        s_report.dropout_start_ps =
+            SIM_SNES_ORIGIN_PS + ((uint64_t)(s_opts.frames / 3U) * SIM_DROPOUT_FRAME_PS) + SIM_DROPOUT_PHASE_PS;
+        s_report.dropout_end_ps = s_report.dropout_start_ps + ((uint64_t)s_opts.dropout_ms * 1000000000ULL);
+        snes_gen_set_dropout(s_report.dropout_start_ps, (uint64_t)s_opts.dropout_ms * 1000000000ULL);
+    }
+    s_report.frame_g5 = -1;
+    s_report.prev_frame_g5 = -1;
+    s_report.frame_top = -1;
+
+    // Same probe main.c runs before choosing sysclk and the output mode.
+    const snes_region_t region = video_capture_detect_region(200U);
+    if (region != (s_opts.pal ? SNES_REGION_PAL : SNES_REGION_NTSC)) {
+        fprintf(stderr, "sim: region probe returned %s\n", (region == SNES_REGION_PAL) ? "PAL" : "NTSC");
+        return 1;
+    }
+
+    if (region == SNES_REGION_PAL && s_opts.mode == VIDEO_PIPELINE_REBOOT_MODE_240P) {
+        s_opts.mode = VIDEO_PIPELINE_REBOOT_MODE_480P; // as main.c: no 50 Hz direct mode
+    }
+    video_pipeline_set_reboot_requested_mode(s_opts.mode);
+    set_sys_clock_khz(sys_clk_khz_for(s_opts.mode, region), true);
+
+    hstx_di_queue_init();
+    fast_osd_init();
+    menu_diag_experiment_init();
+    video_pipeline_init();
+    video_pipeline_set_region(region);
+#if ENABLE_INTERLACE
+    video_pipeline_set_deinterlace(s_opts.deinterlace);
+#endif
+    video_pipeline_set_scaler(s_opts.scaler);
+    video_pipeline_set_latency(s_opts.latency);
+#if ENABLE_INTERLACE
+    if (ENABLE_RAW_CAPTURE_RING || s_opts.latency == VIDEO_PIPELINE_LATENCY_FRAME) {
+        s_opts.deinterlace = VIDEO_PIPELINE_DEINTERLACE_BOB; // the pipeline's only choice then
+    }
+#endif
+
+    video_output_set_mode(genlock_init(mode_for(s_opts.mode, region)));
+    s_mode_margin = mode_margin_for(video_output_active_mode);
+    s_row_offset = s_mode_margin + ((FRAME_HEIGHT - SNES_REGION_V_ACTIVE(region)) / 2U);
+    s_fit_rows = SNES_REGION_V_ACTIVE(region);
+    video_output_init(FRAME_WIDTH, FRAME_HEIGHT);
+    video_output_set_scanline_callback(scanline_callback);
+    video_output_set_vsync_callback(vsync_callback);
+    sim_hdmi_set_observers(check_line, on_frame);
+
+    audio_pipeline_init();
+    video_output_set_background_task(combined_background_task);
+
+    video_capture_init(region);
+    if (s_opts.bench) {
+        capture_bench_run();
+        return 0;
+    }
+    sleep_ms(200);
+
+    multicore_launch_core1(video_output_core1_run);
+    sleep_ms(100);
+
+    if (s_opts.calibrate) {
+        video_capture_start_calibration();
+    }
+    video_capture_run();
+    return 0;
+}
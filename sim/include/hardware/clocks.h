@@ -0,0 +1,18 @@
+/**
+ * Host simulation shim - hardware/clocks.h
+ *
+ * The sim has no clock tree; sysclk only matters for the per-mode values the
+ * firmware reads back.
+ */
+
+#ifndef SIM_HARDWARE_CLOCKS_H
+#define SIM_HARDWARE_CLOCKS_H
+
+#include "pico.h"
+
+enum clock_index { clk_gpout0 = 0, clk_ref = 4, clk_sys = 5, clk_peri = 6, clk_hstx = 7 };
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+
+#endif // SIM_HARDWARE_CLOCKS_H
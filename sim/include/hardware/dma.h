@@ -0,0 +1,72 @@
+/**
+ * Host simulation shim - hardware/dma.h
+ *
+ * Channels are modelled as descriptors. A channel paced by a capture state
+ * machine's RX DREQ is fed by the synthetic SNES generator; WRITE_ADDR is kept
+ * up to date so code that polls it (I2S capture) sees the DMA progress.
+ */
+
+#ifndef SIM_HARDWARE_DMA_H
+#define SIM_HARDWARE_DMA_H
+
+#include "pico.h"
+
+#define NUM_DMA_CHANNELS 16u
+
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+
+typedef struct {
+    bool read_increment;
+    bool write_increment;
+    uint dreq;
+    enum dma_channel_transfer_size size;
+    bool ring_write;
+    uint ring_size_bits;
+    uint chain_to;
+    bool enable;
+} dma_channel_config;
+
+typedef struct {
+    volatile uint32_t read_addr;
+    volatile uint32_t write_addr;
+    volatile uint32_t transfer_count;
+    volatile uint32_t ctrl_trig;
+} dma_channel_hw_t;
+
+typedef struct {
+    dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+} dma_hw_t;
+
+extern dma_hw_t sim_dma_hw;
+#define dma_hw (&sim_dma_hw)
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(uint channel);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint32_t transfer_count, bool trigger);
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger);
+void dma_channel_start(uint channel);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr) { c->read_increment = incr; }
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr) { c->write_increment = incr; }
+static inline void channel_config_set_dreq(dma_channel_config *c, uint dreq) { c->dreq = dreq; }
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+    c->size = size;
+}
+static inline void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits)
+{
+    c->ring_write = write;
+    c->ring_size_bits = size_bits;
+}
+static inline void channel_config_set_chain_to(dma_channel_config *c, uint chain_to) { c->chain_to = chain_to; }
+static inline void channel_config_set_enable(dma_channel_config *c, bool enable) { c->enable = enable; }
+
+#endif // SIM_HARDWARE_DMA_H
@@ -0,0 +1,28 @@
+/**
+ * Host simulation shim - hardware/gpio.h
+ *
+ * Inputs are driven by the synthetic SNES generator; every other pin reads
+ * back as pulled-up (buttons released, S-DSP /RESET deasserted).
+ */
+
+#ifndef SIM_HARDWARE_GPIO_H
+#define SIM_HARDWARE_GPIO_H
+
+#include "pico.h"
+
+enum { GPIO_IN = 0, GPIO_OUT = 1 };
+
+bool gpio_get(uint pin);
+uint32_t gpio_get_all(void);
+void gpio_put(uint pin, bool value);
+void gpio_xor_mask(uint32_t mask);
+
+static inline void gpio_init(uint pin) { (void)pin; }
+static inline void gpio_set_dir(uint pin, bool out) { (void)pin; (void)out; }
+static inline void gpio_pull_up(uint pin) { (void)pin; }
+static inline void gpio_pull_down(uint pin) { (void)pin; }
+static inline void gpio_disable_pulls(uint pin) { (void)pin; }
+static inline void gpio_set_input_enabled(uint pin, bool enabled) { (void)pin; (void)enabled; }
+static inline void gpio_set_input_hysteresis_enabled(uint pin, bool enabled) { (void)pin; (void)enabled; }
+
+#endif // SIM_HARDWARE_GPIO_H
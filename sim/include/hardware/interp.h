@@ -0,0 +1,62 @@
+/**
+ * Host simulation shim - hardware/interp.h
+ *
+ * Software model of the SIO interpolators, lanes 0/1 in their plain unsigned
+ * form (no SIGNED, CROSS_INPUT, CROSS_RESULT or ADD_RAW):
+ * result = base + ((accum >> shift) & mask). Bases and results are uintptr_t
+ * so a lane can generate host pointers; the firmware narrows them to 32 bits.
+ * Interpolators are per core; only Core 0 (the host main thread) uses them.
+ */
+
+#ifndef SIM_HARDWARE_INTERP_H
+#define SIM_HARDWARE_INTERP_H
+
+#include "pico.h"
+
+typedef struct {
+    uint32_t shift;
+    uint32_t mask;
+} interp_config;
+
+typedef struct {
+    uint32_t accum[2];
+    uintptr_t base[3];
+    interp_config ctrl[2];
+} interp_hw_t;
+
+extern interp_hw_t sim_interp_hw[2];
+#define interp0 (&sim_interp_hw[0])
+#define interp1 (&sim_interp_hw[1])
+
+static inline interp_config interp_default_config(void)
+{
+    interp_config c = {0U, 0xFFFFFFFFu};
+    return c;
+}
+
+static inline void interp_config_set_shift(interp_config *c, uint shift) { c->shift = shift & 31U; }
+
+static inline void interp_config_set_mask(interp_config *c, uint mask_lsb, uint mask_msb)
+{
+    c->mask = (0xFFFFFFFFu >> (31U - mask_msb)) & ~((1U << mask_lsb) - 1U);
+}
+
+static inline void interp_set_config(interp_hw_t *interp, uint lane, interp_config *config)
+{
+    interp->ctrl[lane] = *config;
+}
+
+static inline void interp_set_base(interp_hw_t *interp, uint lane, uintptr_t val) { interp->base[lane] = val; }
+
+static inline void interp_set_accumulator(interp_hw_t *interp, uint lane, uint32_t val)
+{
+    interp->accum[lane] = val;
+}
+
+static inline uintptr_t interp_peek_lane_result(interp_hw_t *interp, uint lane)
+{
+    const interp_config *c = &interp->ctrl[lane];
+    return interp->base[lane] + ((interp->accum[lane] >> c->shift) & c->mask);
+}
+
+#endif // SIM_HARDWARE_INTERP_H
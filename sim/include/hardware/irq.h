@@ -0,0 +1,19 @@
+/**
+ * Host simulation shim - hardware/irq.h
+ *
+ * NVIC handlers for the interrupts sim_hal.c raises (the capture SM's frame
+ * IRQ). Handlers run on Core 0, the host main thread, between its shim calls
+ * once virtual time passes the event that raised them.
+ */
+
+#ifndef SIM_HARDWARE_IRQ_H
+#define SIM_HARDWARE_IRQ_H
+
+#include "pico.h"
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+
+#endif // SIM_HARDWARE_IRQ_H
@@ -0,0 +1,221 @@
+/**
+ * Host simulation shim - hardware/pio.h
+ *
+ * Register layout matches RP2350 closely enough that direct pinctrl and
+ * GPIOBASE (offset 0x168) writes in the firmware land in the right place.
+ * State machines are not interpreted instruction-by-instruction: sim_hal.c
+ * recognises the capture programs by their IN_BASE and JMP pins and models them
+ * behaviourally against the synthetic SNES signals.
+ */
+
+#ifndef SIM_HARDWARE_PIO_H
+#define SIM_HARDWARE_PIO_H
+
+#include "pico.h"
+#include "hardware/gpio.h"
+
+#include <stddef.h>
+
+#define NUM_PIOS 3u
+#define NUM_PIO_STATE_MACHINES 4u
+#define PIO_INSTRUCTION_COUNT 32u
+
+typedef struct {
+    volatile uint32_t clkdiv;
+    volatile uint32_t execctrl;
+    volatile uint32_t shiftctrl;
+    volatile uint32_t addr;
+    volatile uint32_t instr;
+    volatile uint32_t pinctrl;
+} pio_sm_hw_t;
+
+typedef struct {
+    volatile uint32_t ctrl;
+    volatile uint32_t fstat;
+    volatile uint32_t fdebug;
+    volatile uint32_t flevel;
+    volatile uint32_t txf[NUM_PIO_STATE_MACHINES];
+    volatile uint32_t rxf[NUM_PIO_STATE_MACHINES];
+    volatile uint32_t irq;
+    volatile uint32_t irq_force;
+    volatile uint32_t input_sync_bypass;
+    volatile uint32_t dbg_padout;
+    volatile uint32_t dbg_padoe;
+    volatile uint32_t dbg_cfginfo;
+    volatile uint32_t instr_mem[PIO_INSTRUCTION_COUNT];
+    pio_sm_hw_t sm[NUM_PIO_STATE_MACHINES];
+    volatile uint32_t rxf_putget[NUM_PIO_STATE_MACHINES][4];
+    volatile uint32_t gpiobase;
+} pio_hw_t;
+
+_Static_assert(offsetof(pio_hw_t, gpiobase) == 0x168, "GPIOBASE must sit at the RP2350 register offset");
+
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t sim_pio_hw[NUM_PIOS];
+#define pio0 (&sim_pio_hw[0])
+#define pio1 (&sim_pio_hw[1])
+#define pio2 (&sim_pio_hw[2])
+
+typedef struct pio_program {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+    uint8_t pio_version;
+} pio_program_t;
+
+typedef struct {
+    uint32_t clkdiv;
+    uint32_t execctrl;
+    uint32_t shiftctrl;
+    uint32_t pinctrl;
+} pio_sm_config;
+
+enum pio_fifo_join { PIO_FIFO_JOIN_NONE = 0, PIO_FIFO_JOIN_TX = 1, PIO_FIFO_JOIN_RX = 2 };
+
+enum pio_src_dest {
+    pio_pins = 0u,
+    pio_x = 1u,
+    pio_y = 2u,
+    pio_null = 3u,
+    pio_pindirs = 4u,
+    pio_exec_mov = 4u,
+    pio_status = 5u,
+    pio_pc = 5u,
+    pio_isr = 6u,
+    pio_osr = 7u,
+    pio_exec_out = 7u,
+};
+
+#define PIO_SM_SHIFTCTRL_AUTOPUSH_BITS 0x00010000u
+#define PIO_SM_SHIFTCTRL_IN_SHIFTDIR_BITS 0x00040000u
+#define PIO_SM_SHIFTCTRL_PUSH_THRESH_LSB 20u
+#define PIO_SM_SHIFTCTRL_PUSH_THRESH_BITS 0x01f00000u
+#define PIO_SM_SHIFTCTRL_FJOIN_RX_BITS 0x80000000u
+#define PIO_SM_SHIFTCTRL_FJOIN_TX_BITS 0x40000000u
+#define PIO_SM_PINCTRL_IN_BASE_LSB 15u
+#define PIO_SM_PINCTRL_IN_BASE_BITS 0x000f8000u
+#define PIO_SM_EXECCTRL_WRAP_BOTTOM_LSB 7u
+#define PIO_SM_EXECCTRL_WRAP_TOP_LSB 12u
+
+static inline pio_sm_config pio_get_default_sm_config(void)
+{
+    pio_sm_config c = {0};
+    c.clkdiv = 1u << 16;
+    c.execctrl = 31u << PIO_SM_EXECCTRL_WRAP_TOP_LSB;
+    c.shiftctrl = PIO_SM_SHIFTCTRL_IN_SHIFTDIR_BITS | (1u << 19);
+    return c;
+}
+
+static inline void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap)
+{
+    c->execctrl = (c->execctrl & ~((31u << PIO_SM_EXECCTRL_WRAP_BOTTOM_LSB) | (31u << PIO_SM_EXECCTRL_WRAP_TOP_LSB))) |
+                  ((wrap_target & 31u) << PIO_SM_EXECCTRL_WRAP_BOTTOM_LSB) |
+                  ((wrap & 31u) << PIO_SM_EXECCTRL_WRAP_TOP_LSB);
+}
+
+static inline void sm_config_set_in_pins(pio_sm_config *c, uint in_base)
+{
+    c->pinctrl = (c->pinctrl & ~PIO_SM_PINCTRL_IN_BASE_BITS) | ((in_base & 31u) << PIO_SM_PINCTRL_IN_BASE_LSB);
+}
+
+static inline void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold)
+{
+    c->shiftctrl = (c->shiftctrl & ~(PIO_SM_SHIFTCTRL_IN_SHIFTDIR_BITS | PIO_SM_SHIFTCTRL_AUTOPUSH_BITS |
+                                     PIO_SM_SHIFTCTRL_PUSH_THRESH_BITS)) |
+                   (shift_right ? PIO_SM_SHIFTCTRL_IN_SHIFTDIR_BITS : 0u) |
+                   (autopush ? PIO_SM_SHIFTCTRL_AUTOPUSH_BITS : 0u) |
+                   ((push_threshold & 31u) << PIO_SM_SHIFTCTRL_PUSH_THRESH_LSB);
+}
+
+static inline void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join)
+{
+    c->shiftctrl = (c->shiftctrl & ~(PIO_SM_SHIFTCTRL_FJOIN_RX_BITS | PIO_SM_SHIFTCTRL_FJOIN_TX_BITS)) |
+                   ((join == PIO_FIFO_JOIN_RX) ? PIO_SM_SHIFTCTRL_FJOIN_RX_BITS : 0u) |
+                   ((join == PIO_FIFO_JOIN_TX) ? PIO_SM_SHIFTCTRL_FJOIN_TX_BITS : 0u);
+}
+
+static inline void sm_config_set_clkdiv(pio_sm_config *c, float div)
+{
+    c->clkdiv = (uint32_t)(div * 65536.0f);
+}
+
+// Instruction encoders (real RP2040/RP2350 encodings; the sim decodes the
+// ones the firmware executes with pio_sm_exec).
+static inline uint pio_encode_jmp(uint addr) { return 0x0000u | (addr & 31u); }
+static inline uint pio_encode_jmp_x_dec(uint addr) { return 0x0000u | (2u << 5) | (addr & 31u); }
+static inline uint pio_encode_wait_pin(bool polarity, uint pin)
+{
+    return 0x2000u | ((polarity ? 1u : 0u) << 7) | (1u << 5) | (pin & 31u);
+}
+static inline uint pio_encode_wait_irq(bool polarity, bool relative, uint irq)
+{
+    return 0x2000u | ((polarity ? 1u : 0u) << 7) | (2u << 5) | ((relative ? 0x10u : 0u) | (irq & 7u));
+}
+static inline uint pio_encode_in(enum pio_src_dest src, uint count) { return 0x4000u | ((uint)src << 5) | (count & 31u); }
+static inline uint pio_encode_push(bool if_full, bool block)
+{
+    return 0x8000u | ((if_full ? 1u : 0u) << 6) | ((block ? 1u : 0u) << 5);
+}
+static inline uint pio_encode_pull(bool if_empty, bool block)
+{
+    return 0x8080u | ((if_empty ? 1u : 0u) << 6) | ((block ? 1u : 0u) << 5);
+}
+static inline uint pio_encode_mov(enum pio_src_dest dest, enum pio_src_dest src)
+{
+    return 0xA000u | ((uint)dest << 5) | ((uint)src & 7u);
+}
+static inline uint pio_encode_mov_not(enum pio_src_dest dest, enum pio_src_dest src)
+{
+    return 0xA000u | ((uint)dest << 5) | (1u << 3) | ((uint)src & 7u);
+}
+static inline uint pio_encode_irq_set(bool relative, uint irq) { return 0xC000u | (relative ? 0x10u : 0u) | (irq & 7u); }
+static inline uint pio_encode_irq_clear(bool relative, uint irq)
+{
+    return 0xC040u | (relative ? 0x10u : 0u) | (irq & 7u);
+}
+static inline uint pio_encode_set(enum pio_src_dest dest, uint value) { return 0xE000u | ((uint)dest << 5) | (value & 31u); }
+static inline uint pio_encode_nop(void) { return pio_encode_mov(pio_y, pio_y); }
+static inline uint pio_encode_delay(uint cycles) { return (cycles & 31u) << 8; }
+
+static inline uint pio_get_index(PIO pio) { return (uint)(pio - sim_pio_hw); }
+
+// RP2350 numbering: PIO0_IRQ_0 is 15, two lines per PIO block.
+enum pio_interrupt_source { pis_interrupt0 = 8u, pis_interrupt1, pis_interrupt2, pis_interrupt3 };
+static inline uint pio_get_irq_num(PIO pio, uint irqn) { return 15u + (2u * pio_get_index(pio)) + irqn; }
+static inline uint pio_get_dreq(PIO pio, uint sm, bool is_tx)
+{
+    return (pio_get_index(pio) * 8u) + (is_tx ? 0u : 4u) + sm;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *program);
+void pio_clear_instruction_memory(PIO pio);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_claim(PIO pio, uint sm);
+void pio_sm_unclaim(PIO pio, uint sm);
+int pio_set_gpio_base(PIO pio, uint gpio_base);
+void pio_gpio_init(PIO pio, uint pin);
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+void pio_sm_set_config(PIO pio, uint sm, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_restart(PIO pio, uint sm);
+void pio_sm_clear_fifos(PIO pio, uint sm);
+void pio_sm_exec(PIO pio, uint sm, uint instr);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+uint32_t pio_sm_get(PIO pio, uint sm);
+void pio_interrupt_clear(PIO pio, uint irq);
+void pio_set_irq0_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled);
+
+static inline void pio_sm_put(PIO pio, uint sm, uint32_t data) { pio_sm_put_blocking(pio, sm, data); }
+static inline void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin, uint count, bool is_out)
+{
+    (void)pio; (void)sm; (void)pin; (void)count; (void)is_out;
+}
+static inline void pio_sm_set_pindirs_with_mask64(PIO pio, uint sm, uint64_t values, uint64_t mask)
+{
+    (void)pio; (void)sm; (void)values; (void)mask;
+}
+
+#endif // SIM_HARDWARE_PIO_H
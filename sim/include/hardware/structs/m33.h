@@ -0,0 +1,26 @@
+/**
+ * Host simulation shim - hardware/structs/m33.h
+ *
+ * Only the DWT cycle counter is modelled. Each m33_hw access refreshes
+ * dwt_cyccnt from the host monotonic clock at a nominal 1 GHz, so cycle
+ * deltas measured by firmware benchmarks read as host nanoseconds.
+ */
+
+#ifndef SIM_HARDWARE_STRUCTS_M33_H
+#define SIM_HARDWARE_STRUCTS_M33_H
+
+#include "pico.h"
+
+#define M33_DEMCR_TRCENA_BITS 0x01000000u
+#define M33_DWT_CTRL_CYCCNTENA_BITS 0x00000001u
+
+typedef struct {
+    volatile uint32_t dwt_ctrl;
+    volatile uint32_t dwt_cyccnt;
+    volatile uint32_t demcr;
+} m33_hw_t;
+
+m33_hw_t *sim_m33_hw(void);
+#define m33_hw (sim_m33_hw())
+
+#endif // SIM_HARDWARE_STRUCTS_M33_H
@@ -0,0 +1,17 @@
+#ifndef SIM_HARDWARE_STRUCTS_WATCHDOG_H
+#define SIM_HARDWARE_STRUCTS_WATCHDOG_H
+
+#include "pico.h"
+
+typedef struct {
+    volatile uint32_t ctrl;
+    volatile uint32_t load;
+    volatile uint32_t reason;
+    volatile uint32_t scratch[8];
+    volatile uint32_t tick;
+} watchdog_hw_t;
+
+extern watchdog_hw_t sim_watchdog_hw;
+#define watchdog_hw (&sim_watchdog_hw)
+
+#endif // SIM_HARDWARE_STRUCTS_WATCHDOG_H
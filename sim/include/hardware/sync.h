@@ -0,0 +1,17 @@
+#ifndef SIM_HARDWARE_SYNC_H
+#define SIM_HARDWARE_SYNC_H
+
+#include "pico.h"
+
+static inline void __dmb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __dsb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __compiler_memory_barrier(void) { __asm__ volatile("" ::: "memory"); }
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void)status; }
+
+// WFE sleeps until the next simulated interrupt (or a 1 ms cap).
+void sim_wfe(void);
+static inline void __wfe(void) { sim_wfe(); }
+static inline void __sev(void) {}
+
+#endif // SIM_HARDWARE_SYNC_H
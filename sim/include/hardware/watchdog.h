@@ -0,0 +1,9 @@
+#ifndef SIM_HARDWARE_WATCHDOG_H
+#define SIM_HARDWARE_WATCHDOG_H
+
+#include "hardware/structs/watchdog.h"
+
+// A reboot ends the simulation run.
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms);
+
+#endif // SIM_HARDWARE_WATCHDOG_H
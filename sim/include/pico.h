@@ -0,0 +1,34 @@
+/**
+ * Host simulation shim - pico.h
+ *
+ * Just enough of the Pico SDK platform header to compile the firmware
+ * modules on Linux. Section attributes collapse to nothing; flash/XIP is
+ * backed by a plain array owned by sim_hal.c.
+ */
+
+#ifndef SIM_PICO_H
+#define SIM_PICO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+#define __scratch_x(group)
+#define __scratch_y(group)
+#define __not_in_flash_func(func) func
+#define __no_inline_not_in_flash_func(func) __attribute__((noinline)) func
+#define __time_critical_func(func) func
+#define __force_inline inline __attribute__((always_inline))
+
+#define PICO_DEFAULT_LED_PIN 25
+#define PICO_FLASH_SIZE_BYTES (2u * 1024u * 1024u)
+
+extern uint8_t sim_flash_image[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)sim_flash_image)
+
+// Polling loops yield simulated time to the other core.
+void tight_loop_contents(void);
+
+#endif // SIM_PICO_H
@@ -0,0 +1,9 @@
+#ifndef SIM_PICO_MULTICORE_H
+#define SIM_PICO_MULTICORE_H
+
+#include "pico.h"
+
+// Starts a host thread that runs in lockstep with core 0 on simulated time.
+void multicore_launch_core1(void (*entry)(void));
+
+#endif // SIM_PICO_MULTICORE_H
@@ -0,0 +1,13 @@
+#ifndef SIM_PICO_STDLIB_H
+#define SIM_PICO_STDLIB_H
+
+#include "pico.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+#include <stdio.h>
+
+static inline void stdio_init_all(void) {}
+static inline void stdio_flush(void) { fflush(stdout); }
+
+#endif // SIM_PICO_STDLIB_H
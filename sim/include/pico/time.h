@@ -0,0 +1,34 @@
+/**
+ * Host simulation shim - pico/time.h
+ *
+ * Time is simulated per core (see sim_hal.c); every call returns the calling
+ * core's virtual time, and sleeps advance it.
+ */
+
+#ifndef SIM_PICO_TIME_H
+#define SIM_PICO_TIME_H
+
+#include "pico.h"
+
+typedef uint64_t absolute_time_t;
+
+uint64_t time_us_64(void);
+void sleep_us(uint64_t us);
+
+static inline uint32_t time_us_32(void) { return (uint32_t)time_us_64(); }
+static inline absolute_time_t get_absolute_time(void) { return time_us_64(); }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000u); }
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to)
+{
+    return (int64_t)(to - from);
+}
+static inline absolute_time_t make_timeout_time_us(uint64_t us) { return time_us_64() + us; }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return time_us_64() + (uint64_t)ms * 1000u; }
+// WFE until the next simulated interrupt or the deadline; true once it has
+// passed.
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp);
+static inline void sleep_ms(uint32_t ms) { sleep_us((uint64_t)ms * 1000u); }
+static inline void busy_wait_us(uint64_t us) { sleep_us(us); }
+
+#endif // SIM_PICO_TIME_H
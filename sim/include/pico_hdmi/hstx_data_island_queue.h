@@ -0,0 +1,16 @@
+#ifndef SIM_PICO_HDMI_HSTX_DATA_ISLAND_QUEUE_H
+#define SIM_PICO_HDMI_HSTX_DATA_ISLAND_QUEUE_H
+
+#include "pico_hdmi/hstx_packet.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define HSTX_DI_QUEUE_SIZE 256u
+
+void hstx_di_queue_init(void);
+bool hstx_di_queue_push(const hstx_data_island_t *island);
+uint32_t hstx_di_queue_get_level(void);
+bool hstx_di_queue_get_hsync_active(void);
+
+#endif // SIM_PICO_HDMI_HSTX_DATA_ISLAND_QUEUE_H
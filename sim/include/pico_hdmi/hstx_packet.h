@@ -0,0 +1,34 @@
+/**
+ * Host simulation shim - pico_hdmi/hstx_packet.h
+ *
+ * Packet and data-island types are opaque payload carriers here: the sim only
+ * counts the audio samples that reach the HDMI stream.
+ */
+
+#ifndef SIM_PICO_HDMI_HSTX_PACKET_H
+#define SIM_PICO_HDMI_HSTX_PACKET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    int16_t left;
+    int16_t right;
+} audio_sample_t;
+
+typedef struct {
+    uint8_t header[4];
+    uint8_t subpacket[4][8];
+    uint8_t audio_sample_count;
+} hstx_packet_t;
+
+typedef struct {
+    hstx_packet_t packet;
+    bool vsync;
+    bool hsync;
+} hstx_data_island_t;
+
+int hstx_packet_set_audio_samples(hstx_packet_t *packet, const audio_sample_t *samples, int count, int frame_counter);
+void hstx_encode_data_island(hstx_data_island_t *island, const hstx_packet_t *packet, bool vsync, bool hsync);
+
+#endif // SIM_PICO_HDMI_HSTX_PACKET_H
@@ -0,0 +1,48 @@
+/**
+ * Host simulation shim - pico_hdmi/video_output_rt.h
+ *
+ * Mirrors the RT backend API used by the firmware. video_output_core1_run()
+ * is the simulated scanout engine (sim_hdmi.c): it walks the selected mode's
+ * line timing, calls the scanline/vsync callbacks and the background task,
+ * and drains the data-island queue at the HDMI audio rate.
+ */
+
+#ifndef SIM_PICO_HDMI_VIDEO_OUTPUT_RT_H
+#define SIM_PICO_HDMI_VIDEO_OUTPUT_RT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct video_mode {
+    uint32_t h_active_pixels;
+    uint32_t h_front_porch;
+    uint32_t h_sync_width;
+    uint32_t h_back_porch;
+    uint32_t h_total_pixels;
+    uint32_t v_active_lines;
+    uint32_t v_front_porch;
+    uint32_t v_sync_width;
+    uint32_t v_back_porch;
+    uint32_t v_total_lines;
+    uint32_t pixel_clock_hz;
+    const char *name;
+} video_mode_t;
+
+typedef void (*video_output_scanline_cb_t)(uint32_t v_scanline, uint32_t active_line, uint32_t *dst);
+typedef void (*video_output_vsync_cb_t)(void);
+typedef void (*video_output_task_fn)(void);
+
+extern const video_mode_t video_mode_480_p;
+extern const video_mode_t video_mode_240_p;
+extern const video_mode_t video_mode_720_p;
+extern const video_mode_t *video_output_active_mode;
+extern volatile uint32_t video_frame_count;
+
+void video_output_set_mode(const video_mode_t *mode);
+void video_output_init(uint32_t frame_width, uint32_t frame_height);
+void video_output_set_scanline_callback(video_output_scanline_cb_t cb);
+void video_output_set_vsync_callback(video_output_vsync_cb_t cb);
+void video_output_set_background_task(video_output_task_fn task);
+void video_output_core1_run(void);
+
+#endif // SIM_PICO_HDMI_VIDEO_OUTPUT_RT_H
@@ -0,0 +1,132 @@
+# Host-sim stand-in for pioasm.
+#
+# Usage: cmake -DPIO_SOURCE=<file.pio> -DPIO_HEADER=<file.pio.h> -P pio_stub_header.cmake
+#
+# Emits the same C surface pioasm would (NAME_program, NAME_wrap_target,
+# NAME_wrap, public defines and label offsets, NAME_program_get_default_config
+# and the verbatim "% c-sdk" blocks) so firmware sources compile unchanged on
+# the host. The instruction words themselves are zero: the simulated PIO
+# models the capture programs behaviourally instead of executing them. Lines
+# are walked with string(FIND) rather than CMake lists so ';' comments and
+# '[n]' delays in the PIO source pass through untouched.
+
+if(NOT PIO_SOURCE OR NOT PIO_HEADER)
+    message(FATAL_ERROR "PIO_SOURCE and PIO_HEADER are required")
+endif()
+
+file(READ "${PIO_SOURCE}" content)
+get_filename_component(pio_name "${PIO_SOURCE}" NAME)
+
+set(out "// Generated from ${pio_name} by sim/pio_stub_header.cmake - do not edit.\n")
+string(APPEND out "#pragma once\n\n#include \"hardware/pio.h\"\n")
+
+set(program "")
+set(count 0)
+set(wrap_target 0)
+set(wrap -1)
+set(in_sdk FALSE)
+set(sdk_blocks "")
+
+macro(flush_program)
+    if(NOT program STREQUAL "")
+        if(wrap LESS 0)
+            math(EXPR wrap "${count} - 1")
+        endif()
+        if(count EQUAL 0)
+            set(count 1)
+        endif()
+        string(APPEND out "\n#define ${program}_wrap_target ${wrap_target}\n")
+        string(APPEND out "#define ${program}_wrap ${wrap}\n")
+        string(APPEND out "${program_defines}")
+        string(APPEND out "\nstatic const uint16_t ${program}_program_instructions[${count}] = {0};\n\n")
+        string(APPEND out "static const struct pio_program ${program}_program = {\n")
+        string(APPEND out "    .instructions = ${program}_program_instructions,\n")
+        string(APPEND out "    .length = ${count},\n")
+        string(APPEND out "    .origin = -1,\n")
+        string(APPEND out "};\n\n")
+        string(APPEND out "static inline pio_sm_config ${program}_program_get_default_config(uint offset)\n{\n")
+        string(APPEND out "    pio_sm_config c = pio_get_default_sm_config();\n")
+        string(APPEND out "    sm_config_set_wrap(&c, offset + ${program}_wrap_target, offset + ${program}_wrap);\n")
+        string(APPEND out "    return c;\n}\n")
+    endif()
+endmacro()
+
+set(program_defines "")
+string(APPEND content "\n")
+while(NOT content STREQUAL "")
+    string(FIND "${content}" "\n" nl)
+    string(SUBSTRING "${content}" 0 ${nl} line)
+    math(EXPR next "${nl} + 1")
+    string(SUBSTRING "${content}" ${next} -1 content)
+
+    if(in_sdk)
+        string(STRIP "${line}" stripped)
+        if(stripped STREQUAL "%}")
+            set(in_sdk FALSE)
+        else()
+            string(APPEND sdk_blocks "${line}\n")
+        endif()
+        continue()
+    endif()
+
+    # Strip ';' and '//' comments, then whitespace.
+    string(FIND "${line}" ";" semi)
+    if(semi GREATER -1)
+        string(SUBSTRING "${line}" 0 ${semi} line)
+    endif()
+    string(FIND "${line}" "//" slashes)
+    if(slashes GREATER -1)
+        string(SUBSTRING "${line}" 0 ${slashes} line)
+    endif()
+    string(STRIP "${line}" line)
+    if(line STREQUAL "")
+        continue()
+    endif()
+
+    if(line MATCHES "^% *c-sdk")
+        set(in_sdk TRUE)
+    elseif(line MATCHES "^\\.program +([A-Za-z_][A-Za-z0-9_]*)")
+        flush_program()
+        set(program "${CMAKE_MATCH_1}")
+        set(count 0)
+        set(wrap_target 0)
+        set(wrap -1)
+        set(program_defines "")
+    elseif(line STREQUAL ".wrap_target")
+        set(wrap_target ${count})
+    elseif(line STREQUAL ".wrap")
+        math(EXPR wrap "${count} - 1")
+    elseif(line MATCHES "^\\.define +PUBLIC +([A-Za-z_][A-Za-z0-9_]*) +(.+)$")
+        if(program STREQUAL "")
+            string(APPEND out "#define ${CMAKE_MATCH_1} ${CMAKE_MATCH_2}\n")
+        else()
+            string(APPEND program_defines "#define ${program}_${CMAKE_MATCH_1} ${CMAKE_MATCH_2}\n")
+        endif()
+    elseif(line MATCHES "^\\.")
+        # Other directives (.side_set, .origin, .define) do not emit words.
+    else()
+        if(line MATCHES "^([Pp][Uu][Bb][Ll][Ii][Cc] +)?([A-Za-z_][A-Za-z0-9_]*):(.*)$")
+            if(NOT CMAKE_MATCH_1 STREQUAL "")
+                string(APPEND program_defines "#define ${program}_offset_${CMAKE_MATCH_2} ${count}u\n")
+            endif()
+            string(STRIP "${CMAKE_MATCH_3}" line)
+        endif()
+        if(NOT line STREQUAL "")
+            math(EXPR count "${count} + 1")
+        endif()
+    endif()
+endwhile()
+flush_program()
+
+if(NOT sdk_blocks STREQUAL "")
+    string(APPEND out "\n${sdk_blocks}")
+endif()
+
+# Only touch the header when it changes so dependents do not rebuild.
+if(EXISTS "${PIO_HEADER}")
+    file(READ "${PIO_HEADER}" previous)
+    if(previous STREQUAL out)
+        return()
+    endif()
+endif()
+file(WRITE "${PIO_HEADER}" "${out}")
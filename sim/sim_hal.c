@@ -0,0 +1,1127 @@
+/**
+ * Host simulation - Pico SDK HAL shim
+ *
+ * Implements the subset of the SDK the firmware modules use: lockstep
+ * virtual time for the two cores, GPIO reads from the synthetic SNES
+ * generator, behavioural models of the capture state machines
+ * (snes_hard_sync on PIO1, snes_line_count on PIO2, I2S on PIO0) and the DMA
+ * channels they pace, the interpolators, plus flash and watchdog backing
+ * stores.
+ */
+
+#include "sim_hal.h"
+
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/gpio.h"
+#include "hardware/interp.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/structs/m33.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+#include "pico/multicore.h"
+#include "pico/time.h"
+
+#include "config.h"
+#include "snes_pins.h"
+#include "snes_signal_gen.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIM_IDLE_STEP_PS     1000000ULL    // 1 us per unqualified spin
+#define SIM_POLL_MAX_STEP_PS 1000000000ULL // 1 ms cap when waiting on a pin edge
+#define SIM_PIO_RX_FIFO_DEPTH 4U
+#define SIM_PIO_SAMPLE_CYCLES 5U // PCLK edge to `in pins` at zero hold delay
+
+#if ENABLE_HIRES
+#define SIM_CAPTURE_SAMPLES_PER_DOT 2U // snes_hard_sync_hires*: both PCLK edges
+#else
+#define SIM_CAPTURE_SAMPLES_PER_DOT 1U
+#endif
+
+// =============================================================================
+// Lockstep virtual time
+// =============================================================================
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_cond = PTHREAD_COND_INITIALIZER;
+static uint64_t s_core_ps[2];
+static bool s_core1_running = false;
+static __thread unsigned s_this_core = 0;
+static __thread int s_polled_pin = -1;
+static __thread uint64_t s_poll_wake_ps; // next event a polling loop is waiting on
+static uint64_t s_core0_resume_ns; // host ns Core 0 last came back from a wait
+static uint64_t s_core0_busy_ns;   // host ns Core 0 ran between waits once capturing
+static uint64_t s_capture_frames;  // capture SM frame IRQs or releases (frame starts)
+
+static void i2s_tick(uint64_t now_ps);
+static void video_stream_tick(uint64_t now_ps);
+static void pio_irq_dispatch(uint64_t now_ps);
+
+static bool core_may_run(unsigned core)
+{
+    if (!s_core1_running) {
+        return core == 0U;
+    }
+    const unsigned other = core ^ 1U;
+    return s_core_ps[core] < s_core_ps[other] || (s_core_ps[core] == s_core_ps[other] && core == 0U);
+}
+
+unsigned sim_core_num(void)
+{
+    return s_this_core;
+}
+
+uint64_t sim_now_ps(void)
+{
+    return s_core_ps[s_this_core];
+}
+
+void sim_advance_ps(uint64_t ps)
+{
+    // Whatever was polled is stale once time moves.
+    s_polled_pin = -1;
+    s_poll_wake_ps = 0;
+    if (s_this_core == 0U && s_core0_resume_ns != 0U) {
+        s_core0_busy_ns += sim_host_ns() - s_core0_resume_ns;
+    }
+    pthread_mutex_lock(&s_lock);
+    s_core_ps[s_this_core] += ps;
+    pthread_cond_broadcast(&s_cond);
+    while (!core_may_run(s_this_core)) {
+        pthread_cond_wait(&s_cond, &s_lock);
+    }
+    pthread_mutex_unlock(&s_lock);
+    if (s_this_core == 0U) {
+        pio_irq_dispatch(s_core_ps[0]);
+        if (s_capture_frames != 0U) {
+            s_core0_resume_ns = sim_host_ns();
+        }
+    }
+
+    // Core 1 polls the I2S DMA ring (and, with the raw capture ring, the
+    // video DMA), so those streams follow its clock.
+    if (s_this_core == 1U) {
+        i2s_tick(s_core_ps[1]);
+        video_stream_tick(s_core_ps[1]);
+    }
+}
+
+void sim_advance_to_ps(uint64_t t_ps)
+{
+    const uint64_t now = sim_now_ps();
+    sim_advance_ps((t_ps > now) ? (t_ps - now) : 0U);
+}
+
+uint64_t sim_host_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+void tight_loop_contents(void)
+{
+    const uint64_t now = sim_now_ps();
+    uint64_t step = SIM_IDLE_STEP_PS;
+    if (s_polled_pin >= 0 && snes_gen_is_video_pin((unsigned)s_polled_pin)) {
+        // Skip straight to the next edge of the pin being polled.
+        const uint64_t edge = snes_gen_next_edge_ps((unsigned)s_polled_pin, now);
+        step = (edge > now) ? (edge - now) : 1U;
+        if (step > SIM_POLL_MAX_STEP_PS) {
+            step = SIM_POLL_MAX_STEP_PS;
+        }
+    }
+    if (s_poll_wake_ps > now) {
+        // Polling a capture DMA or a line count: stop as it lands.
+        uint64_t wake_step = s_poll_wake_ps - now;
+        if (wake_step > SIM_POLL_MAX_STEP_PS) {
+            wake_step = SIM_POLL_MAX_STEP_PS;
+        }
+        step = (s_polled_pin >= 0 && step < wake_step) ? step : wake_step;
+    }
+    sim_advance_ps(step);
+}
+
+static void poll_wake_at(uint64_t t_ps)
+{
+    if (s_poll_wake_ps == 0U || t_ps < s_poll_wake_ps) {
+        s_poll_wake_ps = t_ps;
+    }
+}
+
+uint64_t time_us_64(void)
+{
+    return sim_now_ps() / 1000000ULL;
+}
+
+void sleep_us(uint64_t us)
+{
+    sim_advance_ps(us * 1000000ULL);
+}
+
+static uint32_t s_sys_clk_khz = 126000U;
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required)
+{
+    (void)required;
+    s_sys_clk_khz = freq_khz;
+    return true;
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index)
+{
+    return (clk_index == clk_sys) ? s_sys_clk_khz * 1000U : 12000000U;
+}
+
+static m33_hw_t s_m33_hw;
+
+m33_hw_t *sim_m33_hw(void)
+{
+    s_m33_hw.dwt_cyccnt = (uint32_t)sim_host_ns();
+    return &s_m33_hw;
+}
+
+interp_hw_t sim_interp_hw[2];
+
+// =============================================================================
+// Multicore
+// =============================================================================
+
+static void (*s_core1_entry)(void);
+
+static void *core1_thread(void *arg)
+{
+    (void)arg;
+    s_this_core = 1U;
+    pthread_mutex_lock(&s_lock);
+    while (!core_may_run(1U)) {
+        pthread_cond_wait(&s_cond, &s_lock);
+    }
+    pthread_mutex_unlock(&s_lock);
+    s_core1_entry();
+    return NULL;
+}
+
+void multicore_launch_core1(void (*entry)(void))
+{
+    pthread_t thread;
+    s_core1_entry = entry;
+    pthread_mutex_lock(&s_lock);
+    s_core_ps[1] = s_core_ps[0];
+    s_core1_running = true;
+    pthread_mutex_unlock(&s_lock);
+    if (pthread_create(&thread, NULL, core1_thread, NULL) != 0) {
+        fprintf(stderr, "sim: failed to start core 1 thread\n");
+        exit(2);
+    }
+    pthread_detach(thread);
+}
+
+// =============================================================================
+// GPIO
+// =============================================================================
+
+static uint32_t s_gpio_out_xor;
+
+bool gpio_get(uint pin)
+{
+    s_polled_pin = (int)pin;
+    if (snes_gen_drives_pin(pin)) {
+        return snes_gen_pin(pin, sim_now_ps());
+    }
+    return true;
+}
+
+uint32_t gpio_get_all(void)
+{
+    const uint64_t now = sim_now_ps();
+    uint32_t value = 0;
+    for (uint pin = 0; pin < 32U; pin++) {
+        const bool level = snes_gen_drives_pin(pin) ? snes_gen_pin(pin, now) : true;
+        value |= (uint32_t)level << pin;
+    }
+    return value;
+}
+
+void gpio_put(uint pin, bool value)
+{
+    (void)pin;
+    (void)value;
+}
+
+void gpio_xor_mask(uint32_t mask)
+{
+    s_gpio_out_xor ^= mask;
+}
+
+// =============================================================================
+// Flash / watchdog
+// =============================================================================
+
+uint8_t sim_flash_image[PICO_FLASH_SIZE_BYTES];
+watchdog_hw_t sim_watchdog_hw;
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    memset(&sim_flash_image[flash_offs], 0xFF, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+    memcpy(&sim_flash_image[flash_offs], data, count);
+}
+
+void watchdog_reboot(uint32_t pc, uint32_t sp, uint32_t delay_ms)
+{
+    (void)pc;
+    (void)sp;
+    (void)delay_ms;
+    host_sim_finish("firmware requested a watchdog reboot");
+}
+
+// =============================================================================
+// PIO
+// =============================================================================
+
+typedef enum {
+    SIM_SM_ROLE_NONE = 0,
+    SIM_SM_ROLE_VIDEO,
+    SIM_SM_ROLE_LINE_COUNT,
+    SIM_SM_ROLE_I2S,
+} sim_sm_role_t;
+
+typedef struct {
+    bool claimed;
+    bool enabled;
+    bool released;         // video, polled frame sync: past `wait 1 irq 4`
+    uint64_t next_line;    // video: next absolute SNES line the SM will capture
+    uint64_t irq_from_ps;  // video, line count: IRQs up to here are raised
+    uint32_t tx_word;      // last word the firmware pushed to the TX FIFO
+    uint32_t frame_gen;    // video: bumped on every frame IRQ
+    uint64_t count_from_ps;                 // line count: next frame starts after this
+    uint32_t rx_fifo[SIM_PIO_RX_FIFO_DEPTH]; // line count: pushed words, oldest first
+    uint32_t rx_level;
+    bool packed; // video: two 16-bit samples per FIFO word (IN_BASE = B4)
+} sim_sm_t;
+
+pio_hw_t sim_pio_hw[NUM_PIOS];
+static sim_sm_t s_sm[NUM_PIOS][NUM_PIO_STATE_MACHINES];
+static uint32_t s_pio_used_mask[NUM_PIOS];
+
+static uint sm_in_pin(uint pio_idx, uint sm)
+{
+    const pio_hw_t *hw = &sim_pio_hw[pio_idx];
+    return hw->gpiobase + ((hw->sm[sm].pinctrl & PIO_SM_PINCTRL_IN_BASE_BITS) >> PIO_SM_PINCTRL_IN_BASE_LSB);
+}
+
+static sim_sm_role_t sm_role(uint pio_idx, uint sm)
+{
+    const pio_hw_t *hw = &sim_pio_hw[pio_idx];
+    const uint in_pin = sm_in_pin(pio_idx, sm);
+    if (in_pin == PIN_SNES_B4) {
+        return SIM_SM_ROLE_VIDEO; // packed capture programs start at the colour pins
+    }
+    if (in_pin == PIN_SNES_BASE) {
+        // snes_line_count branches on VBLANK, snes_hard_sync on PIXEL_VALID.
+        const uint jmp_pin = hw->gpiobase + ((hw->sm[sm].execctrl >> 24) & 31U);
+        return (jmp_pin == PIN_SNES_VBLANK) ? SIM_SM_ROLE_LINE_COUNT : SIM_SM_ROLE_VIDEO;
+    }
+    if (in_pin == PIN_AUDIO_SDATA) {
+        return SIM_SM_ROLE_I2S;
+    }
+    return SIM_SM_ROLE_NONE;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *program)
+{
+    const uint idx = pio_get_index(pio);
+    const uint32_t mask = (program->length >= 32U) ? 0xFFFFFFFFU : ((1U << program->length) - 1U);
+    for (int offset = (int)PIO_INSTRUCTION_COUNT - program->length; offset >= 0; offset--) {
+        if ((s_pio_used_mask[idx] & (mask << offset)) == 0U) {
+            s_pio_used_mask[idx] |= mask << offset;
+            for (uint i = 0; i < program->length; i++) {
+                pio->instr_mem[offset + i] = program->instructions[i];
+            }
+            return (uint)offset;
+        }
+    }
+    fprintf(stderr, "sim: PIO%u out of instruction memory (%u words)\n", idx, program->length);
+    exit(2);
+}
+
+void pio_clear_instruction_memory(PIO pio)
+{
+    s_pio_used_mask[pio_get_index(pio)] = 0;
+    memset((void *)pio->instr_mem, 0, sizeof(pio->instr_mem));
+}
+
+int pio_claim_unused_sm(PIO pio, bool required)
+{
+    const uint idx = pio_get_index(pio);
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+        if (!s_sm[idx][sm].claimed) {
+            s_sm[idx][sm].claimed = true;
+            return (int)sm;
+        }
+    }
+    if (required) {
+        fprintf(stderr, "sim: no free state machine on PIO%u\n", idx);
+        exit(2);
+    }
+    return -1;
+}
+
+void pio_sm_claim(PIO pio, uint sm)
+{
+    s_sm[pio_get_index(pio)][sm].claimed = true;
+}
+
+void pio_sm_unclaim(PIO pio, uint sm)
+{
+    s_sm[pio_get_index(pio)][sm].claimed = false;
+}
+
+int pio_set_gpio_base(PIO pio, uint gpio_base)
+{
+    pio->gpiobase = gpio_base;
+    return 0;
+}
+
+void pio_gpio_init(PIO pio, uint pin)
+{
+    (void)pio;
+    (void)pin;
+}
+
+void pio_sm_set_config(PIO pio, uint sm, const pio_sm_config *config)
+{
+    pio->sm[sm].clkdiv = config->clkdiv;
+    pio->sm[sm].execctrl = config->execctrl;
+    pio->sm[sm].shiftctrl = config->shiftctrl;
+    pio->sm[sm].pinctrl = config->pinctrl;
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config)
+{
+    sim_sm_t *state = &s_sm[pio_get_index(pio)][sm];
+    pio_sm_set_enabled(pio, sm, false);
+    pio_sm_set_config(pio, sm, config);
+    pio->sm[sm].addr = initial_pc;
+    state->tx_word = 0;
+}
+
+// snes_hard_sync from its frame_top label: the first frame whose VBLANK falls
+// after now, or, with the polled frame sync, the release wait. (Harmless for
+// the other roles, which only use irq_from_ps.)
+static void video_sm_sync(sim_sm_t *state)
+{
+    state->irq_from_ps = sim_now_ps();
+    state->released = false;
+    snes_gen_frame_top_ps(state->irq_from_ps, &state->next_line);
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled)
+{
+    sim_sm_t *state = &s_sm[pio_get_index(pio)][sm];
+    if (enabled && !state->enabled) {
+        state->count_from_ps = sim_now_ps();
+        video_sm_sync(state);
+    }
+    state->enabled = enabled;
+    if (enabled) {
+        pio->ctrl |= 1U << sm;
+    } else {
+        pio->ctrl &= ~(1U << sm);
+    }
+}
+
+void pio_sm_restart(PIO pio, uint sm)
+{
+    video_sm_sync(&s_sm[pio_get_index(pio)][sm]);
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm)
+{
+    s_sm[pio_get_index(pio)][sm].rx_level = 0;
+}
+
+// Run snes_line_count up to now: one push per frame whose VBLANK fell after
+// the SM started, dropped (push noblock) while the FIFO is full.
+static void line_count_tick(uint pio_idx, uint sm)
+{
+    sim_sm_t *state = &s_sm[pio_idx][sm];
+    if (!state->enabled || sm_role(pio_idx, sm) != SIM_SM_ROLE_LINE_COUNT) {
+        return;
+    }
+    const uint64_t now = sim_now_ps();
+    for (;;) {
+        uint32_t count = 0;
+        const uint64_t push_ps = snes_gen_line_count_push_ps(state->count_from_ps, &count);
+        if (push_ps > now) {
+            break;
+        }
+        if (state->rx_level < SIM_PIO_RX_FIFO_DEPTH) {
+            state->rx_fifo[state->rx_level++] = count;
+        }
+        state->count_from_ps = push_ps;
+    }
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm)
+{
+    const uint idx = pio_get_index(pio);
+    sim_sm_t *state = &s_sm[idx][sm];
+    line_count_tick(idx, sm);
+    if (state->rx_level == 0U && state->enabled && sm_role(idx, sm) == SIM_SM_ROLE_LINE_COUNT) {
+        uint32_t count = 0;
+        poll_wake_at(snes_gen_line_count_push_ps(state->count_from_ps, &count));
+    }
+    return state->rx_level == 0U;
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm)
+{
+    const uint idx = pio_get_index(pio);
+    sim_sm_t *state = &s_sm[idx][sm];
+    line_count_tick(idx, sm);
+    if (state->rx_level == 0U) {
+        return 0; // empty FIFO reads as zero
+    }
+    const uint32_t word = state->rx_fifo[0];
+    state->rx_level--;
+    memmove(&state->rx_fifo[0], &state->rx_fifo[1], state->rx_level * sizeof(state->rx_fifo[0]));
+    return word;
+}
+
+#if ENABLE_PIO_FRAME_SYNC
+// The capture programs run on their own; forced instructions are not modelled.
+void pio_sm_exec(PIO pio, uint sm, uint instr)
+{
+    (void)pio;
+    (void)sm;
+    (void)instr;
+}
+#else
+void pio_sm_exec(PIO pio, uint sm, uint instr)
+{
+    const uint idx = pio_get_index(pio);
+    sim_sm_t *state = &s_sm[idx][sm];
+    if (sm_role(idx, sm) != SIM_SM_ROLE_VIDEO) {
+        return;
+    }
+    if ((instr & 0xE000U) == 0x0000U) {
+        // JMP: back to the release wait.
+        state->released = false;
+    } else if ((instr & 0xE060U) == 0xC000U && (instr & 7U) == 4U) {
+        // IRQ set 4 satisfies `wait 1 irq 4`: capture starts at the next
+        // HBLANK falling edge.
+        if (state->enabled) {
+            state->released = true;
+            state->next_line = snes_gen_first_line_after(sim_now_ps());
+            state->frame_gen++;
+            s_capture_frames++;
+        }
+    }
+}
+#endif
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+    s_sm[pio_get_index(pio)][sm].tx_word = data;
+    pio->txf[sm] = data;
+}
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm)
+{
+    (void)pio;
+    (void)sm;
+    return 0;
+}
+
+void pio_interrupt_clear(PIO pio, uint irq)
+{
+    pio->irq &= ~(1U << irq);
+}
+
+// =============================================================================
+// Interrupts
+// =============================================================================
+// Only `irq set 0` is modelled: snes_hard_sync's at each top of frame and
+// snes_line_count's after each push, with ENABLE_PIO_FRAME_SYNC. It sets the
+// PIO's IRQ 0 flag, which reaches the NVIC through IRQ0_INTE.
+
+#define SIM_NUM_IRQS 64U
+
+static uint32_t s_pio_irq0_inte[NUM_PIOS];
+static irq_handler_t s_irq_handlers[SIM_NUM_IRQS];
+static bool s_irq_enabled[SIM_NUM_IRQS];
+
+void pio_set_irq0_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled)
+{
+    const uint idx = pio_get_index(pio);
+    if (enabled) {
+        s_pio_irq0_inte[idx] |= 1U << source;
+    } else {
+        s_pio_irq0_inte[idx] &= ~(1U << source);
+    }
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler)
+{
+    s_irq_handlers[num] = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+    s_irq_enabled[num] = enabled;
+}
+
+// Next `irq set 0` of a state machine after its last raised one, or
+// UINT64_MAX if it raises none (any, without ENABLE_PIO_FRAME_SYNC).
+static uint64_t sm_next_irq_ps(uint pio_idx, uint sm)
+{
+    const sim_sm_t *state = &s_sm[pio_idx][sm];
+    if (!ENABLE_PIO_FRAME_SYNC || !state->enabled) {
+        return UINT64_MAX;
+    }
+    uint64_t unused = 0;
+    uint32_t count = 0;
+    switch (sm_role(pio_idx, sm)) {
+    case SIM_SM_ROLE_VIDEO:
+        return snes_gen_frame_top_ps(state->irq_from_ps, &unused);
+    case SIM_SM_ROLE_LINE_COUNT:
+        return snes_gen_line_count_push_ps(state->irq_from_ps, &count);
+    default:
+        return UINT64_MAX;
+    }
+}
+
+static uint64_t pio_irq_next_ps(void)
+{
+    uint64_t next = UINT64_MAX;
+    for (uint pio_idx = 0; pio_idx < NUM_PIOS; pio_idx++) {
+        for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+            const uint64_t t = sm_next_irq_ps(pio_idx, sm);
+            next = (t < next) ? t : next;
+        }
+    }
+    return next;
+}
+
+// Raise every IRQ up to now, then run the handlers of pending ones.
+static void pio_irq_dispatch(uint64_t now_ps)
+{
+    for (uint pio_idx = 0; pio_idx < NUM_PIOS; pio_idx++) {
+        for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+            sim_sm_t *state = &s_sm[pio_idx][sm];
+            for (uint64_t t = sm_next_irq_ps(pio_idx, sm); t <= now_ps; t = sm_next_irq_ps(pio_idx, sm)) {
+                sim_pio_hw[pio_idx].irq |= 1U;
+                state->irq_from_ps = t;
+                if (sm_role(pio_idx, sm) == SIM_SM_ROLE_VIDEO) {
+                    state->frame_gen++;
+                    s_capture_frames++;
+                }
+            }
+        }
+        const uint irq = pio_get_irq_num(&sim_pio_hw[pio_idx], 0);
+        if ((sim_pio_hw[pio_idx].irq & (s_pio_irq0_inte[pio_idx] >> pis_interrupt0) & 0xFU) != 0U &&
+            s_irq_enabled[irq] && s_irq_handlers[irq]) {
+            s_irq_handlers[irq]();
+        }
+    }
+}
+
+static void wfe_until(uint64_t limit_ps)
+{
+    const uint64_t next_irq = pio_irq_next_ps();
+    sim_advance_to_ps((next_irq < limit_ps) ? next_irq : limit_ps);
+}
+
+void sim_wfe(void)
+{
+    wfe_until(sim_now_ps() + SIM_POLL_MAX_STEP_PS);
+}
+
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp)
+{
+    const uint64_t deadline_ps = timeout_timestamp * 1000000ULL;
+    if (sim_now_ps() < deadline_ps) {
+        wfe_until(deadline_ps);
+    }
+    return sim_now_ps() >= deadline_ps;
+}
+
+// =============================================================================
+// DMA
+// =============================================================================
+
+typedef struct {
+    bool claimed;
+    dma_channel_config config;
+    uint8_t *write_ptr;
+    const uint8_t *read_ptr;
+    uint32_t count_reload;
+    uint32_t remaining;
+    bool busy;
+    uint64_t armed_ps;
+    bool video_line_assigned;
+    uint64_t video_line;
+    bool chained; // triggered by another channel finishing, not by a CPU
+} sim_dma_t;
+
+dma_hw_t sim_dma_hw;
+static sim_dma_t s_dma[NUM_DMA_CHANNELS];
+static sim_capture_stats_t s_capture_stats;
+static uint64_t s_convert_mark_ns;
+static uint32_t s_convert_mark_gen;
+static bool s_convert_waiting; // Core 0 is in a line wait
+
+static bool dreq_source(uint dreq, uint *pio_idx, uint *sm)
+{
+    if (dreq >= NUM_PIOS * 8U || (dreq % 8U) < 4U) {
+        return false; // not a PIO RX DREQ
+    }
+    *pio_idx = dreq / 8U;
+    *sm = dreq % 4U;
+    return true;
+}
+
+static void dma_sync_registers(uint channel)
+{
+    sim_dma_hw.ch[channel].write_addr = (uint32_t)(uintptr_t)s_dma[channel].write_ptr;
+    sim_dma_hw.ch[channel].read_addr = (uint32_t)(uintptr_t)s_dma[channel].read_ptr;
+    sim_dma_hw.ch[channel].transfer_count = s_dma[channel].remaining;
+}
+
+static sim_sm_t *video_sm_for_channel(uint channel);
+static void video_transfer_advance(uint channel, sim_sm_t *sm, uint64_t now_ps);
+
+static void dma_trigger_at(uint channel, uint64_t t_ps, bool chained)
+{
+    sim_dma_t *d = &s_dma[channel];
+    d->chained = chained;
+    d->remaining = d->count_reload;
+    d->busy = d->remaining > 0U;
+    d->armed_ps = t_ps;
+    d->video_line_assigned = false;
+    dma_sync_registers(channel);
+}
+
+static void dma_trigger(uint channel)
+{
+    dma_trigger_at(channel, sim_now_ps(), false);
+}
+
+static void dma_write_word(sim_dma_t *d, uint32_t word)
+{
+    memcpy(d->write_ptr, &word, sizeof(word));
+    if (d->config.write_increment) {
+        uint8_t *next = d->write_ptr + sizeof(word);
+        if (d->config.ring_write && d->config.ring_size_bits > 0U) {
+            const uintptr_t ring_mask = ((uintptr_t)1U << d->config.ring_size_bits) - 1U;
+            next = (uint8_t *)(((uintptr_t)d->write_ptr & ~ring_mask) | ((uintptr_t)next & ring_mask));
+        }
+        d->write_ptr = next;
+    }
+    if (d->remaining > 0U) {
+        d->remaining--;
+    }
+    d->busy = d->remaining > 0U;
+}
+
+int dma_claim_unused_channel(bool required)
+{
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
+        if (!s_dma[ch].claimed) {
+            s_dma[ch].claimed = true;
+            return (int)ch;
+        }
+    }
+    if (required) {
+        fprintf(stderr, "sim: no free DMA channel\n");
+        exit(2);
+    }
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel)
+{
+    s_dma[channel].claimed = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+    dma_channel_config c = {
+        .read_increment = true,
+        .write_increment = false,
+        .dreq = 0x3F,
+        .size = DMA_SIZE_32,
+        .ring_write = false,
+        .ring_size_bits = 0,
+        .chain_to = channel,
+        .enable = true,
+    };
+    return c;
+}
+
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger)
+{
+    s_dma[channel].config = *config;
+    if (trigger) {
+        dma_trigger(channel);
+    }
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint32_t transfer_count, bool trigger)
+{
+    sim_dma_t *d = &s_dma[channel];
+    d->config = *config;
+    d->write_ptr = (uint8_t *)write_addr;
+    d->read_ptr = (const uint8_t *)read_addr;
+    d->count_reload = transfer_count;
+    d->remaining = transfer_count;
+    dma_sync_registers(channel);
+    if (trigger) {
+        dma_trigger(channel);
+    }
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger)
+{
+    s_dma[channel].count_reload = trans_count;
+    if (trigger) {
+        dma_trigger(channel);
+    }
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger)
+{
+    s_dma[channel].write_ptr = (uint8_t *)write_addr;
+    dma_sync_registers(channel);
+    if (trigger) {
+        dma_trigger(channel);
+    }
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger)
+{
+    s_dma[channel].read_ptr = (const uint8_t *)read_addr;
+    dma_sync_registers(channel);
+    if (trigger) {
+        dma_trigger(channel);
+    }
+}
+
+void dma_channel_start(uint channel)
+{
+    dma_trigger(channel);
+}
+
+void dma_channel_abort(uint channel)
+{
+    s_convert_waiting = false;
+    // Lines that landed before the abort stay written; one the SM has not
+    // pushed yet goes to whichever channel is armed next.
+    sim_sm_t *sm = s_dma[channel].busy ? video_sm_for_channel(channel) : NULL;
+    if (sm) {
+        video_transfer_advance(channel, sm, sim_now_ps());
+        if (s_dma[channel].busy && s_dma[channel].video_line_assigned) {
+            sm->next_line = s_dma[channel].video_line;
+            s_dma[channel].video_line_assigned = false;
+        }
+    }
+    s_dma[channel].busy = false;
+    s_dma[channel].remaining = 0;
+    dma_sync_registers(channel);
+}
+
+// Words the capture SM pushes per line: the dot count it was given, one or
+// two samples per dot (the hires programs sample both PCLK edges), two
+// samples per word when packed.
+static uint32_t video_line_words(const sim_sm_t *sm)
+{
+    const uint32_t samples = (sm->tx_word + 1U) * SIM_CAPTURE_SAMPLES_PER_DOT;
+    return sm->packed ? (samples / 2U) : samples;
+}
+
+static uint32_t video_chunk_words(const sim_dma_t *d, const sim_sm_t *sm)
+{
+    const uint32_t line_words = video_line_words(sm);
+    return (d->remaining < line_words) ? d->remaining : line_words;
+}
+
+// Completion time of the current line of a video transfer, or UINT64_MAX
+// while the capture SM is not producing (disabled, or held for the polled
+// frame sync's release).
+static uint64_t video_transfer_done_ps(sim_dma_t *d, sim_sm_t *sm)
+{
+    if (!d->video_line_assigned) {
+        if (!sm->enabled || (!ENABLE_PIO_FRAME_SYNC && !sm->released)) {
+            return UINT64_MAX;
+        }
+        d->video_line = sm->next_line;
+        d->video_line_assigned = true;
+#if ENABLE_PIO_FRAME_SYNC
+        sm->next_line = snes_gen_capture_line_after(sm->next_line);
+#else
+        sm->next_line++;
+#endif
+
+        const uint64_t first_px =
+            snes_gen_line_start_ps(d->video_line) + ((uint64_t)SNES_GEN_FIRST_PIXEL_DOT * snes_gen_dot_ps());
+        if (d->armed_ps > first_px + ((uint64_t)SIM_PIO_RX_FIFO_DEPTH * snes_gen_dot_ps())) {
+            s_capture_stats.capture_overruns++;
+        }
+    }
+    return snes_gen_capture_done_ps(d->video_line, video_chunk_words(d, sm) * (sm->packed ? 2U : 1U));
+}
+
+// Packed programs shift in only the colour pins, right-shifting with a zero
+// bit below each sample; an invalid pixel is already an all-zero word.
+static uint32_t packed_sample(uint32_t pins)
+{
+    return ((pins >> 2) & 0x7FFFU) << 1;
+}
+
+// Sampling phase the firmware patched into the capture program: the
+// `set x` at its skip label, and the delay on its hold instructions. The
+// stub program image is all zero, so any other non-zero word is a hold.
+static void video_sample_point(const sim_sm_t *sm)
+{
+    const uint pio_idx = (uint)((sm - &s_sm[0][0]) / NUM_PIO_STATE_MACHINES);
+    const pio_hw_t *hw = &sim_pio_hw[pio_idx];
+    uint32_t skip = SNES_GEN_FIRST_PIXEL_DOT;
+    uint32_t delay = 0;
+    for (uint i = 0; i < PIO_INSTRUCTION_COUNT; i++) {
+        const uint32_t w = hw->instr_mem[i];
+        if ((w & 0xE0E0U) == 0xE020U) {
+            skip = (w & 31U) + 1U;
+        } else if (((w >> 8) & 31U) > delay) {
+            delay = (w >> 8) & 31U;
+        }
+    }
+    // Hold plus `in pins` after the edge is seen, as the firmware counts it.
+    const uint64_t cycles = SIM_PIO_SAMPLE_CYCLES + delay;
+    snes_gen_set_sample_point(skip, (cycles * 1000000000ULL) / s_sys_clk_khz);
+}
+
+// Deliver the current line, completed at `done_ps`. A transfer longer than a
+// line stays armed for the next one; a finished channel triggers its chain.
+static void video_transfer_complete(uint channel, const sim_sm_t *sm, uint64_t done_ps)
+{
+    sim_dma_t *d = &s_dma[channel];
+    static uint32_t line_words[1024];
+    const uint32_t count = video_chunk_words(d, sm);
+    video_sample_point(sm);
+    if (sm->packed) {
+        snes_gen_fill_capture_words(d->video_line, line_words, count * 2U);
+        for (uint32_t i = 0; i < count; i++) {
+            dma_write_word(d, packed_sample(line_words[2U * i]) | (packed_sample(line_words[(2U * i) + 1U]) << 16));
+        }
+    } else {
+        snes_gen_fill_capture_words(d->video_line, line_words, count);
+        for (uint32_t i = 0; i < count; i++) {
+            dma_write_word(d, line_words[i]);
+        }
+    }
+    d->video_line_assigned = false;
+    d->armed_ps = done_ps;
+    dma_sync_registers(channel);
+    s_capture_stats.lines_captured++;
+    if (!d->busy && d->config.chain_to != channel) {
+        dma_trigger_at(d->config.chain_to, done_ps, true);
+    }
+}
+
+static sim_sm_t *video_sm_for_channel(uint channel)
+{
+    uint pio_idx = 0;
+    uint sm = 0;
+    if (!dreq_source(s_dma[channel].config.dreq, &pio_idx, &sm) || sm_role(pio_idx, sm) != SIM_SM_ROLE_VIDEO) {
+        return NULL;
+    }
+    s_sm[pio_idx][sm].packed = (sm_in_pin(pio_idx, sm) == PIN_SNES_B4);
+    return &s_sm[pio_idx][sm];
+}
+
+// Deliver every line of a video transfer that has completed by `now_ps`.
+static void video_transfer_advance(uint channel, sim_sm_t *sm, uint64_t now_ps)
+{
+    sim_dma_t *d = &s_dma[channel];
+    while (d->busy) {
+        const uint64_t done = video_transfer_done_ps(d, sm);
+        if (done > now_ps) {
+            break;
+        }
+        video_transfer_complete(channel, sm, done);
+    }
+}
+
+// Frame-long or chained video transfers run with no CPU waiting on them;
+// whoever reads their registers sees the progress up to its own clock.
+static void video_stream_tick(uint64_t now_ps)
+{
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
+        sim_dma_t *d = &s_dma[ch];
+        if (!d->busy) {
+            continue;
+        }
+        sim_sm_t *sm = video_sm_for_channel(ch);
+        if (sm && (d->chained || d->config.chain_to != ch || d->count_reload > video_line_words(sm))) {
+            video_transfer_advance(ch, sm, now_ps);
+        }
+    }
+}
+
+// Core 0 time between line waits is the per-line conversion cost.
+static void convert_wait_begin(const sim_sm_t *sm)
+{
+    if (s_convert_waiting) {
+        return;
+    }
+    s_convert_waiting = true;
+    if (s_convert_mark_ns != 0U && s_convert_mark_gen == sm->frame_gen) {
+        const uint64_t busy_ns = sim_host_ns() - s_convert_mark_ns;
+        s_capture_stats.convert_lines++;
+        s_capture_stats.convert_ns_total += busy_ns;
+        if (busy_ns > s_capture_stats.convert_ns_max) {
+            s_capture_stats.convert_ns_max = busy_ns;
+        }
+    }
+}
+
+static void convert_wait_end(const sim_sm_t *sm)
+{
+    s_convert_waiting = false;
+    s_convert_mark_ns = sim_host_ns();
+    s_convert_mark_gen = sm->frame_gen;
+    // Generating the line was the SNES's work, not Core 0's.
+    s_core0_resume_ns = s_convert_mark_ns;
+}
+
+// A line-sized transfer Core 0 waits on, as opposed to a frame stream.
+static bool video_line_wait(const sim_dma_t *d, const sim_sm_t *sm)
+{
+    return !d->chained && d->count_reload <= video_line_words(sm);
+}
+
+bool dma_channel_is_busy(uint channel)
+{
+    sim_dma_t *d = &s_dma[channel];
+    if (!d->busy) {
+        return false;
+    }
+    sim_sm_t *sm = video_sm_for_channel(channel);
+    if (sm) {
+        const bool line_wait = video_line_wait(d, sm);
+        if (line_wait) {
+            convert_wait_begin(sm);
+        }
+        video_transfer_advance(channel, sm, sim_now_ps());
+        if (d->busy) {
+            const uint64_t done = video_transfer_done_ps(d, sm);
+            if (done != UINT64_MAX) {
+                poll_wake_at(done);
+            }
+        } else if (line_wait) {
+            convert_wait_end(sm);
+        }
+    }
+    return d->busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel)
+{
+    sim_dma_t *d = &s_dma[channel];
+    if (!d->busy) {
+        return;
+    }
+    sim_sm_t *sm = video_sm_for_channel(channel);
+    if (!sm) {
+        // Unpaced (memory-to-memory) transfers complete immediately.
+        while (d->remaining > 0U && d->read_ptr) {
+            uint32_t word;
+            memcpy(&word, d->read_ptr, sizeof(word));
+            if (d->config.read_increment) {
+                d->read_ptr += sizeof(word);
+            }
+            dma_write_word(d, word);
+        }
+        d->busy = false;
+        dma_sync_registers(channel);
+        return;
+    }
+
+    convert_wait_begin(sm);
+    while (d->busy) {
+        uint64_t done = video_transfer_done_ps(d, sm);
+        while (done == UINT64_MAX) {
+            // Real hardware would block here forever; keep time moving so the
+            // scanout engine can end the run.
+            sim_advance_ps(snes_gen_line_ps());
+            done = video_transfer_done_ps(d, sm);
+        }
+        sim_advance_to_ps(done);
+        video_transfer_complete(channel, sm, done);
+    }
+    convert_wait_end(sm);
+}
+
+void sim_get_capture_stats(sim_capture_stats_t *out)
+{
+    *out = s_capture_stats;
+    out->frames = s_capture_frames;
+    out->core0_busy_ns = s_core0_busy_ns;
+}
+
+// =============================================================================
+// S-DSP I2S source
+// =============================================================================
+
+static uint64_t s_i2s_next_ps;
+static uint64_t s_i2s_frame;
+
+static void i2s_tick(uint64_t now_ps)
+{
+    int channel = -1;
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS && channel < 0; ch++) {
+        uint pio_idx = 0;
+        uint sm = 0;
+        if (s_dma[ch].busy && dreq_source(s_dma[ch].config.dreq, &pio_idx, &sm) &&
+            s_sm[pio_idx][sm].enabled && sm_role(pio_idx, sm) == SIM_SM_ROLE_I2S) {
+            channel = (int)ch;
+        }
+    }
+    if (channel < 0) {
+        s_i2s_next_ps = now_ps + SNES_GEN_I2S_FRAME_PS;
+        return;
+    }
+
+    sim_dma_t *d = &s_dma[channel];
+    while (s_i2s_next_ps <= now_ps && d->busy) {
+        // The PIO pushes the right channel word first, then the left.
+        dma_write_word(d, snes_gen_i2s_word(s_i2s_frame, false));
+        dma_write_word(d, snes_gen_i2s_word(s_i2s_frame, true));
+        s_i2s_frame++;
+        s_i2s_next_ps += SNES_GEN_I2S_FRAME_PS;
+    }
+    dma_sync_registers((uint)channel);
+}
+
+// =============================================================================
+// Init
+// =============================================================================
+
+void sim_hal_init(void)
+{
+    memset(sim_flash_image, 0xFF, sizeof(sim_flash_image));
+    memset(&sim_watchdog_hw, 0, sizeof(sim_watchdog_hw));
+}
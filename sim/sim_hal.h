@@ -0,0 +1,41 @@
+/**
+ * Host simulation - HAL internals shared by the sim modules
+ *
+ * Two host threads stand in for the RP2350 cores. Each core owns a virtual
+ * clock; exactly one thread runs at a time (the one that is furthest behind,
+ * core 0 on ties), so a run is deterministic and independent of host load.
+ * Code only yields at shim calls that consume time (polling, DMA waits,
+ * sleeps, and the scanout engine's per-line step).
+ */
+
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    uint64_t lines_captured;
+    uint64_t capture_overruns;  // DMA re-armed after the PIO FIFO would have stalled
+    uint64_t convert_lines;     // Core 0 inter-wait intervals measured
+    uint64_t convert_ns_total;  // host ns Core 0 spent between line DMA waits
+    uint64_t convert_ns_max;
+    uint64_t frames;            // top-of-frame IRQs the capture SM raised (or releases)
+    uint64_t core0_busy_ns;     // host ns Core 0 ran between waits (VBLANK polls, DMA) since the first
+} sim_capture_stats_t;
+
+void sim_hal_init(void);
+
+unsigned sim_core_num(void);
+uint64_t sim_now_ps(void);
+void sim_advance_ps(uint64_t ps);
+void sim_advance_to_ps(uint64_t t_ps);
+
+uint64_t sim_host_ns(void);
+
+void sim_get_capture_stats(sim_capture_stats_t *out);
+
+// Implemented by the host_sim driver: ends the run (prints the report).
+void host_sim_finish(const char *reason);
+
+#endif // SIM_HAL_H
@@ -0,0 +1,234 @@
+/**
+ * Host simulation - pico_hdmi RT backend stand-in
+ *
+ * Walks the active mode's line timing on Core 1's virtual clock. Each output
+ * line: vsync callback at the top of the frame, scanline callback for active
+ * lines, one background task slice, and data-island consumption at the HDMI
+ * audio packet rate (48 kHz / 4 samples per packet).
+ *
+ * The frame's vertical total is read from the mode at its top, before the
+ * vsync callback, so a total the callback writes (the genlock's) applies
+ * from the next frame. The vertical blank, which leads each frame, takes up
+ * the difference.
+ */
+
+#include "sim_hdmi.h"
+
+#include "pico_hdmi/hstx_data_island_queue.h"
+#include "pico_hdmi/hstx_packet.h"
+#include "pico_hdmi/video_output_rt.h"
+
+#include "sim_hal.h"
+
+#include <string.h>
+
+#define SIM_HDMI_AUDIO_PACKETS_PER_SEC 12000ULL
+#define SIM_HDMI_MAX_LINE_WORDS 640U // 1280-px 240p/720p
+
+// =============================================================================
+// Modes (timings match pico_hdmi)
+// =============================================================================
+
+const video_mode_t video_mode_480_p = {
+    .h_active_pixels = 640,
+    .v_active_lines = 480,
+    .h_total_pixels = 800,
+    .v_total_lines = 525,
+    .pixel_clock_hz = 25200000,
+    .name = "480p",
+};
+
+const video_mode_t video_mode_240_p = {
+    .h_active_pixels = 1280,
+    .v_active_lines = 240,
+    .h_total_pixels = 1600,
+    .v_total_lines = 262,
+    .pixel_clock_hz = 25200000,
+    .name = "240p",
+};
+
+const video_mode_t video_mode_720_p = {
+    .h_active_pixels = 1280,
+    .v_active_lines = 720,
+    .h_total_pixels = 1650,
+    .v_total_lines = 750,
+    .pixel_clock_hz = 74250000,
+    .name = "720p",
+};
+
+const video_mode_t *video_output_active_mode = &video_mode_480_p;
+volatile uint32_t video_frame_count = 0;
+
+static video_output_scanline_cb_t s_scanline_cb;
+static video_output_vsync_cb_t s_vsync_cb;
+static video_output_task_fn s_background_task;
+static sim_hdmi_line_observer_t s_line_observer;
+static sim_hdmi_frame_observer_t s_frame_observer;
+static sim_hdmi_stats_t s_stats;
+static uint32_t s_line_buffer[SIM_HDMI_MAX_LINE_WORDS];
+
+void video_output_set_mode(const video_mode_t *mode)
+{
+    video_output_active_mode = mode;
+}
+
+void video_output_init(uint32_t frame_width, uint32_t frame_height)
+{
+    (void)frame_width;
+    (void)frame_height;
+    video_frame_count = 0;
+}
+
+void video_output_set_scanline_callback(video_output_scanline_cb_t cb)
+{
+    s_scanline_cb = cb;
+}
+
+void video_output_set_vsync_callback(video_output_vsync_cb_t cb)
+{
+    s_vsync_cb = cb;
+}
+
+void video_output_set_background_task(video_output_task_fn task)
+{
+    s_background_task = task;
+}
+
+void sim_hdmi_set_observers(sim_hdmi_line_observer_t line_observer, sim_hdmi_frame_observer_t frame_observer)
+{
+    s_line_observer = line_observer;
+    s_frame_observer = frame_observer;
+}
+
+void sim_hdmi_get_stats(sim_hdmi_stats_t *out)
+{
+    *out = s_stats;
+}
+
+// =============================================================================
+// Data-island queue
+// =============================================================================
+
+static hstx_data_island_t s_di_queue[HSTX_DI_QUEUE_SIZE];
+static volatile uint32_t s_di_head;
+static volatile uint32_t s_di_tail;
+
+void hstx_di_queue_init(void)
+{
+    s_di_head = 0;
+    s_di_tail = 0;
+}
+
+bool hstx_di_queue_push(const hstx_data_island_t *island)
+{
+    if ((s_di_head - s_di_tail) >= HSTX_DI_QUEUE_SIZE) {
+        return false;
+    }
+    s_di_queue[s_di_head % HSTX_DI_QUEUE_SIZE] = *island;
+    s_di_head++;
+    return true;
+}
+
+uint32_t hstx_di_queue_get_level(void)
+{
+    return s_di_head - s_di_tail;
+}
+
+bool hstx_di_queue_get_hsync_active(void)
+{
+    return false;
+}
+
+int hstx_packet_set_audio_samples(hstx_packet_t *packet, const audio_sample_t *samples, int count, int frame_counter)
+{
+    memset(packet, 0, sizeof(*packet));
+    packet->header[0] = 0x02; // audio sample packet
+    for (int i = 0; i < count && i < 4; i++) {
+        memcpy(packet->subpacket[i], &samples[i], sizeof(samples[i]));
+    }
+    packet->audio_sample_count = (uint8_t)count;
+    return (frame_counter + count) % 192;
+}
+
+void hstx_encode_data_island(hstx_data_island_t *island, const hstx_packet_t *packet, bool vsync, bool hsync)
+{
+    island->packet = *packet;
+    island->vsync = vsync;
+    island->hsync = hsync;
+}
+
+// =============================================================================
+// Scanout
+// =============================================================================
+
+static uint64_t line_start_ps(const video_mode_t *mode, uint64_t line)
+{
+    // h_total * 1e12 / pclk, kept in range by dividing pclk down to kHz.
+    return (line * mode->h_total_pixels * 1000000000ULL) / (mode->pixel_clock_hz / 1000U);
+}
+
+static void drain_data_islands(uint64_t elapsed_ps)
+{
+    const uint64_t due = (elapsed_ps * SIM_HDMI_AUDIO_PACKETS_PER_SEC) / 1000000000000ULL;
+    while (s_stats.di_packets_sent + s_stats.di_underruns < due) {
+        if (s_di_head != s_di_tail) {
+            s_di_tail++;
+            s_stats.di_packets_sent++;
+        } else {
+            s_stats.di_underruns++;
+        }
+    }
+}
+
+void video_output_core1_run(void)
+{
+    const video_mode_t *mode = video_output_active_mode;
+    const uint32_t h_words = mode->h_active_pixels / 2U;
+    const uint64_t start_ps = sim_now_ps();
+    uint64_t line = 0;
+    uint32_t v = 0;
+    uint32_t v_total = 0;
+    uint32_t v_blank = 0;
+
+    while (true) {
+        if (v == 0U) {
+            v_total = mode->v_total_lines;
+            v_blank = v_total - mode->v_active_lines;
+            video_frame_count++;
+            s_stats.frames++;
+            if (s_vsync_cb) {
+                s_vsync_cb();
+            }
+            if (s_frame_observer) {
+                s_frame_observer(video_frame_count);
+            }
+        }
+
+        if (v >= v_blank && s_scanline_cb) {
+            const uint32_t active_line = v - v_blank;
+            const uint64_t t0 = sim_host_ns();
+            s_scanline_cb(v, active_line, s_line_buffer);
+            const uint64_t ns = sim_host_ns() - t0;
+            s_stats.active_lines++;
+            s_stats.scanline_ns_total += ns;
+            if (ns > s_stats.scanline_ns_max) {
+                s_stats.scanline_ns_max = ns;
+            }
+            if (s_line_observer) {
+                s_line_observer(video_frame_count, active_line, s_line_buffer, h_words);
+            }
+        }
+
+        if (s_background_task) {
+            s_background_task();
+        }
+
+        line++;
+        if (++v == v_total) {
+            v = 0;
+        }
+        const uint64_t next_ps = start_ps + line_start_ps(mode, line);
+        drain_data_islands(next_ps - start_ps);
+        sim_advance_to_ps(next_ps);
+    }
+}
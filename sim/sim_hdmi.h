@@ -0,0 +1,31 @@
+/**
+ * Host simulation - HDMI scanout engine internals
+ *
+ * The firmware sees the pico_hdmi RT API (pico_hdmi/video_output_rt.h);
+ * the driver uses these hooks to observe every output line and frame.
+ */
+
+#ifndef SIM_HDMI_H
+#define SIM_HDMI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    uint64_t frames;
+    uint64_t active_lines;
+    uint64_t scanline_ns_total; // host ns spent in the firmware scanline callback
+    uint64_t scanline_ns_max;
+    uint64_t di_packets_sent;   // audio data islands consumed by the link
+    uint64_t di_underruns;      // packet slots that found the queue empty
+} sim_hdmi_stats_t;
+
+// Called after the scanline callback for every active output line.
+typedef void (*sim_hdmi_line_observer_t)(uint32_t frame, uint32_t active_line, const uint32_t *line, uint32_t words);
+// Called at the start of every output frame (after the vsync callback).
+typedef void (*sim_hdmi_frame_observer_t)(uint32_t frame);
+
+void sim_hdmi_set_observers(sim_hdmi_line_observer_t line_observer, sim_hdmi_frame_observer_t frame_observer);
+void sim_hdmi_get_stats(sim_hdmi_stats_t *out);
+
+#endif // SIM_HDMI_H
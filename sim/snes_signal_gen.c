@@ -0,0 +1,524 @@
+/**
+ * Host simulation - synthetic SNES signal generator
+ */
+
+#include "snes_signal_gen.h"
+
+#include "snes_pins.h"
+#include "snes_timing.h"
+
+#include <math.h>
+
+static uint64_t s_origin_ps;
+static bool s_interlace;
+static bool s_pal;
+static bool s_brightness_applied = true;
+static uint32_t s_v_total = SNES_V_TOTAL;
+static uint32_t s_v_total_long = SNES_V_TOTAL_INTERLACE;
+static uint32_t s_v_active = SNES_V_ACTIVE;
+static uint64_t s_dot_ps = SNES_GEN_DOT_PS;
+static bool s_overscan_switch;
+static uint64_t s_dropout_start_ps = UINT64_MAX;
+static uint64_t s_dropout_ps;
+static uint32_t s_first_dot = SNES_GEN_FIRST_PIXEL_DOT;
+static uint64_t s_skew_ps;
+static uint32_t s_sample_skip = SNES_GEN_FIRST_PIXEL_DOT;
+static uint64_t s_sample_ps = (SNES_GEN_EYE_OPEN_PS + SNES_GEN_EYE_CLOSE_PS) / 2U;
+static uint32_t s_noise = 0x2545F491U;
+
+void snes_gen_init(uint64_t origin_ps)
+{
+    s_origin_ps = origin_ps;
+}
+
+void snes_gen_set_dropout(uint64_t start_ps, uint64_t length_ps)
+{
+    s_dropout_start_ps = start_ps;
+    s_dropout_ps = length_ps;
+}
+
+// During a dropout the console's clocks stop and every pin holds its level;
+// afterwards the raster carries on where it stopped. The raster runs on
+// console time, which is simulated time less any outage already passed.
+static uint64_t console_ps(uint64_t t_ps)
+{
+    if (t_ps < s_dropout_start_ps) {
+        return t_ps;
+    }
+    if (t_ps - s_dropout_start_ps < s_dropout_ps) {
+        return s_dropout_start_ps;
+    }
+    return t_ps - s_dropout_ps;
+}
+
+void snes_gen_set_bus(uint32_t first_dot, uint64_t skew_ps)
+{
+    s_first_dot = first_dot;
+    s_skew_ps = skew_ps;
+}
+
+void snes_gen_set_sample_point(uint32_t skip, uint64_t sample_ps)
+{
+    s_sample_skip = skip;
+    s_sample_ps = sample_ps;
+}
+
+// xorshift32: deterministic bus noise, so failing runs reproduce.
+static uint32_t noise_next(void)
+{
+    s_noise ^= s_noise << 13;
+    s_noise ^= s_noise >> 17;
+    s_noise ^= s_noise << 5;
+    return s_noise;
+}
+
+static uint64_t sim_ps(uint64_t console_t_ps)
+{
+    return (console_t_ps < s_dropout_start_ps) ? console_t_ps : console_t_ps + s_dropout_ps;
+}
+
+void snes_gen_set_pal(bool pal)
+{
+    s_pal = pal;
+    s_v_total = pal ? SNES_V_TOTAL_PAL : SNES_V_TOTAL;
+    s_v_total_long = pal ? SNES_V_TOTAL_PAL_INTERLACE : SNES_V_TOTAL_INTERLACE;
+    s_v_active = pal ? SNES_V_ACTIVE_PAL : SNES_V_ACTIVE;
+    s_dot_ps = pal ? SNES_GEN_DOT_PAL_PS : SNES_GEN_DOT_PS;
+}
+
+bool snes_gen_pal(void)
+{
+    return s_pal;
+}
+
+uint32_t snes_gen_active_lines(void)
+{
+    return s_v_active;
+}
+
+uint64_t snes_gen_dot_ps(void)
+{
+    return s_dot_ps;
+}
+
+void snes_gen_set_overscan_switch(bool on)
+{
+    s_overscan_switch = on;
+}
+
+uint32_t snes_gen_frame_active_lines(uint32_t frame)
+{
+    if (!s_overscan_switch || ((frame / SNES_GEN_OVERSCAN_PERIOD) & 1U) == 0U) {
+        return s_v_active;
+    }
+    return (s_v_active == SNES_V_ACTIVE) ? SNES_V_ACTIVE_OVERSCAN : SNES_V_ACTIVE;
+}
+
+void snes_gen_set_brightness_applied(bool applied)
+{
+    s_brightness_applied = applied;
+}
+
+void snes_gen_set_interlace(bool interlace)
+{
+    s_interlace = interlace;
+}
+
+bool snes_gen_interlaced(void)
+{
+    return s_interlace;
+}
+
+// Frame (field) layout. Progressive frames are all s_v_total lines;
+// interlaced ones alternate s_v_total_long and s_v_total.
+#define SNES_GEN_FIELD_PAIR_LINES (s_v_total_long + s_v_total)
+
+static uint32_t frame_lines(uint32_t frame)
+{
+    return (s_interlace && (frame & 1U) == 0U) ? s_v_total_long : s_v_total;
+}
+
+static uint64_t frame_start_line(uint32_t frame)
+{
+    if (!s_interlace) {
+        return (uint64_t)frame * s_v_total;
+    }
+    return ((uint64_t)(frame >> 1) * SNES_GEN_FIELD_PAIR_LINES) + ((frame & 1U) ? s_v_total_long : 0U);
+}
+
+static void locate_line(uint64_t abs_line, uint32_t *frame, uint32_t *line)
+{
+    if (!s_interlace) {
+        *frame = (uint32_t)(abs_line / s_v_total);
+        *line = (uint32_t)(abs_line % s_v_total);
+        return;
+    }
+    const uint32_t rem = (uint32_t)(abs_line % SNES_GEN_FIELD_PAIR_LINES);
+    const uint32_t odd = (rem >= s_v_total_long) ? 1U : 0U;
+    *frame = (uint32_t)((abs_line / SNES_GEN_FIELD_PAIR_LINES) * 2U) + odd;
+    *line = odd ? rem - s_v_total_long : rem;
+}
+
+uint64_t snes_gen_line_ps(void)
+{
+    return s_dot_ps * SNES_H_TOTAL;
+}
+
+static uint64_t line_start_console_ps(uint64_t abs_line)
+{
+    return s_origin_ps + (abs_line * snes_gen_line_ps());
+}
+
+uint64_t snes_gen_first_line_after(uint64_t t_ps)
+{
+    const uint64_t console_t_ps = console_ps(t_ps);
+    if (console_t_ps < s_origin_ps) {
+        return 0;
+    }
+    return ((console_t_ps - s_origin_ps) / snes_gen_line_ps()) + 1U;
+}
+
+uint64_t snes_gen_line_start_ps(uint64_t abs_line)
+{
+    return sim_ps(line_start_console_ps(abs_line));
+}
+
+static inline uint32_t reverse_5bit(uint32_t x)
+{
+    return ((x & 1U) << 4) | ((x & 2U) << 2) | (x & 4U) | ((x & 8U) >> 2) | ((x & 16U) >> 4);
+}
+
+snes_gen_rgb_t snes_gen_pixel(uint32_t frame, uint32_t line, uint32_t x)
+{
+    const uint32_t il_line = s_interlace ? ((line * 2U) + (frame & 1U)) : line;
+    snes_gen_rgb_t px = {
+        .r5 = (uint8_t)(il_line & 31U),
+        .g5 = (uint8_t)(frame & 31U),
+        .b5 = (uint8_t)((x >> 3) & 31U),
+    };
+    return px;
+}
+
+bool snes_gen_line_is_hires(uint32_t line)
+{
+    return line < SNES_V_ACTIVE_OVERSCAN && (line % SNES_GEN_HIRES_PERIOD) == SNES_GEN_HIRES_PHASE;
+}
+
+snes_gen_rgb_t snes_gen_pixel_hires(uint32_t frame, uint32_t line, uint32_t x2)
+{
+    snes_gen_rgb_t px = snes_gen_pixel(frame, line, x2 >> 1);
+    if ((x2 & 1U) && snes_gen_line_is_hires(line)) {
+        px.b5 ^= 31U;
+    }
+    return px;
+}
+
+uint8_t snes_gen_brightness(uint32_t frame, uint32_t line)
+{
+    const uint32_t active = snes_gen_frame_active_lines(frame);
+    if (line < active - SNES_GEN_FADE_LINES || line >= active) {
+        return SNES_BRIGHTNESS_MAX;
+    }
+    return (uint8_t)((frame + line) & SNES_BRIGHTNESS_MAX);
+}
+
+bool snes_gen_pixel_valid(uint32_t line, uint32_t x)
+{
+    return (line & 7U) != 3U || x < SNES_GEN_HOLE_X || x >= SNES_GEN_HOLE_X + SNES_GEN_HOLE_W;
+}
+
+uint16_t snes_gen_expected_rgb565(uint32_t frame, uint32_t line, uint32_t x)
+{
+    return snes_gen_expected_hires_rgb565(frame, line, x * 2U);
+}
+
+uint16_t snes_gen_average_rgb565(uint16_t a, uint16_t b)
+{
+    const uint32_t r5 = ((a >> 11) + (b >> 11)) / 2U;
+    const uint32_t g6 = (((a >> 5) & 0x3FU) + ((b >> 5) & 0x3FU)) / 2U;
+    const uint32_t b5 = ((a & 0x1FU) + (b & 0x1FU)) / 2U;
+    return (uint16_t)((r5 << 11) | (g6 << 5) | b5);
+}
+
+uint16_t snes_gen_expected_hires_rgb565(uint32_t frame, uint32_t line, uint32_t x2)
+{
+    if (!snes_gen_pixel_valid(line, x2 >> 1)) {
+        return 0;
+    }
+    const snes_gen_rgb_t px = snes_gen_pixel_hires(frame, line, x2);
+    const uint32_t level = s_brightness_applied ? snes_gen_brightness(frame, line) : SNES_BRIGHTNESS_MAX;
+    const uint32_t r5 = (px.r5 * level) / SNES_BRIGHTNESS_MAX;
+    const uint32_t g5 = (px.g5 * level) / SNES_BRIGHTNESS_MAX;
+    const uint32_t b5 = (px.b5 * level) / SNES_BRIGHTNESS_MAX;
+    return (uint16_t)((r5 << 11) | (g5 << 6) | ((g5 >> 4) << 5) | b5);
+}
+
+// Position of console time t within the raster. Before power-on the console is
+// held in VBLANK with no clocks.
+typedef struct {
+    bool powered;
+    uint64_t abs_line;
+    uint32_t frame;
+    uint32_t line;
+    uint32_t dot;
+    uint64_t dot_phase_ps;
+} raster_pos_t;
+
+static raster_pos_t raster_at(uint64_t t_ps)
+{
+    raster_pos_t pos = {0};
+    if (t_ps < s_origin_ps) {
+        return pos;
+    }
+    const uint64_t rel = t_ps - s_origin_ps;
+    pos.powered = true;
+    pos.abs_line = rel / snes_gen_line_ps();
+    locate_line(pos.abs_line, &pos.frame, &pos.line);
+    const uint64_t in_line = rel % snes_gen_line_ps();
+    pos.dot = (uint32_t)(in_line / s_dot_ps);
+    pos.dot_phase_ps = in_line % s_dot_ps;
+    return pos;
+}
+
+static bool vblank_at(const raster_pos_t *pos)
+{
+    if (!pos->powered) {
+        return true;
+    }
+    const uint32_t v = (pos->line * SNES_H_TOTAL) + pos->dot;
+    const uint32_t rise = (snes_gen_frame_active_lines(pos->frame) * SNES_H_TOTAL) + SNES_GEN_VBLANK_EDGE_DOT;
+    const uint32_t fall = ((frame_lines(pos->frame) - 1U) * SNES_H_TOTAL) + SNES_GEN_VBLANK_EDGE_DOT;
+    return v >= rise && v < fall;
+}
+
+static inline bool hblank_at(const raster_pos_t *pos)
+{
+    return !pos->powered || pos->dot >= SNES_GEN_HBLANK_LOW_DOTS;
+}
+
+static snes_gen_rgb_t pixel_at(const raster_pos_t *pos)
+{
+    const snes_gen_rgb_t black = {0, 0, 0};
+    if (!pos->powered || pos->line >= snes_gen_frame_active_lines(pos->frame) || pos->dot < SNES_GEN_FIRST_PIXEL_DOT ||
+        pos->dot >= SNES_GEN_FIRST_PIXEL_DOT + SNES_H_ACTIVE) {
+        return black;
+    }
+    // Second half of the dot (PCLK low) shows the hires sub-pixel.
+    const uint32_t half = (pos->dot_phase_ps >= (s_dot_ps / 2U)) ? 1U : 0U;
+    return snes_gen_pixel_hires(pos->frame, pos->line,
+                                ((pos->dot - SNES_GEN_FIRST_PIXEL_DOT) * 2U) + half);
+}
+
+bool snes_gen_is_video_pin(unsigned pin)
+{
+    return pin >= PIN_SNES_BASE && pin <= SNES_CAPTURE_PIN_LAST;
+}
+
+bool snes_gen_drives_pin(unsigned pin)
+{
+    return snes_gen_is_video_pin(pin) || (pin >= PIN_SNES_BRIGHT0 && pin <= PIN_SNES_BRIGHT3);
+}
+
+// $2100 latch output: the current line's level until HBLANK rises, then the
+// level HDMA writes for the next line.
+static uint8_t brightness_at(const raster_pos_t *pos)
+{
+    if (!pos->powered) {
+        return SNES_BRIGHTNESS_MAX;
+    }
+    uint64_t abs_line = pos->abs_line;
+    if (pos->dot >= SNES_GEN_HBLANK_LOW_DOTS) {
+        abs_line++;
+    }
+    uint32_t frame = 0;
+    uint32_t line = 0;
+    locate_line(abs_line, &frame, &line);
+    return snes_gen_brightness(frame, line);
+}
+
+bool snes_gen_pin(unsigned pin, uint64_t t_ps)
+{
+    const raster_pos_t pos = raster_at(console_ps(t_ps));
+    const snes_gen_rgb_t px = pixel_at(&pos);
+
+    if (pin >= PIN_SNES_BRIGHT0 && pin <= PIN_SNES_BRIGHT3) {
+        return (brightness_at(&pos) >> (pin - PIN_SNES_BRIGHT0)) & 1U;
+    }
+
+    switch (pin) {
+        case PIN_SNES_VBLANK:
+            return vblank_at(&pos);
+        case PIN_SNES_HBLANK:
+            return hblank_at(&pos);
+        case PIN_SNES_PCLK:
+            return pos.powered && pos.dot_phase_ps < (s_dot_ps / 2U);
+        case PIN_SNES_PIXEL_VALID:
+            return pos.powered && pos.line < snes_gen_frame_active_lines(pos.frame) && pos.dot >= SNES_GEN_FIRST_PIXEL_DOT &&
+                   pos.dot < SNES_GEN_FIRST_PIXEL_DOT + SNES_H_ACTIVE &&
+                   snes_gen_pixel_valid(pos.line, pos.dot - SNES_GEN_FIRST_PIXEL_DOT);
+        default:
+            break;
+    }
+    if (pin >= PIN_SNES_B4 && pin <= PIN_SNES_B0) {
+        return (px.b5 >> (4U - (pin - PIN_SNES_B4))) & 1U;
+    }
+    if (pin >= PIN_SNES_G4 && pin <= PIN_SNES_G0) {
+        return (px.g5 >> (4U - (pin - PIN_SNES_G4))) & 1U;
+    }
+    if (pin >= PIN_SNES_R4 && pin <= PIN_SNES_R0) {
+        return (px.r5 >> (4U - (pin - PIN_SNES_R4))) & 1U;
+    }
+    return true;
+}
+
+static uint64_t next_edge_console_ps(unsigned pin, uint64_t t_ps)
+{
+    if (t_ps < s_origin_ps) {
+        return s_origin_ps;
+    }
+    const raster_pos_t pos = raster_at(t_ps);
+    const uint64_t line_start = line_start_console_ps(pos.abs_line);
+
+    if (pin == PIN_SNES_PCLK) {
+        const uint64_t dot_start = line_start + ((uint64_t)pos.dot * s_dot_ps);
+        const uint64_t half = dot_start + (s_dot_ps / 2U);
+        return (t_ps < half) ? half : dot_start + s_dot_ps;
+    }
+    if (pin == PIN_SNES_HBLANK) {
+        const uint64_t rise = line_start + ((uint64_t)SNES_GEN_HBLANK_LOW_DOTS * s_dot_ps);
+        return (t_ps < rise) ? rise : line_start + snes_gen_line_ps();
+    }
+    if (pin == PIN_SNES_VBLANK) {
+        const uint64_t start = frame_start_line(pos.frame);
+        const uint64_t next_start = frame_start_line(pos.frame + 1U);
+        const uint64_t edge_dot = SNES_GEN_VBLANK_EDGE_DOT * s_dot_ps;
+        const uint64_t rise = line_start_console_ps(start + snes_gen_frame_active_lines(pos.frame)) + edge_dot;
+        const uint64_t fall = line_start_console_ps(next_start - 1U) + edge_dot;
+        if (t_ps < rise) {
+            return rise;
+        }
+        if (t_ps < fall) {
+            return fall;
+        }
+        return line_start_console_ps(next_start + snes_gen_frame_active_lines(pos.frame + 1U)) + edge_dot;
+    }
+    // Colour pins change at most twice per dot (hires sub-pixel).
+    const uint64_t dot_start = line_start + ((uint64_t)pos.dot * s_dot_ps);
+    const uint64_t half = dot_start + (s_dot_ps / 2U);
+    return (t_ps < half) ? half : dot_start + s_dot_ps;
+}
+
+uint64_t snes_gen_next_edge_ps(unsigned pin, uint64_t t_ps)
+{
+    return sim_ps(next_edge_console_ps(pin, console_ps(t_ps)));
+}
+
+uint32_t snes_gen_capture_samples_per_dot(uint32_t count)
+{
+    return (count > SNES_H_ACTIVE) ? 2U : 1U;
+}
+
+uint64_t snes_gen_capture_done_ps(uint64_t abs_line, uint32_t count)
+{
+    const uint32_t per_dot = snes_gen_capture_samples_per_dot(count);
+    return sim_ps(line_start_console_ps(abs_line) + ((uint64_t)SNES_GEN_FIRST_PIXEL_DOT * s_dot_ps) +
+                  (((uint64_t)count * s_dot_ps) / per_dot));
+}
+
+void snes_gen_fill_capture_words(uint64_t abs_line, uint32_t *dst, uint32_t count)
+{
+    uint32_t frame = 0;
+    uint32_t line = 0;
+    locate_line(abs_line, &frame, &line);
+    const uint32_t active = snes_gen_frame_active_lines(frame);
+    const uint32_t vblank = (line >= active) ? 1U : 0U;
+    const uint32_t per_dot = snes_gen_capture_samples_per_dot(count);
+
+    // Sampling phase: dots off from the first pixel, and whether the sample
+    // lands inside the stable part of each dot.
+    const int32_t shift = (int32_t)s_sample_skip - (int32_t)s_first_dot;
+    const bool in_eye = (s_sample_ps >= SNES_GEN_EYE_OPEN_PS + s_skew_ps) &&
+                        (s_sample_ps <= SNES_GEN_EYE_CLOSE_PS + s_skew_ps);
+
+    for (uint32_t i = 0; i < count; i++) {
+        const int32_t xs = (int32_t)(i / per_dot) + shift;
+        const uint32_t sub = i % per_dot;
+        const uint32_t pclk = (sub == 0U) ? (1U << 1) : 0U;
+        if (line < active && (xs < 0 || xs >= (int32_t)SNES_H_ACTIVE)) {
+            // Border dots: the TST pins float with PIXEL_VALID still high.
+            dst[i] = pclk | ((noise_next() & 0x7FFFU) << 2) | (1U << 18);
+            continue;
+        }
+        const uint32_t x = (uint32_t)xs;
+        if (line >= active || x >= SNES_H_ACTIVE || !snes_gen_pixel_valid(line, x)) {
+            dst[i] = 0; // PIXEL_VALID low: `in null`
+            continue;
+        }
+        const snes_gen_rgb_t px = snes_gen_pixel_hires(frame, line, (x * 2U) + sub);
+        // Bit layout per snes_pins.h: VBLANK, PCLK (high for the main
+        // sample, low for the hires sub-sample), B4..B0, G4..G0, R4..R0 (MSB
+        // wired to the lower GPIO), HBLANK, PIXEL_VALID.
+        dst[i] = vblank | pclk | (reverse_5bit(px.b5) << 2) |
+                 (reverse_5bit(px.g5) << 7) | (reverse_5bit(px.r5) << 12) | (1U << 18);
+        if (!in_eye) {
+            // Sampled while the colour lines settle: some bits read wrong.
+            dst[i] ^= ((noise_next() & noise_next()) & 0x7FFFU) << 2;
+        }
+    }
+}
+
+// VBLANK falls at dot SNES_GEN_VBLANK_EDGE_DOT of the line before each frame;
+// frame 0 starts at power-on, when the held-high VBLANK drops. Console time.
+static uint64_t vblank_fall_ps(uint32_t frame)
+{
+    if (frame == 0U) {
+        return s_origin_ps;
+    }
+    return line_start_console_ps(frame_start_line(frame) - 1U) + ((uint64_t)SNES_GEN_VBLANK_EDGE_DOT * s_dot_ps);
+}
+
+uint64_t snes_gen_line_count_push_ps(uint64_t after_ps, uint32_t *count)
+{
+    const uint64_t after_console_ps = console_ps(after_ps);
+    const raster_pos_t pos = raster_at(after_console_ps);
+    uint32_t frame = pos.frame;
+    while (vblank_fall_ps(frame) <= after_console_ps) {
+        frame++;
+    }
+    // Line starts 0..active see VBLANK low (it rises inside line `active`).
+    const uint32_t active = snes_gen_frame_active_lines(frame);
+    *count = active + 1U;
+    return snes_gen_line_start_ps(frame_start_line(frame) + active + 1U);
+}
+
+uint64_t snes_gen_frame_top_ps(uint64_t after_ps, uint64_t *first_line)
+{
+    const uint64_t after_console_ps = console_ps(after_ps);
+    const raster_pos_t pos = raster_at(after_console_ps);
+    uint32_t frame = pos.frame;
+    while (vblank_fall_ps(frame) <= after_console_ps) {
+        frame++;
+    }
+    *first_line = frame_start_line(frame);
+    return sim_ps(vblank_fall_ps(frame));
+}
+
+uint64_t snes_gen_capture_line_after(uint64_t abs_line)
+{
+    uint32_t frame = 0;
+    uint32_t line = 0;
+    locate_line(abs_line, &frame, &line);
+    // Lines 0..active start with VBLANK low; the SM stops after the last.
+    if (line < snes_gen_frame_active_lines(frame)) {
+        return abs_line + 1U;
+    }
+    return frame_start_line(frame + 1U);
+}
+
+uint32_t snes_gen_i2s_word(uint64_t frame_idx, bool left)
+{
+    const double t = (double)frame_idx / (double)SNES_GEN_I2S_RATE_HZ;
+    const double hz = left ? 440.0 : 660.0;
+    const int16_t sample = (int16_t)lrint(8000.0 * sin(2.0 * M_PI * hz * t));
+    return (uint32_t)(uint16_t)sample;
+}
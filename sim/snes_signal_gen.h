@@ -0,0 +1,161 @@
+/**
+ * Host simulation - synthetic SNES signal generator
+ *
+ * Models the PPU2 digital video taps (RGB555 on the TST pins plus HBLANK,
+ * VBLANK and PCLK) at real NTSC or PAL dot timing, and the S-DSP serial
+ * audio stream at ~32.04 kHz. All times are in picoseconds of simulated time.
+ *
+ * PAL (snes_gen_set_pal) uses the PAL master clock and 312-line frames
+ * (313/312 interlaced), with content on all 239 overscan lines.
+ *
+ * With the overscan switch on, the active height toggles between 224 and 239
+ * lines (starting from the region's default) every SNES_GEN_OVERSCAN_PERIOD
+ * frames, as a game flipping $2133 bit 2 would; VBLANK moves with it. The
+ * period divides 32, so the frame id in g still gives the height.
+ *
+ * Line layout (dots from the HBLANK falling edge that starts the line):
+ *   [0, SNES_GEN_HBLANK_LOW_DOTS)   HBLANK low, active window
+ *   SNES_GEN_FIRST_PIXEL_DOT        first TST pixel (matches the PIO skip)
+ *   [SNES_GEN_HBLANK_LOW_DOTS, 341) HBLANK high
+ * VBLANK rises after the last active line and falls at the end of the frame,
+ * both at dot SNES_GEN_VBLANK_EDGE_DOT (inside HBLANK).
+ *
+ * Test pattern: r = line & 31, g = frame & 31, b = (x >> 3) & 31, so any
+ * output pixel identifies the source line and frame it came from.
+ *
+ * With interlace on, frames are fields of alternating length: even frames
+ * are 263 (PAL 313) lines (field 0), odd frames 262 (PAL 312) (field 1, the
+ * odd lines of 448i),
+ * and r = (2 * line + field) & 31, the line number within the 448i frame.
+ *
+ * Master brightness ($2100, QSB latch on GP8-11) is 15 except for an
+ * HDMA-style fade band over the last SNES_GEN_FADE_LINES active lines, where
+ * it is (frame + line) & 15. The latch updates at the HBLANK rising edge,
+ * i.e. after the line it applies to has been drawn.
+ *
+ * PIXEL_VALID (GP45) drops for a "Mode 7 hole" of SNES_GEN_HOLE_W pixels
+ * centred on x = 128 on every eighth line; snes_hard_sync pushes a zero word
+ * for those pixels.
+ *
+ * Every SNES_GEN_HIRES_PERIOD-th line (offset SNES_GEN_HIRES_PHASE) is hires:
+ * the half-dot after PCLK falls carries a sub-pixel with blue inverted.
+ * Hires pixel positions are x2 = 2 * x (main) and 2 * x + 1 (sub).
+ *
+ * Sampling eye (capture words only): the colour lines settle from
+ * SNES_GEN_EYE_OPEN_PS to SNES_GEN_EYE_CLOSE_PS after each PCLK edge, both
+ * moved by the bus skew. A sample point outside that window flips random
+ * colour bits. The first pixel follows the HBLANK fall by the bus's first dot
+ * (default SNES_GEN_FIRST_PIXEL_DOT); a capture skip off from it shifts the
+ * line, and dots outside the 256 pixels read as noise with PIXEL_VALID high.
+ */
+
+#ifndef SNES_SIGNAL_GEN_H
+#define SNES_SIGNAL_GEN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SNES_GEN_PS_PER_SEC      1000000000000ULL
+#define SNES_GEN_MASTER_CLOCK_HZ 21477272ULL // NTSC master clock
+#define SNES_GEN_DOT_PS          ((4ULL * SNES_GEN_PS_PER_SEC) / SNES_GEN_MASTER_CLOCK_HZ)
+#define SNES_GEN_MASTER_CLOCK_PAL_HZ 21281370ULL
+#define SNES_GEN_DOT_PAL_PS      ((4ULL * SNES_GEN_PS_PER_SEC) / SNES_GEN_MASTER_CLOCK_PAL_HZ)
+
+#define SNES_GEN_HBLANK_LOW_DOTS 280U
+#define SNES_GEN_FIRST_PIXEL_DOT 20U
+#define SNES_GEN_VBLANK_EDGE_DOT 300U
+#define SNES_GEN_EYE_OPEN_PS     8000ULL
+#define SNES_GEN_EYE_CLOSE_PS    60000ULL
+
+#define SNES_GEN_FADE_LINES 24U
+#define SNES_GEN_HOLE_X     120U
+#define SNES_GEN_HOLE_W     16U
+#define SNES_GEN_HIRES_PERIOD 16U
+#define SNES_GEN_HIRES_PHASE  5U
+#define SNES_GEN_OVERSCAN_PERIOD 16U
+
+#define SNES_GEN_I2S_RATE_HZ 32040U
+#define SNES_GEN_I2S_FRAME_PS (SNES_GEN_PS_PER_SEC / SNES_GEN_I2S_RATE_HZ)
+
+typedef struct {
+    uint8_t r5;
+    uint8_t g5;
+    uint8_t b5;
+} snes_gen_rgb_t;
+
+// Console power-on offset relative to Pico boot, so capture start is not
+// phase-aligned with the first frame by construction.
+void snes_gen_init(uint64_t origin_ps);
+// Console freeze from start_ps for length_ps (reset, cart swap, a loose
+// cable): PCLK, HBLANK and VBLANK stop where they are, then the raster
+// resumes from the same point. All other times stay in simulated time.
+void snes_gen_set_dropout(uint64_t start_ps, uint64_t length_ps);
+// Whether the expected colours scale by master brightness (the firmware's
+// ENABLE_BRIGHTNESS); the generator drives the QSB lines either way.
+void snes_gen_set_brightness_applied(bool applied);
+void snes_gen_set_interlace(bool interlace);
+bool snes_gen_interlaced(void);
+void snes_gen_set_pal(bool pal);
+bool snes_gen_pal(void);
+// Lines carrying picture per frame: 224 NTSC, 239 PAL.
+uint32_t snes_gen_active_lines(void);
+uint64_t snes_gen_dot_ps(void);
+void snes_gen_set_overscan_switch(bool on);
+// Active lines of one frame: snes_gen_active_lines(), or the other height on
+// switched frames.
+uint32_t snes_gen_frame_active_lines(uint32_t frame);
+
+uint64_t snes_gen_line_ps(void);
+uint64_t snes_gen_line_start_ps(uint64_t abs_line);
+// First absolute line whose HBLANK falling edge is strictly after t_ps.
+uint64_t snes_gen_first_line_after(uint64_t t_ps);
+
+bool snes_gen_is_video_pin(unsigned pin);
+// Video capture pins plus the QSB side-band lines (brightness).
+bool snes_gen_drives_pin(unsigned pin);
+bool snes_gen_pin(unsigned pin, uint64_t t_ps);
+// Next time (> t_ps) at which the given pin changes level.
+uint64_t snes_gen_next_edge_ps(unsigned pin, uint64_t t_ps);
+
+snes_gen_rgb_t snes_gen_pixel(uint32_t frame, uint32_t line, uint32_t x);
+bool snes_gen_line_is_hires(uint32_t line);
+snes_gen_rgb_t snes_gen_pixel_hires(uint32_t frame, uint32_t line, uint32_t x2);
+uint8_t snes_gen_brightness(uint32_t frame, uint32_t line);
+bool snes_gen_pixel_valid(uint32_t line, uint32_t x);
+// Output colour after master brightness, as the firmware should produce it.
+uint16_t snes_gen_expected_rgb565(uint32_t frame, uint32_t line, uint32_t x);
+uint16_t snes_gen_expected_hires_rgb565(uint32_t frame, uint32_t line, uint32_t x2);
+// Per-channel floor average of two RGB565 pixels (hires pair -> 240p).
+uint16_t snes_gen_average_rgb565(uint16_t a, uint16_t b);
+
+// Raw capture words for `count` transfers: one per dot for snes_hard_sync,
+// two per dot (PCLK high, then low) when count exceeds SNES_H_ACTIVE, as
+// snes_hard_sync_hires pushes them.
+uint32_t snes_gen_capture_samples_per_dot(uint32_t count);
+// Time the last of `count` capture words for an absolute line is pushed.
+uint64_t snes_gen_capture_done_ps(uint64_t abs_line, uint32_t count);
+void snes_gen_fill_capture_words(uint64_t abs_line, uint32_t *dst, uint32_t count);
+// Bus under test: dot of the first pixel after HBLANK falls, and extra
+// settling time added to both ends of the eye.
+void snes_gen_set_bus(uint32_t first_dot, uint64_t skew_ps);
+// Capture program's phase, as the sim decodes it from PIO instruction
+// memory: dots skipped, and PCLK edge to sample.
+void snes_gen_set_sample_point(uint32_t skip, uint64_t sample_ps);
+
+// snes_line_count model: for the first frame whose VBLANK falls after
+// after_ps, the line count the SM pushes and the time it pushes it (the start
+// of the first line that sees VBLANK high).
+uint64_t snes_gen_line_count_push_ps(uint64_t after_ps, uint32_t *count);
+
+// snes_hard_sync frame sync: the first top of frame (VBLANK falling edge)
+// after after_ps and that frame's first absolute line; and the line the SM
+// captures after abs_line (the next frame's first once it has taken the line
+// VBLANK rises in).
+uint64_t snes_gen_frame_top_ps(uint64_t after_ps, uint64_t *first_line);
+uint64_t snes_gen_capture_line_after(uint64_t abs_line);
+
+// Raw I2S capture word (24-bit frame, sample right-justified) for a stereo
+// frame index and channel.
+uint32_t snes_gen_i2s_word(uint64_t frame_idx, bool left);
+
+#endif // SNES_SIGNAL_GEN_H
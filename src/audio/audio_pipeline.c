@@ -202,6 +202,27 @@ static void audio_flush_processing_state(void)
     last_drift_frame = video_frame_count;
 }
 
+// Unmute with the DI queue topped up with silence to the low drift mark.
+// Muted warmup only keeps pace with the scanout, so the queue can be all but
+// empty here; any output frame a few lines longer than the last (genlock
+// trim, a relock) would then find it dry before the drift check catches up.
+static void audio_start_output(void)
+{
+    audio_flush_processing_state();
+    while (hstx_di_queue_get_level() < DRIFT_QUEUE_LOW) {
+        hstx_packet_t packet;
+        int fc = hstx_packet_set_audio_samples(&packet, audio_silence, 4,
+                                               g_pipeline.audio_frame_counter);
+        hstx_data_island_t island;
+        hstx_encode_data_island(&island, &packet, false, audio_di_hsync_active());
+        if (!hstx_di_queue_push(&island))
+            break;
+        g_pipeline.audio_frame_counter = fc;
+    }
+    g_pipeline.output_muted = false;
+    g_pipeline.state = AUDIO_STATE_RUNNING;
+}
+
 static bool audio_hw_init_once(void)
 {
     if (g_pipeline.hw_initialized)
@@ -303,9 +324,7 @@ void audio_pipeline_process(void)
 #if ENABLE_AUDIO_STARTUP_REARM
                 g_pipeline.state = AUDIO_STATE_REARM;
 #else
-                audio_flush_processing_state();
-                g_pipeline.output_muted = false;
-                g_pipeline.state = AUDIO_STATE_RUNNING;
+                audio_start_output();
 #endif
             }
             break;
@@ -320,9 +339,7 @@ void audio_pipeline_process(void)
         case AUDIO_STATE_REWARM:
             audio_do_process();
             if (video_frame_count - g_pipeline.state_enter_frame >= AUDIO_WARM_FRAMES) {
-                audio_flush_processing_state();
-                g_pipeline.output_muted = false;
-                g_pipeline.state = AUDIO_STATE_RUNNING;
+                audio_start_output();
             }
             break;
 
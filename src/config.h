@@ -6,7 +6,27 @@
 #define ENABLE_OSD 1
 #define ENABLE_SELFTEST 1
 
+// Video capture
+#define ENABLE_BRIGHTNESS 0     // apply $2100 master brightness per line (QSB GP8-11; off until the QSB latch is wired)
+#define ENABLE_HIRES 0          // sample both PCLK edges; keep 512-px hires lines (259KB ring: off until a link confirms it fits)
+#define ENABLE_PACKED_CAPTURE 0 // PIO packs two 15-bit samples per FIFO word (half the DMA traffic; not yet assembled)
+#define ENABLE_INTERLACE 0      // detect 448i fields; weave/bob in 480p/720p (OSD) (259KB ring, as ENABLE_HIRES)
+#define ENABLE_PIO_FRAME_SYNC 0 // capture PIO finds VBLANK itself and IRQs Core 0 out of WFE (not yet run on hardware)
+#define ENABLE_FIELD_PIN 0      // field parity from PPU FIELD on GP20 instead of VBLANK timing
+#define ENABLE_PALMODE_PIN 0    // region from PPU2 PALMODE on GP21 instead of the VBLANK period
+#define ENABLE_CAPTURE_BENCH 0  // print conversion cycle counts at boot, before capture starts
+#define ENABLE_INTERP_CONVERT 0 // full-brightness conversion via the SIO interpolators (see capture bench)
+#define ENABLE_RAW_CAPTURE_RING 0 // DMA streams raw samples into the line ring; Core 1 converts at scanout
+#define LINE_RING_SIZE 256       // line ring depth: power of two, 32-256 (Status RING counts lines lost)
+#define ENABLE_INDEXED_LINES 0   // store lines as 8-bit indices + per-line palette (not with the raw ring)
+
+// Video output
+#define ENABLE_GENLOCK 0         // trim the HDMI vertical total each frame so output frames track the SNES 1:1 (not yet checked against pico_hdmi)
+#define GENLOCK_MAX_TRIM_LINES 4 // most lines the genlock adds to (or takes from) one frame's front porch
+#define LATENCY_RACE_LINES 4     // race-the-beam latency mode: SNES lines from commit to scanout
+
 // OSD behavior
+#define ENABLE_INDEXED_OSD 1 // keep only the OSD text/colour grid and font; expand glyph rows at scanout (no 56 KB framebuffer)
 #define ENABLE_OSD_BOOT_OPEN 0
 #define ENABLE_REBOOT_MODE_SWITCH 1
 #define ENABLE_REBOOT_MODE_SWITCH_720P 1
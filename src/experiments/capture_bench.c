@@ -0,0 +1,364 @@
+#include "capture_bench.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hardware/clocks.h"
+#include "hardware/structs/m33.h"
+#include "pico/stdlib.h"
+#include "pico_hdmi/video_output_rt.h"
+
+#include "config.h"
+#include "osd/fast_osd.h"
+#include "snes_pins.h"
+#include "video/line_ring.h"
+#include "video/snes_timing.h"
+#include "video/video_capture.h"
+#include "video/video_pipeline.h"
+
+#define BENCH_LINES 512U
+#define BENCH_SCANLINE_FRAMES 32U
+#define BENCH_HIRES_EVERY 4U // scanline bench: every fourth source line is hires
+#define BENCH_RING_COLORS 32U // scanline bench: colours per source line
+#define BENCH_MAX_LINE_WORDS 640U // 1280-px modes
+#define BENCH_MAX_LINES 720U
+
+// SNES dot clock is master/4; one line is SNES_H_TOTAL dots.
+#define SNES_LINE_RATE_HZ    ((SNES_MASTER_CLOCK_HZ / 4U) / SNES_H_TOTAL)
+
+typedef struct {
+    const char *name;
+    uint32_t brightness;
+    bool hires;
+} bench_case_t;
+
+static const bench_case_t s_cases[] = {
+    {"full (b=15)", SNES_BRIGHTNESS_MAX, false},
+    {"faded (b=7)", 7U, false},
+    {"black (b=0)", 0U, false},
+    {"hires b=15", SNES_BRIGHTNESS_MAX, true},
+    {"hires b=7", 7U, true},
+};
+
+static const uint32_t s_sysclk_mhz[] = {126U, 252U, 372U};
+
+static uint32_t s_pins[SNES_H_ACTIVE_HIRES];
+static uint32_t s_src[SNES_H_ACTIVE_HIRES] __attribute__((aligned(4)));
+static uint16_t s_dst[SNES_H_ACTIVE_HIRES] __attribute__((aligned(4)));
+
+static inline uint32_t bench_cycles(void)
+{
+    return m33_hw->dwt_cyccnt;
+}
+
+// Random pixels as the pins read them, stored in the capture format. With
+// two samples per dot a lores line repeats each colour (PCLK high, then low);
+// a hires line does not. A nonzero `colors` draws each pixel at random from
+// a set of that many colours (valid pixels), otherwise any pin state goes.
+static void bench_fill_source(bool hires, uint32_t colors)
+{
+    const uint32_t samples = video_capture_line_samples();
+    const uint32_t per_dot = samples / SNES_H_ACTIVE;
+    uint32_t lcg = 0x2100U;
+    for (uint32_t i = 0; i < samples; i++) {
+        if (hires || (i % per_dot) == 0U) {
+            lcg = (lcg * 1664525U) + 1013904223U;
+        }
+        uint32_t pins = (lcg >> 8) & ((1U << SNES_CAPTURE_BITS) - 1U);
+        if (colors) {
+            const uint32_t color = ((((lcg >> 16) % colors) + 1U) * 0x9E3779B1U) >> 17;
+            pins = (color << (PIN_SNES_B4 - PIN_SNES_BASE)) | (1U << (PIN_SNES_PIXEL_VALID - PIN_SNES_BASE));
+        }
+        const uint32_t pclk = ((i % per_dot) == 0U) ? (1U << 1) : 0U;
+        s_pins[i] = (pins & ~(1U << 1)) | pclk;
+    }
+    video_capture_pack_samples(s_src, s_pins, samples);
+}
+
+static uint32_t bench_line_cycles(uint32_t brightness)
+{
+    video_capture_convert_captured_line(s_dst, s_src, brightness); // warm caches
+    const uint32_t start = bench_cycles();
+    for (uint32_t i = 0; i < BENCH_LINES; i++) {
+        video_capture_convert_captured_line(s_dst, s_src, brightness);
+    }
+    return (bench_cycles() - start) / BENCH_LINES;
+}
+
+static const char *const s_kernel_names[VIDEO_CAPTURE_KERNEL_COUNT] = {
+    [VIDEO_CAPTURE_KERNEL_LUT] = "lut",
+    [VIDEO_CAPTURE_KERNEL_INTERP] = "interp",
+    [VIDEO_CAPTURE_KERNEL_RBIT] = "rbit (lean)",
+};
+
+static uint16_t s_ref[SNES_H_ACTIVE] __attribute__((aligned(4)));
+
+// Full-brightness lores line through each kernel; every kernel must match the
+// first one's output (the LUT loop, or the rbit kernel in a lean build).
+static void bench_kernels(void)
+{
+    bench_fill_source(false, 0U);
+    printf("conversion tables: %lu bytes\n", (unsigned long)video_capture_table_bytes());
+    printf("%-14s %10s\n", "kernel", "cyc/line");
+    bool have_ref = false;
+    for (uint32_t k = 0; k < VIDEO_CAPTURE_KERNEL_COUNT; k++) {
+        const video_capture_kernel_t kernel = (video_capture_kernel_t)k;
+        if (!video_capture_kernel_available(kernel)) {
+            continue;
+        }
+        if (!have_ref) {
+            video_capture_convert_line_kernel(s_ref, s_src, SNES_H_ACTIVE, kernel);
+            have_ref = true;
+        }
+        video_capture_convert_line_kernel(s_dst, s_src, SNES_H_ACTIVE, kernel);
+        const bool match = memcmp(s_dst, s_ref, sizeof(s_ref)) == 0;
+        const uint32_t start = bench_cycles();
+        for (uint32_t i = 0; i < BENCH_LINES; i++) {
+            video_capture_convert_line_kernel(s_dst, s_src, SNES_H_ACTIVE, kernel);
+        }
+        const uint32_t cycles = (bench_cycles() - start) / BENCH_LINES;
+        printf("%-14s %10lu   %s%s\n", s_kernel_names[k], (unsigned long)cycles, match ? "ok" : "MISMATCH",
+               (kernel == video_capture_kernel()) ? " (capture loop)" : "");
+    }
+}
+
+static uint32_t s_scanline[BENCH_MAX_LINE_WORDS];
+
+#if ENABLE_OSD && ENABLE_INDEXED_OSD
+// One row of the OSD box as the framebuffer OSD held it, from the text grid.
+static void bench_osd_render_row(uint16_t *dst, uint32_t y)
+{
+    for (uint32_t x = 0; x < OSD_BOX_W; x++) {
+        const uint32_t row = y / 8U;
+        const uint32_t col = x / 8U;
+        const uint8_t bits = fast_osd_font[(uint8_t)fast_osd_text[row][col]][y % 8U];
+        dst[x] = (bits & (0x80U >> (x % 8U))) ? fast_osd_color[row][col] : OSD_COLOR_BG;
+    }
+}
+
+// The OSD box as it stands (the root menu, drawn before the bench) at each
+// scale: glyph rows expanded from the text grid at scanout against the
+// framebuffer OSD's copy, which scales a pre-rendered RGB565 row. Cycles per
+// OSD line over the box; the two must match word for word.
+static void bench_osd_rows(void)
+{
+    static uint16_t row[OSD_BOX_W] __attribute__((aligned(4)));
+    static uint32_t ref[BENCH_MAX_LINE_WORDS];
+    static const char *const scale_names[] = {"2x", "3x", "4x"};
+    printf("%-14s %10s %10s %8s   (osd: indexed, %u bytes)\n", "osd row", "copy cyc", "glyph cyc", "speedup",
+           (unsigned)(sizeof(fast_osd_text) + sizeof(fast_osd_color) + sizeof(fast_osd_font)));
+    for (uint32_t scale = 2U; scale <= 4U; scale++) {
+        const size_t words = ((size_t)OSD_BOX_W * scale) / 2U;
+        uint32_t copy_cycles = 0;
+        uint32_t glyph_cycles = 0;
+        bool match = true;
+        for (uint32_t y = 0; y < OSD_BOX_H; y++) {
+            bench_osd_render_row(row, y);
+            video_pipeline_bench_osd_row(scale, true, ref, y, row); // warm caches
+            uint32_t start = bench_cycles();
+            video_pipeline_bench_osd_row(scale, true, ref, y, row);
+            copy_cycles += bench_cycles() - start;
+            video_pipeline_bench_osd_row(scale, false, s_scanline, y, row);
+            start = bench_cycles();
+            video_pipeline_bench_osd_row(scale, false, s_scanline, y, row);
+            glyph_cycles += bench_cycles() - start;
+            match = match && memcmp(s_scanline, ref, words * sizeof(uint32_t)) == 0;
+        }
+        copy_cycles /= OSD_BOX_H;
+        glyph_cycles /= OSD_BOX_H;
+        const uint32_t percent = glyph_cycles ? (copy_cycles * 100U) / glyph_cycles : 0U;
+        printf("%-14s %10lu %10lu %7lu%%   %s\n", scale_names[scale - 2U], (unsigned long)copy_cycles,
+               (unsigned long)glyph_cycles, (unsigned long)percent, match ? "ok" : "MISMATCH");
+    }
+}
+#endif
+
+static uint32_t s_scanline_min[VIDEO_PIPELINE_BENCH_GENERIC + 1][BENCH_MAX_LINES];
+
+#if !ENABLE_RAW_CAPTURE_RING
+// Capture's line store on one converted line per colour count: cycles and
+// ring bytes per line. With ENABLE_INDEXED_LINES that is the palette build
+// and the index copy, falling back to RGB565 past 127 colours; otherwise it
+// is the plain 512-byte copy to compare against.
+static void bench_line_store(void)
+{
+    static const uint32_t colors[] = {16U, 64U, 127U, 0U};
+    printf("%-14s %10s %10s   (store: %s)\n", "line colours", "cyc/line", "bytes",
+           ENABLE_INDEXED_LINES ? "indexed" : "rgb565");
+    line_ring_vsync(0U);
+    for (uint32_t c = 0; c < sizeof(colors) / sizeof(colors[0]); c++) {
+        bench_fill_source(false, colors[c]);
+        const uint16_t width = video_capture_convert_captured_line(s_dst, s_src, SNES_BRIGHTNESS_MAX);
+        video_capture_line_store_t before;
+        video_capture_line_store_t after;
+        video_capture_store_line(0U, s_dst, width); // warm caches
+        video_capture_get_line_store(&before);
+        const uint32_t start = bench_cycles();
+        for (uint32_t i = 0; i < BENCH_LINES; i++) {
+            video_capture_store_line((uint16_t)(i % SNES_V_ACTIVE), s_dst, width);
+        }
+        const uint32_t cycles = (bench_cycles() - start) / BENCH_LINES;
+        video_capture_get_line_store(&after);
+        const uint32_t bytes =
+            ENABLE_INDEXED_LINES ? (uint32_t)((after.bytes - before.bytes) / BENCH_LINES) : width * 2U;
+        char name[16] = "random";
+        if (colors[c]) {
+            snprintf(name, sizeof(name), "%lu", (unsigned long)colors[c]);
+        }
+        printf("%-14s %10lu %10lu\n", name, (unsigned long)cycles, (unsigned long)bytes);
+    }
+}
+#endif
+
+// One frame into the line ring as Core 0 would write it, then latched for
+// scanout. Capture has not started, so the ring is free; the indices simply
+// run on from here. Lines have BENCH_RING_COLORS colours, so an indexed
+// store keeps them indexed.
+static void bench_fill_ring(void)
+{
+    line_ring_vsync(ENABLE_RAW_CAPTURE_RING ? (SNES_BRIGHTNESS_MAX << LINE_RING_BRIGHTNESS_SHIFT) : 0U);
+    for (uint16_t y = 0; y < SNES_V_ACTIVE; y++) {
+        bench_fill_source(ENABLE_HIRES && (y % BENCH_HIRES_EVERY) == 0U, BENCH_RING_COLORS);
+#if ENABLE_RAW_CAPTURE_RING
+        memcpy(line_ring_write_ptr(y), s_src, video_capture_line_words() * sizeof(uint32_t));
+#else
+        video_capture_store_line(y, s_dst, video_capture_convert_captured_line(s_dst, s_src, SNES_BRIGHTNESS_MAX));
+#endif
+        line_ring_commit((uint16_t)(y + 1U));
+    }
+    line_ring_end_frame(SNES_V_ACTIVE);
+    line_ring_output_vsync();
+}
+
+typedef struct {
+    uint32_t avg;
+    uint32_t max;
+    uint32_t frame; // sum over the frame's lines
+} bench_scanline_t;
+
+static void bench_scanline_frame(uint32_t lines, bool osd, video_pipeline_bench_path_t path,
+                                 uint32_t *line_min)
+{
+    for (uint32_t line = 0; line < lines; line++) {
+        const uint32_t start = bench_cycles();
+        video_pipeline_bench_scanline(line, s_scanline, osd, path);
+        const uint32_t cycles = bench_cycles() - start;
+        if (cycles < line_min[line]) {
+            line_min[line] = cycles;
+        }
+    }
+}
+
+static bench_scanline_t bench_scanline_summary(uint32_t lines, const uint32_t *line_min)
+{
+    bench_scanline_t result = {0U, 0U, 0U};
+    uint64_t total = 0;
+    for (uint32_t line = 0; line < lines; line++) {
+        total += line_min[line];
+        if (line_min[line] > result.max) {
+            result.max = line_min[line];
+        }
+    }
+    result.avg = (uint32_t)(total / lines);
+    result.frame = (uint32_t)total;
+    return result;
+}
+
+// 720p: the same frame through each picture size, OSD closed, cycles per
+// output line as scanned out.
+static void bench_scalers(uint32_t lines)
+{
+    static const char *const scaler_names[VIDEO_PIPELINE_SCALER_COUNT] = {"integer 3x", "fill square", "fill 8:7",
+                                                                          "fill 4:3"};
+    const video_pipeline_scaler_t saved = video_pipeline_get_scaler();
+    printf("%-14s %4s %10s %10s %12s\n", "720p scaler", "", "avg", "max", "cyc/frame");
+    for (uint32_t sc = 0; sc < VIDEO_PIPELINE_SCALER_COUNT; sc++) {
+        video_pipeline_set_scaler((video_pipeline_scaler_t)sc);
+        memset(s_scanline_min, 0xFF, sizeof(s_scanline_min));
+        for (uint32_t f = 0; f < BENCH_SCANLINE_FRAMES; f++) {
+            bench_scanline_frame(lines, false, VIDEO_PIPELINE_BENCH_INSTALLED, s_scanline_min[0]);
+        }
+        const bench_scanline_t result = bench_scanline_summary(lines, s_scanline_min[0]);
+        printf("%-14s %4s %10lu %10lu %12lu\n", scaler_names[sc], "", (unsigned long)result.avg,
+               (unsigned long)result.max, (unsigned long)result.frame);
+    }
+    video_pipeline_set_scaler(saved);
+}
+
+// Core 1's scanline callback in the active output mode: the per-mode
+// specialised callback against one body that decodes the mode on every
+// line, with the OSD closed and open, and the specialised callback again
+// with its line cache defeated, which gives the cycles per frame the cache
+// saves. Each output line keeps its best time over the frames, so an
+// interrupt (or, in the host sim, the OS) does not pass for the worst case,
+// and the callbacks take turns frame by frame.
+static void bench_scanlines(void)
+{
+    static const char *const path_names[] = {"plan", "plan uncached", "generic"};
+    const video_mode_t *mode = video_output_active_mode;
+    const uint32_t lines = mode->v_active_lines;
+    const uint32_t line_hz = mode->pixel_clock_hz / mode->h_total_pixels;
+    printf("=== Scanline bench: %s, %lu lines x %u frames, budget %lu cyc/line ===\n", mode->name,
+           (unsigned long)lines, BENCH_SCANLINE_FRAMES, (unsigned long)(clock_get_hz(clk_sys) / line_hz));
+    printf("%-14s %4s %10s %10s %12s\n", "callback", "osd", "avg", "max", "cyc/frame");
+    bench_fill_ring();
+    for (uint32_t osd = 0; osd <= (uint32_t)ENABLE_OSD; osd++) {
+        bench_scanline_t result[VIDEO_PIPELINE_BENCH_GENERIC + 1];
+        memset(s_scanline_min, 0xFF, sizeof(s_scanline_min));
+        for (uint32_t f = 0; f < BENCH_SCANLINE_FRAMES; f++) {
+            for (uint32_t p = 0; p <= VIDEO_PIPELINE_BENCH_GENERIC; p++) {
+                bench_scanline_frame(lines, osd != 0U, (video_pipeline_bench_path_t)p, s_scanline_min[p]);
+            }
+        }
+        for (uint32_t p = 0; p <= VIDEO_PIPELINE_BENCH_GENERIC; p++) {
+            result[p] = bench_scanline_summary(lines, s_scanline_min[p]);
+            printf("%-14s %4s %10lu %10lu %12lu\n", path_names[p], osd ? "on" : "off",
+                   (unsigned long)result[p].avg, (unsigned long)result[p].max,
+                   (unsigned long)result[p].frame);
+        }
+        const bench_scanline_t *plan = &result[VIDEO_PIPELINE_BENCH_INSTALLED];
+        const bench_scanline_t *uncached = &result[VIDEO_PIPELINE_BENCH_UNCACHED];
+        const bench_scanline_t *generic = &result[VIDEO_PIPELINE_BENCH_GENERIC];
+        printf("  plan vs generic worst case %+ld%%, line cache saves %ld cyc/frame\n",
+               generic->max ? ((long)plan->max - (long)generic->max) * 100L / (long)generic->max : 0L,
+               (long)uncached->frame - (long)plan->frame);
+    }
+    if (lines == 720U) {
+        bench_scalers(lines);
+    }
+}
+
+void capture_bench_run(void)
+{
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+    printf("=== Capture conversion bench: %lu words/line, %u lines, line rate %u Hz ===\n",
+           (unsigned long)video_capture_line_words(), BENCH_LINES, SNES_LINE_RATE_HZ);
+    printf("%-14s %10s", "path", "cyc/line");
+    for (uint32_t c = 0; c < sizeof(s_sysclk_mhz) / sizeof(s_sysclk_mhz[0]); c++) {
+        printf("   %3luMHz budget", (unsigned long)s_sysclk_mhz[c]);
+    }
+    printf("\n");
+
+    for (uint32_t i = 0; i < sizeof(s_cases) / sizeof(s_cases[0]); i++) {
+        bench_fill_source(s_cases[i].hires, 0U);
+        const uint32_t cycles = bench_line_cycles(s_cases[i].brightness);
+        printf("%-14s %10lu", s_cases[i].name, (unsigned long)cycles);
+        for (uint32_t c = 0; c < sizeof(s_sysclk_mhz) / sizeof(s_sysclk_mhz[0]); c++) {
+            const uint32_t budget = (s_sysclk_mhz[c] * 1000000U) / SNES_LINE_RATE_HZ;
+            printf("   %6lu %-4s", (unsigned long)budget, (cycles <= budget) ? "ok" : "OVER");
+        }
+        printf("\n");
+    }
+    bench_kernels();
+#if !ENABLE_RAW_CAPTURE_RING
+    bench_line_store();
+#endif
+#if ENABLE_OSD && ENABLE_INDEXED_OSD
+    bench_osd_rows();
+#endif
+    bench_scanlines();
+    stdio_flush();
+}
@@ -0,0 +1,21 @@
+#ifndef CAPTURE_BENCH_H
+#define CAPTURE_BENCH_H
+
+/**
+ * Capture conversion benchmark.
+ *
+ * Times the per-line conversion paths with the core cycle counter and prints
+ * cycles/line against the SNES line budget at each supported sysclk. Runs on
+ * Core 0 before capture starts (ENABLE_CAPTURE_BENCH) and from the host sim
+ * (--bench), where "cycles" are host nanoseconds. A second table times each
+ * full-brightness kernel in the build (LUT loop, interpolators, lean rbit)
+ * on the same line and prints the SRAM the conversion tables take, then with
+ * the indexed OSD its glyph row expansion against the framebuffer copy. A third
+ * times Core 1's scanline callback over a frame in the active output mode:
+ * the mode's specialised callback against the unspecialised body, with the
+ * OSD closed and open, and the cycles per frame its line cache saves; in
+ * 720p, also each picture size of the scaler.
+ */
+void capture_bench_run(void);
+
+#endif // CAPTURE_BENCH_H
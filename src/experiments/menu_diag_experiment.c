@@ -21,6 +21,7 @@
 #include "osd/selftest_layout.h"
 #include "settings.h"
 #include "snes_pins.h"
+#include "video/genlock.h"
 #include "video/video_capture.h"
 #include "video/video_pipeline.h"
 
@@ -43,7 +44,7 @@ extern volatile uint32_t video_frame_count;
 #endif
 
 #define ROOT_TITLE_ROW 1
-#define ROOT_FIRST_ENTRY_ROW 5
+#define ROOT_FIRST_ENTRY_ROW 2
 #define ROOT_IDLE_HIDE_MS 8000U
 #define STATUS_UPDATE_FRAMES 30U
 #define SELFTEST_UPDATE_FRAMES 60U
@@ -55,7 +56,13 @@ typedef enum {
     MENU_SCREEN_HIDDEN = 0,
     MENU_SCREEN_ROOT,
     MENU_SCREEN_RESOLUTION,
+#if ENABLE_INTERLACE
+    MENU_SCREEN_DEINTERLACE,
+#endif
+    MENU_SCREEN_SCALER,
+    MENU_SCREEN_LATENCY,
     MENU_SCREEN_STATUS,
+    MENU_SCREEN_CALIBRATE,
     MENU_SCREEN_SELFTEST,
 #if ENABLE_OSD_RES_CONFIRM
     MENU_SCREEN_RES_CONFIRM,
@@ -70,7 +77,12 @@ static uint32_t s_last_back_press_ms = 0;
 static uint32_t s_last_input_ms = 0;
 static uint8_t s_root_sel = 0;
 static uint32_t s_last_status_frame = 0;
+static uint32_t s_status_ring_overruns = 0; // ring counters when Status opened
+static uint32_t s_status_ring_not_ready = 0;
+static uint32_t s_status_frames_dropped = 0; // frame buffer counters when Status opened
+static uint32_t s_status_frames_repeated = 0;
 static uint32_t s_last_selftest_frame = 0;
+static bool s_calibrate_running = false;
 static uint32_t s_video_hi = 0;
 static uint32_t s_video_lo = 0;
 static uint32_t s_video_samples = 0;
@@ -88,9 +100,33 @@ static uint32_t s_res_confirm_deadline_ms = 0;
 static int32_t s_res_confirm_last_secs = -1;
 #endif
 
+#if ENABLE_INTERLACE
+static video_pipeline_deinterlace_t s_selected_deinterlace = VIDEO_PIPELINE_DEINTERLACE_WEAVE;
+#endif
+static video_pipeline_scaler_t s_selected_scaler = VIDEO_PIPELINE_SCALER_INTEGER;
+static video_pipeline_latency_t s_selected_latency = VIDEO_PIPELINE_LATENCY_LOW;
+
+enum {
+    ROOT_ENTRY_RESOLUTION = 0,
+#if ENABLE_INTERLACE
+    ROOT_ENTRY_DEINTERLACE,
+#endif
+    ROOT_ENTRY_SCALER,
+    ROOT_ENTRY_LATENCY,
+    ROOT_ENTRY_STATUS,
+    ROOT_ENTRY_CALIBRATE,
+    ROOT_ENTRY_SELFTEST,
+};
+
 static const char *const s_root_entry_labels[] = {
     "Resolution",
+#if ENABLE_INTERLACE
+    "Deinterlace",
+#endif
+    "720p Scaling",
+    "Latency",
     "Status",
+    "Calibrate",
     "Self Test",
 };
 #define ROOT_ENTRY_COUNT ((uint8_t)(sizeof(s_root_entry_labels) / sizeof(s_root_entry_labels[0])))
@@ -100,13 +136,14 @@ static void root_menu_enter(uint32_t now_ms);
 #if ENABLE_REBOOT_MODE_SWITCH
 static const char *resolution_label(video_pipeline_reboot_mode_t mode)
 {
+    const bool pal = (video_pipeline_get_region() == SNES_REGION_PAL);
     switch (mode) {
         case VIDEO_PIPELINE_REBOOT_MODE_240P:
             return "240p";
         case VIDEO_PIPELINE_REBOOT_MODE_720P:
-            return "720p";
+            return pal ? "720p50" : "720p";
         default:
-            return "480p";
+            return pal ? "576p" : "480p";
     }
 }
 
@@ -116,7 +153,7 @@ static const char *resolution_description(video_pipeline_reboot_mode_t mode)
         case VIDEO_PIPELINE_REBOOT_MODE_240P:
             return "Direct Mode";
         case VIDEO_PIPELINE_REBOOT_MODE_720P:
-            return "Experimental 3x";
+            return "3x or fill";
         default:
             return "2x Integer Scaling";
     }
@@ -132,7 +169,9 @@ static video_pipeline_reboot_mode_t resolution_next(video_pipeline_reboot_mode_t
             return VIDEO_PIPELINE_REBOOT_MODE_720P;
 #endif
         default:
-            return VIDEO_PIPELINE_REBOOT_MODE_240P;
+            // PAL has no direct mode; main boots Direct as 576p.
+            return (video_pipeline_get_region() == SNES_REGION_PAL) ? VIDEO_PIPELINE_REBOOT_MODE_480P
+                                                                    : VIDEO_PIPELINE_REBOOT_MODE_240P;
     }
 }
 
@@ -141,7 +180,7 @@ static bool resolution_option_row(video_pipeline_reboot_mode_t mode, uint8_t *ro
     switch (mode) {
         case VIDEO_PIPELINE_REBOOT_MODE_240P:
             *row = 7;
-            return true;
+            return video_pipeline_get_region() != SNES_REGION_PAL;
         case VIDEO_PIPELINE_REBOOT_MODE_480P:
             *row = 9;
             return true;
@@ -199,7 +238,9 @@ static void resolution_draw(void)
     fast_osd_clear();
     fast_osd_puts_color(1, 2, "SuperPico Output", OSD_COLOR_YELLOW);
     fast_osd_puts_color(5, 2, "Resolution", OSD_COLOR_FG);
-    resolution_render_option(7, VIDEO_PIPELINE_REBOOT_MODE_240P);
+    if (video_pipeline_get_region() != SNES_REGION_PAL) {
+        resolution_render_option(7, VIDEO_PIPELINE_REBOOT_MODE_240P);
+    }
     resolution_render_option(9, VIDEO_PIPELINE_REBOOT_MODE_480P);
 #if ENABLE_REBOOT_MODE_SWITCH_720P
     resolution_render_option(11, VIDEO_PIPELINE_REBOOT_MODE_720P);
@@ -291,6 +332,266 @@ void menu_diag_experiment_arm_res_confirm(video_pipeline_reboot_mode_t new_mode,
 #endif
 #endif
 
+#if ENABLE_INTERLACE
+#define DEINTERLACE_FIRST_ROW 7
+
+static const char *deinterlace_label(video_pipeline_deinterlace_t mode)
+{
+    return (mode == VIDEO_PIPELINE_DEINTERLACE_BOB) ? "Bob" : "Weave";
+}
+
+static const char *deinterlace_description(video_pipeline_deinterlace_t mode)
+{
+    return (mode == VIDEO_PIPELINE_DEINTERLACE_BOB) ? "No combing, 224 lines" : "Full 448 lines";
+}
+
+static void deinterlace_render_description(void)
+{
+    fast_osd_puts_color(13, 2, "                    ", OSD_COLOR_GRAY);
+    fast_osd_puts_color(13, 2, deinterlace_description(s_selected_deinterlace), OSD_COLOR_GRAY);
+}
+
+static void deinterlace_render_option(video_pipeline_deinterlace_t mode)
+{
+    const uint8_t row = (uint8_t)(DEINTERLACE_FIRST_ROW + (2U * (uint32_t)mode));
+    const bool selected = (s_selected_deinterlace == mode);
+    const bool current = (video_pipeline_get_deinterlace() == mode);
+    const uint16_t color = selected ? OSD_COLOR_YELLOW : current ? OSD_COLOR_GREEN : OSD_COLOR_FG;
+    const char *label = deinterlace_label(mode);
+    fast_osd_putc_color(row, 3, selected ? '>' : ' ', color);
+    fast_osd_puts_color(row, 5, label, color);
+    fast_osd_putc_color(row, (uint8_t)(5 + strlen(label)), current ? '*' : ' ', color);
+}
+
+static void deinterlace_draw(void)
+{
+    fast_osd_clear();
+    fast_osd_puts_color(1, 2, "SuperPico Output", OSD_COLOR_YELLOW);
+    fast_osd_puts_color(5, 2, "Deinterlace 480p/720p", OSD_COLOR_FG);
+    deinterlace_render_option(VIDEO_PIPELINE_DEINTERLACE_WEAVE);
+    deinterlace_render_option(VIDEO_PIPELINE_DEINTERLACE_BOB);
+    deinterlace_render_description();
+}
+
+static void deinterlace_enter(void)
+{
+    s_selected_deinterlace = video_pipeline_get_deinterlace();
+    deinterlace_draw();
+    s_screen = MENU_SCREEN_DEINTERLACE;
+    osd_show();
+}
+
+static void deinterlace_cycle(void)
+{
+    const video_pipeline_deinterlace_t previous = s_selected_deinterlace;
+    s_selected_deinterlace = (previous == VIDEO_PIPELINE_DEINTERLACE_WEAVE) ? VIDEO_PIPELINE_DEINTERLACE_BOB
+                                                                          : VIDEO_PIPELINE_DEINTERLACE_WEAVE;
+    deinterlace_render_option(previous);
+    deinterlace_render_option(s_selected_deinterlace);
+    deinterlace_render_description();
+}
+
+// Takes effect at the next output frame; no reboot needed.
+static void deinterlace_apply(uint32_t now_ms)
+{
+    if (s_selected_deinterlace != video_pipeline_get_deinterlace()) {
+        video_pipeline_set_deinterlace(s_selected_deinterlace);
+#if ENABLE_SETTINGS_FLASH
+        superpico_settings_t persisted;
+        settings_load(&persisted);
+        persisted.deinterlace = (uint8_t)s_selected_deinterlace;
+        settings_save(&persisted);
+#endif
+    }
+    root_menu_enter(now_ms);
+}
+#endif
+
+#define SCALER_FIRST_ROW 5
+
+static const char *scaler_label(video_pipeline_scaler_t mode)
+{
+    switch (mode) {
+        case VIDEO_PIPELINE_SCALER_SQUARE:
+            return "Square";
+        case VIDEO_PIPELINE_SCALER_8_7:
+            return "8:7";
+        case VIDEO_PIPELINE_SCALER_4_3:
+            return "4:3";
+        default:
+            return "Integer";
+    }
+}
+
+static const char *scaler_description(video_pipeline_scaler_t mode)
+{
+    switch (mode) {
+        case VIDEO_PIPELINE_SCALER_SQUARE:
+            return "Fill, square pixels";
+        case VIDEO_PIPELINE_SCALER_8_7:
+            return "Fill, 8:7 pixels";
+        case VIDEO_PIPELINE_SCALER_4_3:
+            return "Fill, 4:3 picture";
+        default:
+            return "3x, 768x672";
+    }
+}
+
+static void scaler_render_description(void)
+{
+    fast_osd_puts_color(13, 2, "                    ", OSD_COLOR_GRAY);
+    fast_osd_puts_color(13, 2, scaler_description(s_selected_scaler), OSD_COLOR_GRAY);
+}
+
+static void scaler_render_option(video_pipeline_scaler_t mode)
+{
+    const uint8_t row = (uint8_t)(SCALER_FIRST_ROW + (2U * (uint32_t)mode));
+    const bool selected = (s_selected_scaler == mode);
+    const bool current = (video_pipeline_get_scaler() == mode);
+    const uint16_t color = selected ? OSD_COLOR_YELLOW : current ? OSD_COLOR_GREEN : OSD_COLOR_FG;
+    const char *label = scaler_label(mode);
+    fast_osd_putc_color(row, 3, selected ? '>' : ' ', color);
+    fast_osd_puts_color(row, 5, label, color);
+    fast_osd_putc_color(row, (uint8_t)(5 + strlen(label)), current ? '*' : ' ', color);
+}
+
+static void scaler_draw(void)
+{
+    fast_osd_clear();
+    fast_osd_puts_color(1, 2, "SuperPico Output", OSD_COLOR_YELLOW);
+    fast_osd_puts_color(3, 2, "720p Scaling", OSD_COLOR_FG);
+    for (uint32_t mode = 0; mode < VIDEO_PIPELINE_SCALER_COUNT; mode++) {
+        scaler_render_option((video_pipeline_scaler_t)mode);
+    }
+    scaler_render_description();
+}
+
+static void scaler_enter(void)
+{
+    s_selected_scaler = video_pipeline_get_scaler();
+    scaler_draw();
+    s_screen = MENU_SCREEN_SCALER;
+    osd_show();
+}
+
+static void scaler_cycle(void)
+{
+    const video_pipeline_scaler_t previous = s_selected_scaler;
+    s_selected_scaler = (video_pipeline_scaler_t)(((uint32_t)previous + 1U) % VIDEO_PIPELINE_SCALER_COUNT);
+    scaler_render_option(previous);
+    scaler_render_option(s_selected_scaler);
+    scaler_render_description();
+}
+
+// Takes effect at the next output frame without the menu; no reboot needed.
+static void scaler_apply(uint32_t now_ms)
+{
+    if (s_selected_scaler != video_pipeline_get_scaler()) {
+        video_pipeline_set_scaler(s_selected_scaler);
+#if ENABLE_SETTINGS_FLASH
+        superpico_settings_t persisted;
+        settings_load(&persisted);
+        persisted.scaler = (uint8_t)s_selected_scaler;
+        settings_save(&persisted);
+#endif
+    }
+    root_menu_enter(now_ms);
+}
+
+#define LATENCY_FIRST_ROW 5
+
+static const char *latency_label(video_pipeline_latency_t mode)
+{
+    switch (mode) {
+        case VIDEO_PIPELINE_LATENCY_FRAME:
+            return "Safe";
+        case VIDEO_PIPELINE_LATENCY_RACE:
+            return "Race";
+        default:
+            return "Low";
+    }
+}
+
+static const char *latency_description(video_pipeline_latency_t mode)
+{
+    switch (mode) {
+        case VIDEO_PIPELINE_LATENCY_FRAME:
+            return "+1 frame, no tearing";
+        case VIDEO_PIPELINE_LATENCY_RACE:
+            return "Locked close behind";
+        default:
+            return "Few lines, may tear";
+    }
+}
+
+static void latency_render_description(void)
+{
+    fast_osd_puts_color(13, 2, "                    ", OSD_COLOR_GRAY);
+    fast_osd_puts_color(13, 2, latency_description(s_selected_latency), OSD_COLOR_GRAY);
+}
+
+static void latency_render_option(video_pipeline_latency_t mode)
+{
+    const uint8_t row = (uint8_t)(LATENCY_FIRST_ROW + (2U * (uint32_t)mode));
+    const bool selected = (s_selected_latency == mode);
+    const bool current = (video_pipeline_get_latency() == mode);
+    const uint16_t color = selected ? OSD_COLOR_YELLOW : current ? OSD_COLOR_GREEN : OSD_COLOR_FG;
+    const char *label = latency_label(mode);
+    fast_osd_putc_color(row, 3, selected ? '>' : ' ', color);
+    fast_osd_puts_color(row, 5, label, color);
+    fast_osd_putc_color(row, (uint8_t)(5 + strlen(label)), current ? '*' : ' ', color);
+}
+
+static void latency_draw(void)
+{
+    fast_osd_clear();
+    fast_osd_puts_color(1, 2, "SuperPico Output", OSD_COLOR_YELLOW);
+    fast_osd_puts_color(3, 2, "Latency", OSD_COLOR_FG);
+    // Whole frames need the full ring, racing needs the genlock.
+    for (uint32_t mode = 0; mode < VIDEO_PIPELINE_LATENCY_COUNT; mode++) {
+        if (video_pipeline_latency_supported((video_pipeline_latency_t)mode)) {
+            latency_render_option((video_pipeline_latency_t)mode);
+        }
+    }
+    latency_render_description();
+}
+
+static void latency_enter(void)
+{
+    s_selected_latency = video_pipeline_get_latency();
+    latency_draw();
+    s_screen = MENU_SCREEN_LATENCY;
+    osd_show();
+}
+
+static void latency_cycle(void)
+{
+    const video_pipeline_latency_t previous = s_selected_latency;
+    do {
+        s_selected_latency =
+            (video_pipeline_latency_t)(((uint32_t)s_selected_latency + 1U) % VIDEO_PIPELINE_LATENCY_COUNT);
+    } while (!video_pipeline_latency_supported(s_selected_latency));
+    latency_render_option(previous);
+    latency_render_option(s_selected_latency);
+    latency_render_description();
+}
+
+// Takes effect at the next output frame; the switch itself may blank a
+// frame while Core 0 changes the ring's geometry.
+static void latency_apply(uint32_t now_ms)
+{
+    if (s_selected_latency != video_pipeline_get_latency()) {
+        video_pipeline_set_latency(s_selected_latency);
+#if ENABLE_SETTINGS_FLASH
+        superpico_settings_t persisted;
+        settings_load(&persisted);
+        persisted.latency = (uint8_t)s_selected_latency;
+        settings_save(&persisted);
+#endif
+    }
+    root_menu_enter(now_ms);
+}
+
 static void root_menu_render_entry(uint8_t idx)
 {
     const bool selected = (s_root_sel == idx);
@@ -307,7 +608,7 @@ static void root_menu_draw(void)
     for (uint8_t i = 0; i < ROOT_ENTRY_COUNT; i++) {
         root_menu_render_entry(i);
     }
-    fast_osd_puts_color(13, 2, "MENU enter BACK cycle", OSD_COLOR_GRAY);
+    fast_osd_puts_color(15, 2, "MENU enter BACK cycle", OSD_COLOR_GRAY);
 }
 
 static void root_menu_enter(uint32_t now_ms)
@@ -321,17 +622,28 @@ static void root_menu_enter(uint32_t now_ms)
 static void status_draw_static(void)
 {
     fast_osd_clear();
-    fast_osd_puts_color(1, 2, "SuperPico Status", OSD_COLOR_YELLOW);
-    fast_osd_puts_color(4, 2, "IN", OSD_COLOR_GRAY);
-    fast_osd_puts_color(5, 2, "OUT", OSD_COLOR_GRAY);
-    fast_osd_puts_color(6, 2, "DIQ", OSD_COLOR_GRAY);
+    fast_osd_puts_color(0, 2, "SuperPico Status", OSD_COLOR_YELLOW);
+#if !ENABLE_RAW_CAPTURE_RING
+    fast_osd_puts_color(1, 2, "LAT", OSD_COLOR_GRAY);
+#endif
+#if ENABLE_GENLOCK
+    fast_osd_puts_color(2, 2, "LOCK", OSD_COLOR_GRAY);
+#endif
+    fast_osd_puts_color(3, 2, "IN", OSD_COLOR_GRAY);
+    fast_osd_puts_color(4, 2, "OUT", OSD_COLOR_GRAY);
+    fast_osd_puts_color(5, 2, "DIQ", OSD_COLOR_GRAY);
+    fast_osd_puts_color(6, 2, "SCAN", OSD_COLOR_GRAY);
 #if ENABLE_AUDIO
-    fast_osd_puts_color(8, 2, "AUD", OSD_COLOR_GRAY);
-    fast_osd_puts_color(9, 2, "RATE", OSD_COLOR_GRAY);
-    fast_osd_puts_color(10, 2, "OVF", OSD_COLOR_GRAY);
-    fast_osd_puts_color(11, 2, "REARM", OSD_COLOR_GRAY);
+    fast_osd_puts_color(7, 2, "AUD", OSD_COLOR_GRAY);
+    fast_osd_puts_color(8, 2, "RATE", OSD_COLOR_GRAY);
+    fast_osd_puts_color(9, 2, "OVF", OSD_COLOR_GRAY);
+    fast_osd_puts_color(10, 2, "REARM", OSD_COLOR_GRAY);
 #endif
-    fast_osd_puts_color(14, 2, "MENU back", OSD_COLOR_GRAY);
+    fast_osd_puts_color(11, 2, "IDLE", OSD_COLOR_GRAY);
+    fast_osd_puts_color(12, 2, "LINE", OSD_COLOR_GRAY);
+    fast_osd_puts_color(13, 2, "SYNC", OSD_COLOR_GRAY);
+    fast_osd_puts_color(14, 2, "RING", OSD_COLOR_GRAY);
+    fast_osd_puts_color(15, 2, "MENU back", OSD_COLOR_GRAY);
 }
 
 static void put_u32(uint8_t row, uint8_t col, uint32_t value, uint16_t color)
@@ -343,21 +655,103 @@ static void put_u32(uint8_t row, uint8_t col, uint32_t value, uint16_t color)
 
 static void status_update_values(void)
 {
-    put_u32(4, 8, video_capture_get_frame_count(), OSD_COLOR_GREEN);
-    put_u32(5, 8, video_frame_count, OSD_COLOR_GREEN);
-    put_u32(6, 8, hstx_di_queue_get_level(), OSD_COLOR_GREEN);
+#if !ENABLE_RAW_CAPTURE_RING
+    {
+        // Capture-to-scanout latency since the last refresh: min/avg/max us.
+        video_pipeline_latency_stats_t lat;
+        video_pipeline_take_latency_stats(&lat);
+        char buf[32];
+        if (lat.lines != 0U) {
+            snprintf(buf, sizeof(buf), "%5lu%6lu%6lu", (unsigned long)lat.min_us, (unsigned long)lat.avg_us,
+                     (unsigned long)lat.max_us);
+        } else {
+            snprintf(buf, sizeof(buf), "%5s%6s%6s", "-", "-", "-");
+        }
+        fast_osd_puts_color(1, 8, buf, lat.lines ? OSD_COLOR_GREEN : OSD_COLOR_YELLOW);
+    }
+#endif
+#if ENABLE_GENLOCK
+    {
+        // Output vsync after the SNES top of frame, and its peak-to-peak
+        // jitter once the genlock holds it.
+        genlock_status_t lock;
+        genlock_get_status(&lock);
+        char buf[32];
+        if (lock.locked) {
+            snprintf(buf, sizeof(buf), "%+7ldus%5luus", (long)lock.phase_us, (unsigned long)lock.jitter_us);
+        } else {
+            snprintf(buf, sizeof(buf), "%+7ldus SEEK ", (long)lock.phase_us);
+        }
+        fast_osd_puts_color(2, 8, buf, lock.locked ? OSD_COLOR_GREEN : OSD_COLOR_YELLOW);
+    }
+#endif
+    put_u32(3, 8, video_capture_get_frame_count(), OSD_COLOR_GREEN);
+    put_u32(4, 8, video_frame_count, OSD_COLOR_GREEN);
+    if (video_pipeline_get_latency() == VIDEO_PIPELINE_LATENCY_FRAME) {
+        // Whole frames: input frames dropped and output frames repeated
+        // since this screen opened.
+        const uint32_t dropped = video_pipeline_get_frames_dropped() - s_status_frames_dropped;
+        const uint32_t repeated = video_pipeline_get_frames_repeated() - s_status_frames_repeated;
+        char buf[16];
+        snprintf(buf, sizeof(buf), "-%6lu", (unsigned long)dropped);
+        fast_osd_puts_color(3, 19, buf, dropped ? OSD_COLOR_YELLOW : OSD_COLOR_GREEN);
+        snprintf(buf, sizeof(buf), "+%6lu", (unsigned long)repeated);
+        fast_osd_puts_color(4, 19, buf, repeated ? OSD_COLOR_YELLOW : OSD_COLOR_GREEN);
+    }
+    put_u32(5, 8, hstx_di_queue_get_level(), OSD_COLOR_GREEN);
+    {
+        const bool pal = (video_capture_get_region() == SNES_REGION_PAL);
+        const bool interlaced = video_capture_is_interlaced();
+        char scan[16];
+        snprintf(scan, sizeof(scan), "%3lu%c%u", (unsigned long)(video_capture_get_height() * (interlaced ? 2U : 1U)),
+                 interlaced ? 'i' : 'p', pal ? 50U : 60U);
+        fast_osd_puts_color(6, 12, scan, OSD_COLOR_GREEN);
+    }
 #if ENABLE_AUDIO
     audio_pipeline_diag_t diag;
     audio_pipeline_get_diag(&diag);
-    fast_osd_puts_color(8, 8, diag.muted ? "MUTED   " : "RUNNING ", diag.muted ? OSD_COLOR_YELLOW : OSD_COLOR_GREEN);
-    put_u32(9, 8, diag.measured_rate_hz, diag.measured_rate_hz ? OSD_COLOR_GREEN : OSD_COLOR_YELLOW);
-    put_u32(10, 8, diag.overflows, diag.overflows ? OSD_COLOR_YELLOW : OSD_COLOR_GREEN);
-    put_u32(11, 8, diag.rearm_count, diag.rearm_count ? OSD_COLOR_YELLOW : OSD_COLOR_GREEN);
+    fast_osd_puts_color(7, 8, diag.muted ? "MUTED   " : "RUNNING ", diag.muted ? OSD_COLOR_YELLOW : OSD_COLOR_GREEN);
+    put_u32(8, 8, diag.measured_rate_hz, diag.measured_rate_hz ? OSD_COLOR_GREEN : OSD_COLOR_YELLOW);
+    put_u32(9, 8, diag.overflows, diag.overflows ? OSD_COLOR_YELLOW : OSD_COLOR_GREEN);
+    put_u32(10, 8, diag.rearm_count, diag.rearm_count ? OSD_COLOR_YELLOW : OSD_COLOR_GREEN);
 #endif
+    {
+        // Core 0 idle share, and Core 1's slowest scanline since the last
+        // refresh (cycles) - the two costs the raw capture ring trades.
+        const uint32_t idle = video_capture_get_idle_permille();
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%3lu.%lu%%", (unsigned long)(idle / 10U), (unsigned long)(idle % 10U));
+        fast_osd_puts_color(11, 12, buf, OSD_COLOR_GREEN);
+        put_u32(12, 8, video_pipeline_take_scanline_max_cycles(), OSD_COLOR_GREEN);
+    }
+    if (!video_capture_has_signal()) {
+        fast_osd_puts_color(13, 8, "NO SIGNAL ", OSD_COLOR_YELLOW);
+    } else {
+        // Signal losses, and how long the latest relock took.
+        const uint32_t losses = video_capture_get_signal_losses();
+        const uint32_t relock_us = video_capture_get_relock_us();
+        char buf[24];
+        snprintf(buf, sizeof(buf), "%2lu%4lu.%lums", (unsigned long)losses, (unsigned long)(relock_us / 1000U),
+                 (unsigned long)((relock_us / 100U) % 10U));
+        fast_osd_puts_color(13, 8, buf, losses ? OSD_COLOR_YELLOW : OSD_COLOR_GREEN);
+    }
+    {
+        // Line ring depth, and scanout lines it lost since this screen
+        // opened: lapped by Core 0 (too shallow), then not yet written.
+        const uint32_t overruns = video_pipeline_get_ring_overruns() - s_status_ring_overruns;
+        const uint32_t not_ready = video_pipeline_get_ring_not_ready() - s_status_ring_not_ready;
+        char buf[24];
+        snprintf(buf, sizeof(buf), "%3u%7lu%7lu", (unsigned)LINE_RING_SIZE, (unsigned long)overruns, (unsigned long)not_ready);
+        fast_osd_puts_color(14, 8, buf, overruns ? OSD_COLOR_YELLOW : OSD_COLOR_GREEN);
+    }
 }
 
 static void status_enter(void)
 {
+    s_status_ring_overruns = video_pipeline_get_ring_overruns();
+    s_status_ring_not_ready = video_pipeline_get_ring_not_ready();
+    s_status_frames_dropped = video_pipeline_get_frames_dropped();
+    s_status_frames_repeated = video_pipeline_get_frames_repeated();
     status_draw_static();
     status_update_values();
     s_last_status_frame = video_frame_count;
@@ -365,6 +759,82 @@ static void status_enter(void)
     osd_show();
 }
 
+// Capture sampling phase. The eye scan runs on Core 0 over ~2 s of frames;
+// this screen starts it, follows its progress and persists the result.
+static void calibrate_draw_static(void)
+{
+    fast_osd_clear();
+    fast_osd_puts_color(1, 2, "SuperPico Calibrate", OSD_COLOR_YELLOW);
+    fast_osd_puts_color(4, 2, "SKIP", OSD_COLOR_GRAY);
+    fast_osd_puts_color(5, 2, "SAMPLE", OSD_COLOR_GRAY);
+    fast_osd_puts_color(6, 2, "EYE", OSD_COLOR_GRAY);
+    fast_osd_puts_color(7, 2, "SCAN", OSD_COLOR_GRAY);
+    fast_osd_puts_color(10, 2, "Pause on a still screen", OSD_COLOR_GRAY);
+    fast_osd_puts_color(11, 2, "before scanning.", OSD_COLOR_GRAY);
+}
+
+static void calibrate_update_values(void)
+{
+    video_capture_calibration_t cal;
+    video_capture_get_calibration(&cal);
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%2u dots", cal.skip);
+    fast_osd_puts_color(4, 10, buf, OSD_COLOR_GREEN);
+    snprintf(buf, sizeof(buf), "%3u ns (+%u/%u)", cal.sample_ns, cal.delay, cal.delay_max);
+    fast_osd_puts_color(5, 10, buf, OSD_COLOR_GREEN);
+    if (cal.done) {
+        snprintf(buf, sizeof(buf), "%3u-%u ns  ", cal.eye_lo_ns, cal.eye_hi_ns);
+    } else {
+        snprintf(buf, sizeof(buf), "  -        ");
+    }
+    fast_osd_puts_color(6, 10, buf, OSD_COLOR_GREEN);
+    if (cal.busy) {
+        snprintf(buf, sizeof(buf), "%2u/%u  ", cal.points_done, cal.points_total);
+        fast_osd_puts_color(7, 10, buf, OSD_COLOR_YELLOW);
+        fast_osd_puts_color(15, 2, "Scanning...          ", OSD_COLOR_GRAY);
+    } else {
+        fast_osd_puts_color(15, 2, "MENU scan BACK back  ", OSD_COLOR_GRAY);
+    }
+}
+
+static void calibrate_enter(void)
+{
+    calibrate_draw_static();
+    fast_osd_puts_color(7, 10, "idle", OSD_COLOR_GREEN);
+    calibrate_update_values();
+    s_last_status_frame = video_frame_count;
+    s_screen = MENU_SCREEN_CALIBRATE;
+    osd_show();
+}
+
+static void calibrate_start(void)
+{
+    video_capture_start_calibration();
+    s_calibrate_running = true;
+    calibrate_update_values();
+}
+
+// A scan that ran every point took; one cut short by a signal loss left the
+// old phase in place.
+static void calibrate_finish(void)
+{
+    video_capture_calibration_t cal;
+    video_capture_get_calibration(&cal);
+    s_calibrate_running = false;
+    const bool complete = cal.done && cal.points_done == cal.points_total;
+    fast_osd_puts_color(7, 10, complete ? "done   " : "aborted", complete ? OSD_COLOR_GREEN : OSD_COLOR_YELLOW);
+    calibrate_update_values();
+#if ENABLE_SETTINGS_FLASH
+    if (complete) {
+        superpico_settings_t persisted;
+        settings_load(&persisted);
+        persisted.capture_skip = cal.skip;
+        persisted.capture_sample_ns = cal.sample_ns;
+        settings_save(&persisted);
+    }
+#endif
+}
+
 static void selftest_reset_counters(void)
 {
     s_video_hi = 0;
@@ -386,12 +856,30 @@ static void selftest_enter(void)
 
 static void root_menu_enter_leaf(void)
 {
-    if (s_root_sel == 0) {
-        resolution_enter();
-    } else if (s_root_sel == 1) {
-        status_enter();
-    } else {
-        selftest_enter();
+    switch (s_root_sel) {
+        case ROOT_ENTRY_RESOLUTION:
+            resolution_enter();
+            break;
+#if ENABLE_INTERLACE
+        case ROOT_ENTRY_DEINTERLACE:
+            deinterlace_enter();
+            break;
+#endif
+        case ROOT_ENTRY_SCALER:
+            scaler_enter();
+            break;
+        case ROOT_ENTRY_LATENCY:
+            latency_enter();
+            break;
+        case ROOT_ENTRY_STATUS:
+            status_enter();
+            break;
+        case ROOT_ENTRY_CALIBRATE:
+            calibrate_enter();
+            break;
+        default:
+            selftest_enter();
+            break;
     }
 }
 
@@ -532,6 +1020,16 @@ void menu_diag_experiment_tick_background(void)
             }
             break;
 
+#if ENABLE_INTERLACE
+        case MENU_SCREEN_DEINTERLACE:
+            if (back_edge) {
+                deinterlace_cycle();
+            } else if (menu_edge) {
+                deinterlace_apply(now_ms);
+            }
+            break;
+#endif
+
 #if ENABLE_REBOOT_MODE_SWITCH && ENABLE_OSD_RES_CONFIRM
         case MENU_SCREEN_RES_CONFIRM:
             if (menu_edge) {
@@ -551,6 +1049,22 @@ void menu_diag_experiment_tick_background(void)
             break;
 #endif
 
+        case MENU_SCREEN_SCALER:
+            if (back_edge) {
+                scaler_cycle();
+            } else if (menu_edge) {
+                scaler_apply(now_ms);
+            }
+            break;
+
+        case MENU_SCREEN_LATENCY:
+            if (back_edge) {
+                latency_cycle();
+            } else if (menu_edge) {
+                latency_apply(now_ms);
+            }
+            break;
+
         case MENU_SCREEN_STATUS:
             if (menu_edge) {
                 root_menu_enter(now_ms);
@@ -560,6 +1074,23 @@ void menu_diag_experiment_tick_background(void)
             }
             break;
 
+        case MENU_SCREEN_CALIBRATE:
+            if (s_calibrate_running) {
+                video_capture_calibration_t cal;
+                video_capture_get_calibration(&cal);
+                if (!cal.busy) {
+                    calibrate_finish();
+                } else if ((video_frame_count - s_last_status_frame) >= STATUS_UPDATE_FRAMES) {
+                    s_last_status_frame = video_frame_count;
+                    calibrate_update_values();
+                }
+            } else if (menu_edge) {
+                calibrate_start();
+            } else if (back_edge) {
+                root_menu_enter(now_ms);
+            }
+            break;
+
         case MENU_SCREEN_SELFTEST:
             if (menu_edge) {
                 root_menu_enter(now_ms);
@@ -11,8 +11,10 @@
 #include "video/video_pipeline.h"
 #include "video/video_capture.h"
 #include "video/freq_counter.h"
+#include "video/genlock.h"
 #include "video/snes_timing.h"
 #include "video/video_config.h"
+#include "video/video_modes_50hz.h"
 #include "config.h"
 #include "settings.h"
 #include "snes_pins.h"
@@ -26,6 +28,9 @@
 #include "experiments/menu_diag_experiment.h"
 #include "osd/fast_osd.h"
 #endif
+#if ENABLE_CAPTURE_BENCH
+#include "experiments/capture_bench.h"
+#endif
 
 #include <stdbool.h>
 #include <stdio.h>
@@ -34,35 +39,63 @@
 #define SYS_CLK_480P_KHZ 252000U
 #define SYS_CLK_720P_KHZ 372000U
 
-static const video_mode_t *video_output_mode_for_reboot_mode(video_pipeline_reboot_mode_t mode)
+// PAL: 27 MHz pixel clock for 576p. 720p50 keeps the 720p pixel clock.
+#define SYS_CLK_576P_KHZ 270000U
+
+#define REGION_PROBE_TIMEOUT_MS 200U
+
+// The resolution menu picks the scale (2x / direct / 3x); the console
+// region picks the 60 or 50 Hz mode of that scale. PAL has no direct mode
+// (see video_modes_50hz.h), so main never asks for 240p with a PAL region.
+static const video_mode_t *video_output_mode_for_reboot_mode(video_pipeline_reboot_mode_t mode, snes_region_t region)
 {
+    const bool pal = (region == SNES_REGION_PAL);
 #if ENABLE_REBOOT_MODE_SWITCH_720P
     if (mode == VIDEO_PIPELINE_REBOOT_MODE_720P) {
-        return &video_mode_720_p;
+        return pal ? &video_mode_720_p50 : &video_mode_720_p;
     }
 #else
     if (mode == VIDEO_PIPELINE_REBOOT_MODE_720P) {
         mode = VIDEO_PIPELINE_REBOOT_MODE_480P;
     }
 #endif
-    return (mode == VIDEO_PIPELINE_REBOOT_MODE_240P) ? &video_mode_240_p : &video_mode_480_p;
+    if (mode == VIDEO_PIPELINE_REBOOT_MODE_240P) {
+        return &video_mode_240_p;
+    }
+    return pal ? &video_mode_576_p : &video_mode_480_p;
 }
 
-static void configure_system_clock_for_mode(video_pipeline_reboot_mode_t mode)
+static void configure_system_clock_for_mode(video_pipeline_reboot_mode_t mode, snes_region_t region)
 {
+    const bool pal = (region == SNES_REGION_PAL);
     uint32_t sys_clk_khz = SYS_CLK_60HZ_KHZ;
     if (mode == VIDEO_PIPELINE_REBOOT_MODE_720P) {
         sys_clk_khz = SYS_CLK_720P_KHZ;
         vreg_set_voltage(VREG_VOLTAGE_1_30);
         sleep_ms(10);
     } else if (mode == VIDEO_PIPELINE_REBOOT_MODE_480P) {
-        sys_clk_khz = SYS_CLK_480P_KHZ;
+        sys_clk_khz = pal ? SYS_CLK_576P_KHZ : SYS_CLK_480P_KHZ;
         vreg_set_voltage(VREG_VOLTAGE_1_30);
         sleep_ms(10);
     }
     set_sys_clock_khz(sys_clk_khz, true);
 }
 
+// 480p (252 MHz sysclk) and 576p (270 MHz) need clk_hstx at sysclk / 2.
+// pico_hdmi applies PICO_HDMI_480P_HSTX_CLK_DIV only when it is handed its
+// own video_mode_480_p, and with the genlock it is handed the genlock's RAM
+// copy instead, so both modes are halved here, by the mode chosen rather than
+// the pointer pico_hdmi holds. Called before video_output_init(), so HSTX
+// never starts on the undivided clock.
+static void configure_hstx_clock_for_mode(const video_mode_t *mode)
+{
+    if (mode != &video_mode_480_p && mode != &video_mode_576_p) {
+        return;
+    }
+    const uint32_t sys_hz = clock_get_hz(clk_sys);
+    clock_configure(clk_hstx, 0, CLOCKS_CLK_HSTX_CTRL_AUXSRC_VALUE_CLK_SYS, sys_hz, sys_hz / 2U);
+}
+
 static void combined_background_task(void)
 {
 #if ENABLE_AUDIO
@@ -77,6 +110,16 @@ int main(void)
 {
     sleep_ms(1000);
 
+    // Region decides sysclk and output timing, so probe it before either.
+    const snes_region_t region = video_capture_detect_region(REGION_PROBE_TIMEOUT_MS);
+
+#if ENABLE_SETTINGS_FLASH
+    // Read once: the boot mode, the pipeline and the capture phase all come
+    // from this copy.
+    superpico_settings_t persisted;
+    settings_load(&persisted);
+#endif
+
 #if ENABLE_REBOOT_MODE_SWITCH
     video_pipeline_reboot_mode_t boot_mode = VIDEO_PIPELINE_REBOOT_MODE_480P;
     const bool warm_reboot = video_pipeline_take_reboot_mode_boot_request(&boot_mode);
@@ -88,8 +131,6 @@ int main(void)
 #endif
 #if ENABLE_SETTINGS_FLASH
     if (!warm_reboot) {
-        superpico_settings_t persisted;
-        settings_load(&persisted);
         if (persisted.resolution <= (uint8_t)VIDEO_PIPELINE_REBOOT_MODE_720P) {
             boot_mode = (video_pipeline_reboot_mode_t)persisted.resolution;
 #if !ENABLE_REBOOT_MODE_SWITCH_720P
@@ -103,9 +144,12 @@ int main(void)
 #else
     video_pipeline_reboot_mode_t boot_mode = VIDEO_PIPELINE_REBOOT_MODE_480P;
 #endif
+    if (region == SNES_REGION_PAL && boot_mode == VIDEO_PIPELINE_REBOOT_MODE_240P) {
+        boot_mode = VIDEO_PIPELINE_REBOOT_MODE_480P; // no 50 Hz direct mode: 576p
+    }
 
     video_pipeline_set_reboot_requested_mode(boot_mode);
-    configure_system_clock_for_mode(boot_mode);
+    configure_system_clock_for_mode(boot_mode, region);
     stdio_init_all();
 
     sleep_ms(500);
@@ -125,6 +169,7 @@ int main(void)
 #endif
 
     printf("\n\n=== SuperPico HDMI Mod ===\n");
+    printf("Source: %s\n", (region == SNES_REGION_PAL) ? "PAL 50 Hz" : "NTSC 60 Hz");
 
     printf("Init video pipeline...\n");
 
@@ -135,9 +180,26 @@ int main(void)
     menu_diag_experiment_init();
 #endif
     video_pipeline_init();
+    video_pipeline_set_region(region);
+#if ENABLE_SETTINGS_FLASH
+#if ENABLE_INTERLACE
+    video_pipeline_set_deinterlace((video_pipeline_deinterlace_t)persisted.deinterlace);
+#endif
+    video_pipeline_set_scaler((video_pipeline_scaler_t)persisted.scaler);
+    video_pipeline_set_latency((video_pipeline_latency_t)persisted.latency);
+#endif
 
     printf("Init HDMI output...\n");
-    video_output_set_mode(video_output_mode_for_reboot_mode(boot_mode));
+    const video_mode_t *output_mode = video_output_mode_for_reboot_mode(boot_mode, region);
+    // Scan out the genlock's copy of the mode, whose vertical total it trims
+    // per frame; the HSTX clock still goes by the mode itself. This relies on
+    // the RT backend reading v_total_lines/v_front_porch from the mode each
+    // frame and never comparing the mode pointer; the sim's backend does, but
+    // that is not yet checked against pico_hdmi's sources (not in this tree).
+    // If a sink or the backend misbehaves, ENABLE_GENLOCK 0 hands pico_hdmi
+    // its own mode again.
+    video_output_set_mode(genlock_init(output_mode));
+    configure_hstx_clock_for_mode(output_mode);
     video_output_init(FRAME_WIDTH, FRAME_HEIGHT);
     video_output_set_scanline_callback(scanline_callback);
     video_output_set_vsync_callback(vsync_callback);
@@ -151,7 +213,13 @@ int main(void)
 #endif
 
     printf("Init video capture...\n");
-    video_capture_init(SNES_V_ACTIVE);
+#if ENABLE_SETTINGS_FLASH
+    video_capture_set_phase(persisted.capture_skip, persisted.capture_sample_ns);
+#endif
+    video_capture_init(region);
+#if ENABLE_CAPTURE_BENCH
+    capture_bench_run();
+#endif
     sleep_ms(200);
     stdio_flush();
 
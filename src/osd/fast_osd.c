@@ -18,12 +18,22 @@
 #endif
 
 volatile bool osd_visible = false;
+
+#if ENABLE_INDEXED_OSD
+// Text grid: one NUL-terminated string per row. Scanout reads it directly.
+char fast_osd_text[FAST_OSD_ROWS][FAST_OSD_COLS + 1];
+// Foreground color per cell.
+uint16_t fast_osd_color[FAST_OSD_ROWS][FAST_OSD_COLS];
+// The font, out of flash: scanout reads a glyph row per cell.
+uint8_t fast_osd_font[128][8];
+#else
 uint16_t __attribute__((aligned(4))) osd_framebuffer[OSD_BOX_H][OSD_BOX_W];
 
 // Text grid: one NUL-terminated string per row.
 static char fast_osd_text[FAST_OSD_ROWS][FAST_OSD_COLS + 1];
 // Foreground color per cell.
 static uint16_t fast_osd_color[FAST_OSD_ROWS][FAST_OSD_COLS];
+#endif
 
 static inline bool fast_osd_in_bounds(uint8_t row, uint8_t col)
 {
@@ -42,6 +52,7 @@ static inline uint8_t fast_osd_normalize_char(char c)
     return ch;
 }
 
+#if !ENABLE_INDEXED_OSD
 static inline void fast_osd_render_cell(uint8_t row, uint8_t col, char c, uint16_t color)
 {
     if (!fast_osd_in_bounds(row, col)) {
@@ -66,15 +77,18 @@ static inline void fast_osd_render_cell(uint8_t row, uint8_t col, char c, uint16
         dst_row[7] = (bits & 0x01) ? color : OSD_COLOR_BG;
     }
 }
+#endif
 
 void FAST_OSD_RENDER_RAM(fast_osd_clear)(void)
 {
+#if !ENABLE_INDEXED_OSD
     uint32_t *dst32 = (uint32_t *)osd_framebuffer;
     const uint32_t bg32 = OSD_COLOR_BG | ((uint32_t)OSD_COLOR_BG << 16);
     const uint32_t words = (OSD_BOX_W * OSD_BOX_H) / 2;
     for (uint32_t i = 0; i < words; i++) {
         dst32[i] = bg32;
     }
+#endif
 
     for (uint8_t r = 0; r < FAST_OSD_ROWS; r++) {
         memset(fast_osd_text[r], ' ', FAST_OSD_COLS);
@@ -87,6 +101,9 @@ void FAST_OSD_RENDER_RAM(fast_osd_clear)(void)
 
 void fast_osd_init(void)
 {
+#if ENABLE_INDEXED_OSD
+    memcpy(fast_osd_font, font8x8, sizeof(fast_osd_font));
+#endif
     fast_osd_clear();
 }
 
@@ -108,7 +125,9 @@ void FAST_OSD_RENDER_RAM(fast_osd_putc_color)(uint8_t row, uint8_t col, char c,
 
     fast_osd_text[row][col] = norm;
     fast_osd_color[row][col] = color;
+#if !ENABLE_INDEXED_OSD
     fast_osd_render_cell(row, col, norm, color);
+#endif
 }
 
 void FAST_OSD_RENDER_RAM(fast_osd_puts)(uint8_t row, uint8_t col, const char *text)
@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "config.h"
+
 // OSD box dimensions (in 320x240 space, doubled at output)
 #define OSD_BOX_X 48  // Start X position
 #define OSD_BOX_Y 56  // Start Y position
@@ -24,7 +26,15 @@
 #define FAST_OSD_GLYPH_CROSS ((char)0x02)
 
 extern volatile bool osd_visible;
+#if ENABLE_INDEXED_OSD
+// Indexed OSD: no framebuffer. The scanline callback expands each cell's
+// glyph row from the text and colour grid and a RAM copy of the font.
+extern char fast_osd_text[FAST_OSD_ROWS][FAST_OSD_COLS + 1];
+extern uint16_t fast_osd_color[FAST_OSD_ROWS][FAST_OSD_COLS];
+extern uint8_t fast_osd_font[128][8];
+#else
 extern uint16_t osd_framebuffer[OSD_BOX_H][OSD_BOX_W];
+#endif
 
 static inline void osd_show(void)
 {
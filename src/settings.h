@@ -5,10 +5,16 @@
 #include <stdint.h>
 
 // Flash-backed persistent settings. Stored in the last 4 KB flash sector as a
-// magic+version+CRC record and written only during resolution-change reboot.
+// magic+version+CRC record and written on a resolution-change reboot or when
+// an OSD setting is applied.
 typedef struct {
     uint8_t resolution;   // video_pipeline_reboot_mode_t: 0=480p, 1=240p, 2=720p
-    uint8_t reserved[31]; // future settings
+    uint8_t deinterlace;  // video_pipeline_deinterlace_t: 0=weave, 1=bob
+    uint8_t capture_skip; // video_capture_set_phase: 0 = default
+    uint8_t capture_sample_ns;
+    uint8_t scaler;       // video_pipeline_scaler_t: 720p picture size
+    uint8_t latency;      // video_pipeline_latency_t: 0=line ring, 1=whole frames, 2=race the beam
+    uint8_t reserved[26]; // future settings
 } superpico_settings_t;
 
 bool settings_load(superpico_settings_t *out);
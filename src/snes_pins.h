@@ -11,11 +11,11 @@
 #define SNES_PINS_H
 
 // =============================================================================
-// SNES Video Input Pins - GP27-44 CONTIGUOUS LAYOUT
+// SNES Video Input Pins - GP27-45 CONTIGUOUS LAYOUT
 // =============================================================================
-// Captures RGB555 + VBLANK + HBLANK from the SNES PPU.
+// Captures RGB555 + VBLANK + HBLANK + PIXEL_VALID from the SNES PPU / QSB.
 //
-// 18-pin capture window: GP27 (LSB) through GP44 (MSB).
+// 19-pin capture window: GP27 (LSB) through GP45 (MSB).
 //
 // Pin mapping (LSB to MSB in captured word):
 //   Bit 0:      GP27 (VBLANK) - PPU2 Pin 26
@@ -24,13 +24,16 @@
 //   Bits 7-11:  GP34-38 (Green G4-G0, contiguous)
 //   Bits 12-16: GP39-43 (Red R4-R0, contiguous)
 //   Bit 17:     GP44 (HBLANK) - PPU2 Pin 25
+//   Bit 18:     GP45 (PIXEL_VALID) - QSB: /OVER (PPU1 p94) AND /TRANSPARENT (PPU2 p4)
 //
 // With PIO GPIOBASE=16, pin index N = GP(N+16). So IN_BASE=11 → GP27.
+// ENABLE_PACKED_CAPTURE shifts in only GP29-43 (IN_BASE=13) and stores two
+// 16-bit samples per FIFO word; see video_capture.pio.
 
 // Sync / blanking
 #define PIN_SNES_VBLANK 27 // Vertical blanking   - Bit 0  (PPU2 Pin 26)
 #define PIN_SNES_PCLK   28 // Pixel clock (~5.37 MHz, Bit 1, PPU2 Pin 27)
-#define PIN_SNES_BASE   27 // Base pin - capture GP27-44 (18 pins)
+#define PIN_SNES_BASE   27 // Base pin - capture GP27-45 (19 pins)
 
 // Blue channel (B4-B0) - CONTIGUOUS at bits 2-6
 #define PIN_SNES_B4 29
@@ -56,8 +59,39 @@
 // Blanking
 #define PIN_SNES_HBLANK 44 // Horizontal blanking - Bit 17 (PPU2 Pin 25)
 
-#define SNES_CAPTURE_PIN_LAST PIN_SNES_HBLANK
-#define SNES_CAPTURE_BITS     18
+// Pixel validity - high for a real pixel, low for Mode 7 /OVER, transparent
+// (TOUMEI) and sync/burst. Also the snes_hard_sync JMP_PIN.
+#define PIN_SNES_PIXEL_VALID 45 // Bit 18 (QSB AND gate)
+
+#define SNES_CAPTURE_PIN_LAST PIN_SNES_PIXEL_VALID
+#define SNES_CAPTURE_BITS     19
+
+// =============================================================================
+// Master Brightness ($2100 INIDISP) - GP8-11
+// =============================================================================
+// The QSB latches D[3:0] on every $2100 write, so these always hold the last
+// brightness the CPU set. Read once per line; 0 = black, 15 = full.
+#define PIN_SNES_BRIGHT0 8  // Brightness[0] (LSB)
+#define PIN_SNES_BRIGHT1 9  // Brightness[1]
+#define PIN_SNES_BRIGHT2 10 // Brightness[2]
+#define PIN_SNES_BRIGHT3 11 // Brightness[3] (MSB)
+
+#define PIN_SNES_BRIGHT_BASE PIN_SNES_BRIGHT0
+#define SNES_BRIGHTNESS_MAX  15
+
+// =============================================================================
+// Interlace Field - GP20 (optional, ENABLE_FIELD_PIN)
+// =============================================================================
+// PPU2 Pin 36 / PPU1 Pin 95, high during the odd field. Without it the field
+// is inferred from the 263/262-line VBLANK period.
+#define PIN_SNES_FIELD 20
+
+// =============================================================================
+// Region - GP21 (optional, ENABLE_PALMODE_PIN)
+// =============================================================================
+// PPU2 Pin 30, high on PAL (50 Hz) consoles. Without it the region is
+// inferred from the VBLANK period (262 vs 312 lines).
+#define PIN_SNES_PALMODE 21
 
 // =============================================================================
 // Frequency Counter Pin Aliases (for debug tools)
@@ -0,0 +1,241 @@
+#include "genlock.h"
+#include "snes_timing.h"
+#include "video_capture.h"
+#include "pico/stdlib.h"
+#include <string.h>
+
+// =============================================================================
+// Output Genlock
+// =============================================================================
+// The HDMI modes run at their CEA rates (480p/720p at 60.000 Hz, 576p at
+// 50.000 Hz) while a console runs at 60.099 Hz NTSC or 50.007 Hz PAL, so an
+// untrimmed output slips one source frame every ~10 s at 60 Hz: low latency
+// skips a frame there, the frame buffer drops one.
+//
+// The genlock closes the gap in the vertical blank. Each output vsync it
+// takes the SNES frame period capture measured and the phase of this vsync
+// to the latest SNES top of frame, and sets the next frame's length to the
+// period less 1/16 of the phase error. Frames are whole lines (31.7 us at
+// 480p), so the remainder carries to the next frame and the total dithers
+// between neighbours - 524 and 525 lines for 480p from NTSC - while the
+// phase holds within about a line of the target. The lines come out of or go
+// into the front porch, at most GENLOCK_MAX_TRIM_LINES per frame and never
+// the porch's last line. The pixel clock stays put: clk_hstx comes from
+// clk_sys, which also times capture's PIO sampling.
+//
+// The default target puts the output vsync on the SNES top of frame. Low
+// latency's late latch then lands 10-30 SNES lines into the frame it shows,
+// and the frame buffer latches the frame finished ~2 ms earlier; both far
+// from where they would switch frames. Racing the beam (video_pipeline.c)
+// moves the target to just past the late latch instead. Without a measured
+// period (no signal, or the first 64 frames) the output runs at the mode's
+// own total.
+//
+// Pulling in never sweeps the vsync up through the vertical blank before a
+// SNES top of frame. There the late latch just misses the new frame, and at
+// 720p, which reads a 239-line frame slower than capture writes the next,
+// the writer laps the reader (line_ring_catch_up's tear) on every frame the
+// pull-in spends there. The error is wrapped so the blank is the cut: a
+// vsync inside it pulls back down, the long way round. A moved target
+// brings its own cut.
+
+#if ENABLE_GENLOCK
+
+#define GENLOCK_GAIN_SHIFT 4       // correct 1/16 of the phase error per frame
+#define GENLOCK_LOCK_SNES_LINES 2U // locked within two SNES lines of the target...
+#define GENLOCK_LOCK_FRAMES 32U    // ...for this many frames in a row; lost past twice that
+#define GENLOCK_WINDOW_FRAMES 64U
+
+#define PS_PER_US 1000000LL
+
+static video_mode_t s_mode; // the mode scanned out, trimmed every frame
+static uint32_t s_nominal_total;
+static uint32_t s_nominal_porch;
+static int32_t s_trim_min;
+static int32_t s_target_us; // vsync after the SNES top of frame
+static int32_t s_cut_us;    // error wrap cut, this far before the target
+static int32_t s_phase_us;  // latest phase, wrapped as the error is
+static int64_t s_line_ps;
+static int64_t s_carry_ps; // frame length not yet given out as whole lines
+static uint32_t s_in_band_frames;
+static bool s_locked;
+
+// Steady-state window, gathered while locked.
+static uint32_t s_window_frames;
+static int32_t s_window_phase_sum;
+static int32_t s_window_phase_min;
+static int32_t s_window_phase_max;
+static int32_t s_window_trim_sum;
+
+static genlock_status_t s_status;
+
+static int32_t __not_in_flash_func(genlock_blank_us)(void)
+{
+    return (int32_t)(((int64_t)(s_nominal_total - s_mode.v_active_lines) * s_line_ps) / PS_PER_US);
+}
+
+const video_mode_t *genlock_init(const video_mode_t *mode)
+{
+    s_mode = *mode;
+    s_nominal_total = mode->v_total_lines;
+    s_nominal_porch = mode->v_front_porch;
+    // A mode given only as totals has its whole vertical blank as porch.
+    const uint32_t porch = s_nominal_porch ? s_nominal_porch : (mode->v_total_lines - mode->v_active_lines);
+    s_trim_min = -(int32_t)(((porch - 1U) < GENLOCK_MAX_TRIM_LINES) ? (porch - 1U) : GENLOCK_MAX_TRIM_LINES);
+    s_line_ps = ((int64_t)mode->h_total_pixels * PS_PER_US * 1000000LL) / (int64_t)mode->pixel_clock_hz;
+    s_target_us = 0;
+    s_cut_us = genlock_blank_us();
+    memset(&s_status, 0, sizeof(s_status));
+    return &s_mode;
+}
+
+static void genlock_set_trim(int32_t trim)
+{
+    s_mode.v_total_lines = (uint32_t)((int32_t)s_nominal_total + trim);
+    if (s_nominal_porch != 0U) {
+        s_mode.v_front_porch = (uint32_t)((int32_t)s_nominal_porch + trim);
+    }
+}
+
+// Freewheel at the mode's own total until there is a period to follow.
+static void genlock_release(void)
+{
+    genlock_set_trim(0);
+    s_carry_ps = 0;
+    s_in_band_frames = 0;
+    s_locked = false;
+    s_window_frames = 0;
+    s_status.locked = false;
+    s_status.jitter_us = 0;
+    s_status.trim_q8 = 0;
+}
+
+static void genlock_window_add(int32_t phase_us, int32_t trim)
+{
+    if (s_window_frames == 0U) {
+        s_window_phase_sum = 0;
+        s_window_phase_min = phase_us;
+        s_window_phase_max = phase_us;
+        s_window_trim_sum = 0;
+    }
+    s_window_phase_sum += phase_us;
+    if (phase_us < s_window_phase_min) {
+        s_window_phase_min = phase_us;
+    }
+    if (phase_us > s_window_phase_max) {
+        s_window_phase_max = phase_us;
+    }
+    s_window_trim_sum += trim;
+    if (++s_window_frames < GENLOCK_WINDOW_FRAMES) {
+        return;
+    }
+    s_window_frames = 0;
+    s_status.phase_us = s_window_phase_sum / (int32_t)GENLOCK_WINDOW_FRAMES;
+    s_status.jitter_us = (uint32_t)(s_window_phase_max - s_window_phase_min);
+    s_status.trim_q8 = (s_window_trim_sum * 256) / (int32_t)GENLOCK_WINDOW_FRAMES;
+}
+
+void __not_in_flash_func(genlock_vsync)(void)
+{
+    const uint32_t now_us = time_us_32();
+    const uint32_t period_q8 = video_capture_get_frame_period_q8();
+    s_status.period_q8 = period_q8;
+    if (period_q8 == 0U || !video_capture_has_signal()) {
+        genlock_release();
+        return;
+    }
+
+    // Phase error to the target, wrapped into one period from a blank before.
+    const int32_t period_us = (int32_t)(period_q8 >> 8);
+    const int32_t phase_us = (int32_t)(now_us - video_capture_get_frame_edge_us());
+    int32_t error_us = phase_us - s_target_us;
+    while (error_us >= period_us - s_cut_us) {
+        error_us -= period_us;
+    }
+    while (error_us < -s_cut_us) {
+        error_us += period_us;
+    }
+    s_phase_us = s_target_us + error_us;
+
+    // Next frame: the SNES period, less a share of the error, in whole lines.
+    const int64_t period_ps = ((int64_t)period_q8 * PS_PER_US) >> 8;
+    s_carry_ps += period_ps - (((int64_t)error_us * PS_PER_US) >> GENLOCK_GAIN_SHIFT);
+    const int64_t lines = s_carry_ps / s_line_ps;
+    int32_t trim = (int32_t)lines - (int32_t)s_nominal_total;
+    if (trim > (int32_t)GENLOCK_MAX_TRIM_LINES || trim < s_trim_min) {
+        trim = (trim < s_trim_min) ? s_trim_min : (int32_t)GENLOCK_MAX_TRIM_LINES;
+        s_carry_ps = 0;
+    } else {
+        s_carry_ps -= lines * s_line_ps;
+    }
+    genlock_set_trim(trim);
+
+    const int32_t band_us =
+        (int32_t)((GENLOCK_LOCK_SNES_LINES * SNES_REGION_LINE_NS(video_capture_get_region())) / 1000U);
+    const int32_t distance_us = (error_us < 0) ? -error_us : error_us;
+    if (distance_us > band_us) {
+        s_in_band_frames = 0;
+    } else if (s_in_band_frames < GENLOCK_LOCK_FRAMES) {
+        s_in_band_frames++;
+    }
+    if (!s_locked && s_in_band_frames >= GENLOCK_LOCK_FRAMES) {
+        s_locked = true;
+        s_status.locks++;
+        s_window_frames = 0;
+    } else if (s_locked && distance_us > 2 * band_us) {
+        s_locked = false;
+    }
+    s_status.locked = s_locked;
+    if (s_locked) {
+        genlock_window_add(s_phase_us, trim);
+    } else {
+        s_status.phase_us = s_phase_us;
+        s_status.jitter_us = 0;
+        s_status.trim_q8 = 0;
+    }
+}
+
+void __not_in_flash_func(genlock_set_target_us)(int32_t target_us, int32_t cut_us)
+{
+    s_target_us = target_us;
+    s_cut_us = (cut_us < 0) ? genlock_blank_us() : cut_us;
+}
+
+int32_t __not_in_flash_func(genlock_get_phase_us)(void)
+{
+    return s_phase_us;
+}
+
+void genlock_get_status(genlock_status_t *out)
+{
+    *out = s_status;
+}
+
+#else
+
+const video_mode_t *genlock_init(const video_mode_t *mode)
+{
+    return mode;
+}
+
+void genlock_vsync(void)
+{
+}
+
+void genlock_set_target_us(int32_t target_us, int32_t cut_us)
+{
+    (void)target_us;
+    (void)cut_us;
+}
+
+int32_t genlock_get_phase_us(void)
+{
+    return 0;
+}
+
+void genlock_get_status(genlock_status_t *out)
+{
+    memset(out, 0, sizeof(*out));
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef GENLOCK_H
+#define GENLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+#include "pico_hdmi/video_output_rt.h"
+
+// Output genlock (ENABLE_GENLOCK): once per output frame the vertical total
+// of the next frame is trimmed by a few lines, so HDMI frames follow SNES
+// frames one to one and the output vsync holds a fixed phase to the SNES top
+// of frame.
+
+// Copy of `mode` whose vertical total (and front porch) the genlock trims;
+// hand it to video_output_set_mode in place of `mode`. Without
+// ENABLE_GENLOCK, `mode` itself.
+const video_mode_t *genlock_init(const video_mode_t *mode);
+
+// Core 1, from the vsync callback: measure the phase and set the length of
+// the next frame.
+void genlock_vsync(void);
+
+// Core 1: where the vsync should sit after the SNES top of frame (0 by
+// default), and how far before it the phase error wraps, which is the one
+// phase pulling in never sweeps through (negative: the vertical blank).
+void genlock_set_target_us(int32_t target_us, int32_t cut_us);
+
+// Core 1: the phase measured at the latest vsync, wrapped into the period
+// from the cut.
+int32_t genlock_get_phase_us(void);
+
+typedef struct {
+    bool locked;        // phase within two SNES lines of the target
+    uint32_t locks;     // times lock was gained since boot
+    uint32_t period_q8; // SNES frame period, 1/256 us (0: not measured yet)
+    int32_t phase_us;   // output vsync after the SNES top of frame
+    uint32_t jitter_us; // peak-to-peak phase
+    int32_t trim_q8;    // lines added to the vertical total per frame, 1/256 line
+} genlock_status_t;
+
+// Phase, jitter and trim are over the last 64 locked frames (the steady
+// state); while unlocked, the phase is the latest and the rest zero.
+void genlock_get_status(genlock_status_t *out);
+
+#endif // GENLOCK_H
@@ -0,0 +1,63 @@
+# Reports the line ring's depth and SRAM (config.h) in the configure output,
+# with what a LINE_RING_SIZE below 256 frees, and leaves the bytes in
+# SUPERPICO_LINE_RING_BYTES for the SRAM budget. Editing config.h re-runs it.
+# The SRAM is the whole g_line_ring: pixel storage (or the indexed arena),
+# per-line widths (or descriptors), and commit stamps, as line_ring.h sizes
+# them.
+function(superpico_line_ring_bytes OUT_VAR LINES UNITS INDEXED STAMPED LINE_BYTES)
+    if(INDEXED)
+        # Arena, 8-byte descriptors and 4-byte stamps, two of each per line.
+        math(EXPR descriptors "${LINES} * 2")
+        math(EXPR bytes "${descriptors} * ${LINE_BYTES} + ${descriptors} * 8 + ${descriptors} * 4")
+    else()
+        # 256-px RGB565 units with a 2-byte width each, plus 4-byte stamps.
+        math(EXPR unit_count "${LINES} * ${UNITS}")
+        math(EXPR bytes "${unit_count} * 256 * 2 + ${unit_count} * 2")
+        if(STAMPED)
+            math(EXPR bytes "${bytes} + ${unit_count} * 4")
+        endif()
+    endif()
+    set(${OUT_VAR} ${bytes} PARENT_SCOPE)
+endfunction()
+
+function(superpico_report_line_ring CONFIG_H)
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${CONFIG_H})
+    file(STRINGS ${CONFIG_H} ring_define REGEX "^#define LINE_RING_SIZE +[0-9]+")
+    string(REGEX MATCH "LINE_RING_SIZE +([0-9]+)" ring_define "${ring_define}")
+    set(ring_lines ${CMAKE_MATCH_1})
+    if(NOT ring_lines)
+        set(ring_lines 256)
+    endif()
+    # Hires and interlace builds allocate two 256-px units per ring line.
+    file(STRINGS ${CONFIG_H} wide_defines REGEX "^#define ENABLE_(HIRES|INTERLACE) +1")
+    if(wide_defines)
+        set(units 2)
+    else()
+        set(units 1)
+    endif()
+    file(STRINGS ${CONFIG_H} indexed_define REGEX "^#define ENABLE_INDEXED_LINES +1")
+    file(STRINGS ${CONFIG_H} raw_define REGEX "^#define ENABLE_RAW_CAPTURE_RING +1")
+    if(raw_define)
+        set(stamped OFF)
+    else()
+        set(stamped ON)
+    endif()
+    file(STRINGS ${CONFIG_H} line_bytes_define REGEX "^#define LINE_RING_INDEXED_LINE_BYTES +[0-9]+")
+    string(REGEX MATCH "LINE_RING_INDEXED_LINE_BYTES +([0-9]+)" line_bytes_define "${line_bytes_define}")
+    set(line_bytes ${CMAKE_MATCH_1})
+    if(NOT line_bytes)
+        set(line_bytes 320)
+    endif()
+    if(indexed_define)
+        set(layout "indexed arena")
+        set(indexed ON)
+    else()
+        set(layout "RGB565")
+        set(indexed OFF)
+    endif()
+    superpico_line_ring_bytes(ring_bytes ${ring_lines} ${units} ${indexed} ${stamped} ${line_bytes})
+    superpico_line_ring_bytes(full_bytes 256 ${units} ${indexed} ${stamped} ${line_bytes})
+    math(EXPR freed_bytes "${full_bytes} - ${ring_bytes}")
+    message(STATUS "Line ring: ${ring_lines} lines, ${layout}, ${ring_bytes} bytes of SRAM (${freed_bytes} freed against 256 lines)")
+    set(SUPERPICO_LINE_RING_BYTES ${ring_bytes} PARENT_SCOPE)
+endfunction()
@@ -1,61 +1,608 @@
 #ifndef LINE_RING_H
 #define LINE_RING_H
 
+#include "config.h"
 #include "hardware/sync.h"
+#include "snes_timing.h"
 #include "video_config.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 
-// 256 lines = 128KB. Full frame buffer for SNES.
-// This is the most stable approach and fits easily in RP2350 RAM.
+#ifndef ENABLE_HIRES
+#define ENABLE_HIRES 0
+#endif
+#ifndef ENABLE_INTERLACE
+#define ENABLE_INTERLACE 0
+#endif
+#ifndef ENABLE_RAW_CAPTURE_RING
+#define ENABLE_RAW_CAPTURE_RING 0
+#endif
+#ifndef ENABLE_INDEXED_LINES
+#define ENABLE_INDEXED_LINES 0
+#endif
+
+// Depth in lines (config.h). 256 lines hold a whole frame: about 130KB of
+// RGB565, or 259KB with ENABLE_HIRES or ENABLE_INTERLACE (two units a line).
+// The reader only trails the writer by a few lines once the late latch has
+// settled, so shallower rings work where output and capture stay in phase.
+// Status (RING) and the host sim count the lines a depth loses.
+#ifndef LINE_RING_SIZE
 #define LINE_RING_SIZE 256
+#endif
 #define LINE_WIDTH VIDEO_WIDTH
 
+_Static_assert(LINE_RING_SIZE >= 32 && LINE_RING_SIZE <= 256 &&
+                   (LINE_RING_SIZE & (LINE_RING_SIZE - 1)) == 0,
+               "LINE_RING_SIZE is a power of two from 32 to 256");
+// The raw ring streams each frame with one DMA pair, which wraps once.
+_Static_assert(!ENABLE_RAW_CAPTURE_RING || LINE_RING_SIZE == 256,
+               "the raw capture ring needs a whole frame of ring");
+
+// Storage is a run of 256-pixel units. Progressive hires frames use two units
+// per line (512 px); interlaced frames use one, which turns the same storage
+// into a ring of twice the lines: at 256, both 224-line fields of a 448i
+// frame plus slack (weave needs that; shallower rings fall back to bob).
+// Every line carries its width, so lores lines still cost Core 0 and Core 1
+// only 256 pixels of work.
+#if ENABLE_HIRES || ENABLE_INTERLACE
+#define LINE_RING_UNITS (LINE_RING_SIZE * 2)
+#else
+#define LINE_RING_UNITS LINE_RING_SIZE
+#endif
+#define LINE_RING_PIXELS (LINE_RING_UNITS * LINE_WIDTH)
+
+#if ENABLE_HIRES
+#define LINE_RING_PROGRESSIVE_UNITS 2U
+#else
+#define LINE_RING_PROGRESSIVE_UNITS 1U
+#endif
+
+// Raw capture ring: Core 0 only arms a frame-long DMA that streams packed
+// capture samples straight into the ring, and Core 1 converts each line as
+// it scans it out. Every line then takes the capture width, interlaced
+// fields included, and how far the DMA has got is the write position.
+#if ENABLE_RAW_CAPTURE_RING
+#define LINE_RING_INTERLACED_UNITS LINE_RING_PROGRESSIVE_UNITS
+#else
+#define LINE_RING_INTERLACED_UNITS 1U
+#endif
+#define LINE_RING_RAW_LINE_BYTES (LINE_RING_PROGRESSIVE_UNITS * LINE_WIDTH * 2U)
+
+// Per-frame flags passed to line_ring_vsync().
+#define LINE_RING_FIELD_ODD 0x01U   // this field holds the odd lines of 448i
+#define LINE_RING_INTERLACED 0x02U  // source is sending alternating fields
+#define LINE_RING_NO_SIGNAL 0x04U   // capture lost the SNES: an empty frame
+// Raw capture ring only: $2100 brightness sampled at the top of the frame,
+// applied by Core 1 when it converts the frame's lines.
+#define LINE_RING_BRIGHTNESS_SHIFT 4U
+#define LINE_RING_BRIGHTNESS_MASK (0xFU << LINE_RING_BRIGHTNESS_SHIFT)
+
+_Static_assert((LINE_RING_UNITS & (LINE_RING_UNITS - 1)) == 0,
+               "line ring units wrap with a power-of-two mask");
+
+// Frame-buffered scanout: Core 1 only ever latches a frame Core 0 has
+// finished, and keeps it for the whole output frame while Core 0 writes the
+// next one behind it. Frames then use one unit per line (hires lines are
+// averaged to 256 px, 448i is shown as bob), so the ring holds two whole
+// frames: the one on screen and the one being captured. Needs the full
+// 256-line ring with hires or interlace storage, and not the raw ring,
+// whose DMA streams each frame at capture width. The indexed store instead
+// needs room for two frames at its budgeted bytes per line.
+#define LINE_RING_FRAME_LINES ((2U * SNES_V_ACTIVE_OVERSCAN) + 2U)
+
+// Indexed line store (ENABLE_INDEXED_LINES): the pixel storage is replaced
+// by a byte arena that Core 0 appends lines to, each either 8-bit indices
+// followed by the line's palette or, when that would not be smaller (a lores
+// line over 127 colours, or a hires line over 255), plain RGB565. A line
+// never wraps around the end of the arena. Per-line descriptors replace the
+// unit mapping, two per ring line: at 256, two whole frames or both fields
+// of 448i plus slack. The arena is sized on its own, as a budget of
+// LINE_RING_INDEXED_LINE_BYTES per descriptor (160 KB at 256 lines, against
+// 256 KB of RGB565 hires storage); 320 covers the 312 bytes per line the
+// host sim's test pattern averages. Arena positions run through a
+// power-of-two span, and the span's tail past the arena is skipped like the
+// end of the arena a line does not fit in. A line is lapped once either its
+// descriptor or its bytes are about to be reused, so frames over budget lose
+// their oldest lines under frame buffering (Status RING counts them).
+#if ENABLE_INDEXED_LINES
+_Static_assert(!ENABLE_RAW_CAPTURE_RING,
+               "the raw capture ring stores raw samples, not indexed lines");
+#ifndef LINE_RING_INDEXED_LINE_BYTES
+#define LINE_RING_INDEXED_LINE_BYTES 320U
+#endif
+#define LINE_RING_LINES (LINE_RING_SIZE * 2U)
+#define LINE_RING_ARENA_BYTES (LINE_RING_LINES * LINE_RING_INDEXED_LINE_BYTES)
+#define LINE_RING_ARENA_SPAN (LINE_RING_SIZE * 1024U)
+#define LINE_RING_MAX_LINE_BYTES (SNES_H_ACTIVE_HIRES * 2U)
+_Static_assert(LINE_RING_INDEXED_LINE_BYTES >= LINE_WIDTH + 4U &&
+                   LINE_RING_INDEXED_LINE_BYTES <= LINE_WIDTH * 2U &&
+                   (LINE_RING_INDEXED_LINE_BYTES & 3U) == 0,
+               "LINE_RING_INDEXED_LINE_BYTES is a word multiple from 260 "
+               "(indices and one colour) to 512 (an RGB565 lores line)");
+
+typedef struct {
+  uint32_t offset; // arena position of the line's first byte (unmasked)
+  uint16_t width;  // pixels
+  uint16_t colors; // palette entries after the indices; 0 for RGB565
+} line_ring_line_t;
+
+#define LINE_RING_FRAME_BUFFERS                                                \
+  (LINE_RING_LINES >= LINE_RING_FRAME_LINES &&                                 \
+   LINE_RING_ARENA_BYTES >=                                                    \
+       (LINE_RING_FRAME_LINES * LINE_RING_INDEXED_LINE_BYTES) +                \
+           (2U * LINE_RING_MAX_LINE_BYTES))
+#else
+#define LINE_RING_FRAME_BUFFERS                                                \
+  (!ENABLE_RAW_CAPTURE_RING && LINE_RING_UNITS >= LINE_RING_FRAME_LINES)
+#endif
+
+// Commit time of every line (time_us_32), per line slot, for the
+// capture-to-scanout latency Core 1 measures. The raw ring has no per-line
+// commit to stamp.
+#if !ENABLE_RAW_CAPTURE_RING
+#if ENABLE_INDEXED_LINES
+#define LINE_RING_STAMPS LINE_RING_LINES
+#else
+#define LINE_RING_STAMPS LINE_RING_UNITS
+#endif
+#endif
+
 typedef struct {
-  uint16_t lines[LINE_RING_SIZE][LINE_WIDTH];
+#if ENABLE_INDEXED_LINES
+  uint8_t arena[LINE_RING_ARENA_BYTES] __attribute__((aligned(4)));
+  line_ring_line_t lines[LINE_RING_LINES];
+  volatile uint32_t arena_pos; // end of the newest line, unmasked
+#else
+  uint16_t pixels[LINE_RING_PIXELS];
+  uint16_t widths[LINE_RING_UNITS];
+#endif
   volatile uint32_t write_idx;
   volatile uint32_t frame_base_idx;
+  volatile uint32_t prev_frame_base_idx;
+  volatile uint32_t frame_flags;
+  volatile uint32_t frame_lines;
+  volatile uint32_t frame_end_idx;
+  volatile uint32_t units_per_line;
   volatile uint32_t read_frame_start;
+  volatile uint32_t read_prev_frame_start;
+  volatile uint32_t read_frame_flags;
+  volatile uint32_t read_frame_lines;
+  // Scanout misses, counted by Core 1 (output lines).
+  volatile uint32_t read_overruns;  // Core 0 had already reused the slot
+  volatile uint32_t read_not_ready; // Core 0 had not written the line yet
+  // Frame buffering. Core 0 publishes each frame it finishes under done_seq;
+  // Core 1 scans out whole frames while frame_buffered is set (it also
+  // tells Core 0 which geometry to store) and counts what that costs.
+  volatile uint32_t frame_buffered;
+  volatile uint32_t done_seq;
+  volatile uint32_t done_base_idx;
+  volatile uint32_t done_end_idx;
+  volatile uint32_t done_flags;
+  volatile uint32_t done_lines;
+  volatile uint32_t read_done_seq;
+  volatile uint32_t read_frame_end;
+  volatile uint32_t frames_dropped;  // finished but never scanned out
+  volatile uint32_t frames_repeated; // output frames that showed one again
+#if !ENABLE_RAW_CAPTURE_RING
+  volatile uint32_t commit_us[LINE_RING_STAMPS];
+#endif
+#if ENABLE_RAW_CAPTURE_RING
+  // Streaming DMA state, published by Core 0 under raw_seq (odd while it
+  // re-arms). Channel A starts at the frame's first line and, when the frame
+  // wraps, chains to channel B at the start of the buffer.
+  volatile uint32_t raw_seq;
+  const volatile uint32_t *raw_write_addr[2]; // the channels' WRITE_ADDR
+  volatile uint32_t raw_start[2];             // where each channel started
+  volatile uint32_t raw_a_bytes;              // channel A's share of the frame
+#endif
 } line_ring_t;
 
 extern line_ring_t g_line_ring;
 
-static inline void line_ring_vsync(void) {
+// Line index -> first unit. Any (index, units) pair lands inside the buffer,
+// so a reader racing a geometry change sees stale pixels, never a wild
+// pointer.
+static inline uint32_t line_ring_unit(uint32_t idx) {
+  return (idx * g_line_ring.units_per_line) & (LINE_RING_UNITS - 1U);
+}
+
+static inline uint32_t line_ring_capacity(void) {
+#if ENABLE_INDEXED_LINES
+  return LINE_RING_LINES;
+#else
+  return LINE_RING_UNITS / g_line_ring.units_per_line;
+#endif
+}
+
+#if ENABLE_INDEXED_LINES
+static inline line_ring_line_t *line_ring_line(uint32_t idx) {
+  return &g_line_ring.lines[idx & (LINE_RING_LINES - 1U)];
+}
+
+static inline uint8_t *line_ring_line_data(const line_ring_line_t *l) {
+  return &g_line_ring.arena[l->offset & (LINE_RING_ARENA_SPAN - 1U)];
+}
+#endif
+
+static inline void line_ring_init(void) {
+  memset(&g_line_ring, 0, sizeof(g_line_ring));
+  g_line_ring.units_per_line = LINE_RING_PROGRESSIVE_UNITS;
+  g_line_ring.frame_lines = SNES_V_ACTIVE;
+  g_line_ring.read_frame_lines = SNES_V_ACTIVE;
+#if ENABLE_RAW_CAPTURE_RING
+  g_line_ring.raw_seq = 1U; // nothing streaming until Core 0 arms a frame
+#endif
+}
+
+// A finished frame, for frame-buffered scanout: lines [base, end) as
+// committed, with the flags and height it was captured with.
+static inline void line_ring_publish_done(uint32_t base, uint32_t end) {
+  g_line_ring.done_base_idx = base;
+  g_line_ring.done_end_idx = end;
+  g_line_ring.done_flags = g_line_ring.frame_flags;
+  g_line_ring.done_lines = g_line_ring.frame_lines;
+  __dmb();
+  g_line_ring.done_seq++;
+}
+
+static inline void line_ring_vsync(uint32_t flags) {
+  const uint32_t units = ((flags & LINE_RING_INTERLACED) ||
+                          (LINE_RING_FRAME_BUFFERS && g_line_ring.frame_buffered))
+                             ? LINE_RING_INTERLACED_UNITS
+                             : LINE_RING_PROGRESSIVE_UNITS;
+  if (units != g_line_ring.units_per_line) {
+    // Geometry change: jump the indices two rings ahead so everything the
+    // reader still holds reads as lapped (not ready) until its next vsync.
+    const uint32_t fresh = g_line_ring.write_idx + (2U * line_ring_capacity());
+    g_line_ring.units_per_line = units;
+    g_line_ring.write_idx = fresh;
+    g_line_ring.prev_frame_base_idx = fresh;
+  } else {
+    g_line_ring.prev_frame_base_idx = g_line_ring.frame_base_idx;
+  }
+  g_line_ring.frame_flags = flags;
+  __dmb();
   g_line_ring.frame_base_idx = g_line_ring.write_idx;
   __dmb();
+  g_line_ring.frame_end_idx = g_line_ring.frame_base_idx + SNES_V_ACTIVE_OVERSCAN;
+  // An empty no-signal frame is finished as soon as it opens.
+  if (flags & LINE_RING_NO_SIGNAL)
+    line_ring_publish_done(g_line_ring.frame_base_idx,
+                           g_line_ring.frame_base_idx);
 }
 
+// Active height of the source (224, or 239 with overscan), published by Core
+// 0 as soon as a frame's line count says it changed. The reader latches it
+// with the frame it scans out (line_ring_read_lines) to place the picture.
+static inline void line_ring_set_lines(uint32_t lines) {
+  g_line_ring.frame_lines = lines;
+}
+
+#if !ENABLE_INDEXED_LINES
 static inline uint16_t *line_ring_write_ptr(uint16_t line) {
   uint32_t idx = g_line_ring.frame_base_idx + line;
-  return g_line_ring.lines[idx % LINE_RING_SIZE];
+  return &g_line_ring.pixels[line_ring_unit(idx) * LINE_WIDTH];
+}
+#endif
+
+// Widest line the current geometry can store.
+static inline uint16_t line_ring_max_width(void) {
+  return (uint16_t)(g_line_ring.units_per_line * LINE_WIDTH);
+}
+
+#if ENABLE_INDEXED_LINES
+// Reserve `bytes` for a line (indices and palette, or RGB565) and describe
+// it; fill the returned space, then commit. The arena position moves first,
+// so a reader sees the space as reused before it is written.
+static inline uint8_t *line_ring_alloc_line(uint16_t line, uint32_t bytes,
+                                            uint16_t width, uint16_t colors) {
+  uint32_t pos = g_line_ring.arena_pos;
+  const uint32_t at = pos & (LINE_RING_ARENA_SPAN - 1U);
+  if (at + bytes > LINE_RING_ARENA_BYTES)
+    pos += LINE_RING_ARENA_SPAN - at;
+  line_ring_line_t *l = line_ring_line(g_line_ring.frame_base_idx + line);
+  l->offset = pos;
+  l->width = width;
+  l->colors = colors;
+  g_line_ring.arena_pos = pos + ((bytes + 3U) & ~3U);
+  __dmb();
+  return line_ring_line_data(l);
+}
+#else
+// Record the pixel count of a line written via line_ring_write_ptr(); call
+// before committing it.
+static inline void line_ring_set_width(uint16_t line, uint16_t width) {
+  uint32_t idx = g_line_ring.frame_base_idx + line;
+  g_line_ring.widths[line_ring_unit(idx)] = width;
+}
+#endif
+
+#if !ENABLE_RAW_CAPTURE_RING
+// Stamp a line with the time Core 0 commits it; call just before the commit.
+static inline void line_ring_stamp(uint16_t line, uint32_t now_us) {
+  g_line_ring.commit_us[(g_line_ring.frame_base_idx + line) &
+                        (LINE_RING_STAMPS - 1U)] = now_us;
 }
+#endif
 
 static inline void line_ring_commit(uint16_t total_lines) {
   __dmb();
   g_line_ring.write_idx = g_line_ring.frame_base_idx + total_lines;
 }
 
+// Core 0 learned the frame is shorter than the 239-line window: the next
+// frame starts right after its last line, keeping the ring's slack.
+static inline void line_ring_end_frame(uint16_t total_lines) {
+  line_ring_commit(total_lines);
+  g_line_ring.frame_end_idx = g_line_ring.frame_base_idx + total_lines;
+}
+
+// Core 0 captured the frame whole (every line it was going to get).
+static inline void line_ring_frame_done(void) {
+  line_ring_publish_done(g_line_ring.frame_base_idx, g_line_ring.write_idx);
+}
+
 static inline void line_ring_output_vsync(void) {
-  g_line_ring.read_frame_start = g_line_ring.frame_base_idx;
+  // Core 0 may publish a new frame mid-snapshot; retry until base, previous
+  // base and flags all belong to the same frame.
+  uint32_t base;
+  do {
+    base = g_line_ring.frame_base_idx;
+    __dmb();
+    g_line_ring.read_prev_frame_start = g_line_ring.prev_frame_base_idx;
+    g_line_ring.read_frame_flags = g_line_ring.frame_flags;
+    g_line_ring.read_frame_lines = g_line_ring.frame_lines;
+    __dmb();
+  } while (base != g_line_ring.frame_base_idx);
+  g_line_ring.read_frame_start = base;
   __dmb();
+  g_line_ring.frame_buffered = 0U;
 }
 
-static inline bool line_ring_ready(uint16_t line) {
-  uint32_t target_idx = g_line_ring.read_frame_start + line;
-  uint32_t write_pos = g_line_ring.write_idx;
-  if (target_idx >= write_pos)
+// Frame-buffered output vsync: latch the newest frame Core 0 has finished.
+// If none has finished since the last one, that one is shown again
+// (repeated); if several have, all but the newest are dropped. Nothing
+// counts before the first frame, for an empty no-signal frame, or on the
+// first latch after the line ring.
+static inline void line_ring_output_vsync_frame(void) {
+  uint32_t seq;
+  uint32_t base;
+  uint32_t end;
+  uint32_t flags;
+  uint32_t lines;
+  do {
+    seq = g_line_ring.done_seq;
+    __dmb();
+    base = g_line_ring.done_base_idx;
+    end = g_line_ring.done_end_idx;
+    flags = g_line_ring.done_flags;
+    lines = g_line_ring.done_lines;
+    __dmb();
+  } while (seq != g_line_ring.done_seq);
+  const bool counting = g_line_ring.frame_buffered != 0U;
+  g_line_ring.frame_buffered = 1U;
+  if (counting && seq == g_line_ring.read_done_seq) {
+    if (seq != 0U && !(flags & LINE_RING_NO_SIGNAL))
+      g_line_ring.frames_repeated++;
+    return;
+  }
+  if (counting && seq - g_line_ring.read_done_seq > 1U)
+    g_line_ring.frames_dropped += seq - g_line_ring.read_done_seq - 1U;
+  g_line_ring.read_done_seq = seq;
+  g_line_ring.read_frame_flags = flags;
+  g_line_ring.read_frame_lines = lines;
+  g_line_ring.read_frame_end = end;
+  g_line_ring.read_prev_frame_start = base; // no weave on whole frames
+  g_line_ring.read_frame_start = base;
+  __dmb();
+}
+
+#if ENABLE_RAW_CAPTURE_RING
+// Core 0 publishes where a frame's stream starts; the DMA's write addresses
+// say how many whole lines have landed since. While Core 0 is re-arming, the
+// committed end of the last frame stands in.
+static inline uint32_t line_ring_write_pos(void) {
+  const uint32_t seq = g_line_ring.raw_seq;
+  __dmb();
+  if (seq & 1U)
+    return g_line_ring.write_idx;
+  const uint32_t base = g_line_ring.frame_base_idx;
+  const uint32_t a_bytes = g_line_ring.raw_a_bytes;
+  const uint32_t a_done = *g_line_ring.raw_write_addr[0] - g_line_ring.raw_start[0];
+  const uint32_t b_done = *g_line_ring.raw_write_addr[1] - g_line_ring.raw_start[1];
+  __dmb();
+  if (g_line_ring.raw_seq != seq)
+    return g_line_ring.write_idx;
+  const uint32_t bytes = (a_done < a_bytes) ? a_done : a_bytes + b_done;
+  return base + (bytes / LINE_RING_RAW_LINE_BYTES);
+}
+#else
+static inline uint32_t line_ring_write_pos(void) {
+  return g_line_ring.write_idx;
+}
+#endif
+
+// A written line stays readable until Core 0 is about to reuse its slot:
+// the slot of write_pos is being filled now, and the one after it may be by
+// the time Core 1 has scaled the line, so those two are already lost.
+#define LINE_RING_GUARD_LINES 1U
+
+static inline bool line_ring_index_lapped(uint32_t target_idx,
+                                          uint32_t write_pos) {
+  if (write_pos - target_idx >= line_ring_capacity() - LINE_RING_GUARD_LINES)
+    return true;
+#if ENABLE_INDEXED_LINES
+  // Same guard in bytes: Core 0 may skip to the start of the arena and then
+  // write its widest line while Core 1 reads this one. A line's bytes are
+  // reused one span after it, the skipped tail included.
+  return g_line_ring.arena_pos - line_ring_line(target_idx)->offset >
+         LINE_RING_ARENA_SPAN - (2U * LINE_RING_MAX_LINE_BYTES);
+#else
+  return false;
+#endif
+}
+
+static inline bool line_ring_index_ready(uint32_t target_idx) {
+  uint32_t write_pos = line_ring_write_pos();
+  if ((int32_t)(target_idx - write_pos) >= 0)
     return false;
   // Overrun detection: if writer has lapped reader, data is stale.
-  if (write_pos - target_idx > LINE_RING_SIZE)
+  if (line_ring_index_lapped(target_idx, write_pos))
     return false;
   return true;
 }
 
+// Core 1 gave up on a line: count whether it came too early or too late.
+static inline void line_ring_count_miss(uint32_t target_idx) {
+  if ((int32_t)(target_idx - line_ring_write_pos()) >= 0)
+    g_line_ring.read_not_ready++;
+  else
+    g_line_ring.read_overruns++;
+}
+
+static inline bool line_ring_ready(uint16_t line) {
+  return line_ring_index_ready(g_line_ring.read_frame_start + line);
+}
+
+// Top of the output frame: if Core 0 has started a newer frame since output
+// vsync and is a few lines into it, read that one instead. The reader then
+// trails the writer by a few lines rather than by a whole frame, which a
+// 239-line frame in a 256-line ring cannot afford.
+#define LINE_RING_LATE_LATCH_LINES 2U
+
+static inline void line_ring_output_late_latch(void) {
+  const uint32_t base = g_line_ring.frame_base_idx;
+  if (g_line_ring.frame_buffered)
+    return;
+  if (base != g_line_ring.read_frame_start &&
+      line_ring_index_ready(base + LINE_RING_LATE_LATCH_LINES))
+    line_ring_output_vsync();
+}
+
+// False for lines past the end of the latched frame, i.e. the tail of a
+// 224-line frame read through a 239-line window after a height switch. Those
+// indices belong to the next frame.
+static inline bool line_ring_in_frame(uint16_t line) {
+  const uint32_t end = g_line_ring.frame_end_idx;
+  __dmb();
+  const uint32_t base = g_line_ring.frame_base_idx;
+  const uint32_t target_idx = g_line_ring.read_frame_start + line;
+  if (g_line_ring.frame_buffered)
+    return (int32_t)(target_idx - g_line_ring.read_frame_end) < 0;
+  if (base != g_line_ring.read_frame_start)
+    return (int32_t)(target_idx - base) < 0;
+  return (int32_t)(target_idx - end) < 0;
+}
+
+// The frame latched at output vsync was lapped under the reader: Core 0's
+// vsync landed just after ours, and a 239-line PAL frame (or the field
+// before it, for weave) leaves the ring too little slack to finish reading
+// it. Jump to the newest frame for the rest of this output frame (one tear)
+// rather than drop lines. Never with whole frames, which must not tear.
+static inline bool line_ring_catch_up(uint16_t line) {
+  if (g_line_ring.frame_buffered ||
+      g_line_ring.frame_base_idx == g_line_ring.read_frame_start)
+    return false;
+  line_ring_output_vsync();
+  return line_ring_ready(line);
+}
+
+#if !ENABLE_RAW_CAPTURE_RING
+// Commit time of a line of the latched frame; valid while it is ready.
+static inline uint32_t line_ring_read_stamp(uint16_t line) {
+  return g_line_ring.commit_us[(g_line_ring.read_frame_start + line) &
+                               (LINE_RING_STAMPS - 1U)];
+}
+#endif
+
+static inline void line_ring_count_read_miss(uint16_t line) {
+  line_ring_count_miss(g_line_ring.read_frame_start + line);
+}
+
+#if ENABLE_INDEXED_LINES
+// An indexed line's pointer is to its 8-bit indices, and its palette follows
+// them; line_ring_read_palette() is NULL for RGB565 lines.
 static inline const uint16_t *line_ring_read_ptr(uint16_t line) {
   uint32_t target_idx = g_line_ring.read_frame_start + line;
   __dmb();
-  return g_line_ring.lines[target_idx % LINE_RING_SIZE];
+  return (const uint16_t *)line_ring_line_data(line_ring_line(target_idx));
 }
 
+static inline uint16_t line_ring_read_width(uint16_t line) {
+  return line_ring_line(g_line_ring.read_frame_start + line)->width;
+}
+
+static inline const uint16_t *line_ring_read_palette(uint16_t line) {
+  const line_ring_line_t *l =
+      line_ring_line(g_line_ring.read_frame_start + line);
+  return l->colors ? (const uint16_t *)(line_ring_line_data(l) + l->width)
+                   : NULL;
+}
+#else
+static inline const uint16_t *line_ring_read_ptr(uint16_t line) {
+  uint32_t target_idx = g_line_ring.read_frame_start + line;
+  __dmb();
+  return &g_line_ring.pixels[line_ring_unit(target_idx) * LINE_WIDTH];
+}
+
+static inline uint16_t line_ring_read_width(uint16_t line) {
+  uint32_t target_idx = g_line_ring.read_frame_start + line;
+  return g_line_ring.widths[line_ring_unit(target_idx)];
+}
+#endif
+
+// Interlace: flags of the frame being scanned out, and the same line of the
+// field before it (the other half of a 448i frame).
+static inline uint32_t line_ring_read_flags(void) {
+  return g_line_ring.read_frame_flags;
+}
+
+// Height latched with the frame being scanned out.
+static inline uint32_t line_ring_read_lines(void) {
+  return g_line_ring.read_frame_lines;
+}
+
+// Raw capture ring: brightness to convert the scanned-out frame with.
+static inline uint32_t line_ring_read_brightness(void) {
+  return (g_line_ring.read_frame_flags & LINE_RING_BRIGHTNESS_MASK) >>
+         LINE_RING_BRIGHTNESS_SHIFT;
+}
+
+// Absolute ring index of a line of the frame being scanned out; unique
+// across frames, unlike its pointer.
+static inline uint32_t line_ring_read_index(uint16_t line) {
+  return g_line_ring.read_frame_start + line;
+}
+
+static inline bool line_ring_prev_field_ready(uint16_t line) {
+  return line_ring_index_ready(g_line_ring.read_prev_frame_start + line);
+}
+
+// Weave fell back to the current field: the other one was lapped.
+static inline void line_ring_count_prev_field_miss(uint16_t line) {
+  line_ring_count_miss(g_line_ring.read_prev_frame_start + line);
+}
+
+#if ENABLE_INDEXED_LINES
+static inline const uint16_t *line_ring_prev_field_ptr(uint16_t line) {
+  uint32_t target_idx = g_line_ring.read_prev_frame_start + line;
+  __dmb();
+  return (const uint16_t *)line_ring_line_data(line_ring_line(target_idx));
+}
+
+static inline const uint16_t *line_ring_prev_field_palette(uint16_t line) {
+  const line_ring_line_t *l =
+      line_ring_line(g_line_ring.read_prev_frame_start + line);
+  return l->colors ? (const uint16_t *)(line_ring_line_data(l) + l->width)
+                   : NULL;
+}
+#else
+static inline const uint16_t *line_ring_prev_field_ptr(uint16_t line) {
+  uint32_t target_idx = g_line_ring.read_prev_frame_start + line;
+  __dmb();
+  return &g_line_ring.pixels[line_ring_unit(target_idx) * LINE_WIDTH];
+}
+#endif
+
 #endif
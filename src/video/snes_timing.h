@@ -7,9 +7,49 @@
 
 #define SNES_H_TOTAL      341
 #define SNES_H_ACTIVE     256
+#define SNES_H_ACTIVE_HIRES 512  // Mode 5/6 and pseudo-hires: two pixels per dot
 #define SNES_V_TOTAL      262
 #define SNES_V_ACTIVE     224
 
+// Overscan ($2133 bit 2): 239 active lines. VBLANK then starts 15 lines later,
+// so the capture loop counts the lines of each frame instead of assuming one
+// height per region.
+#define SNES_V_ACTIVE_OVERSCAN 239
+
+// Interlace ($2133 bit 0): fields alternate between 263 and 262 lines
+#define SNES_V_TOTAL_INTERLACE 263
+
+// Dot clock is master / 4; one line is SNES_H_TOTAL dots (~63.5 us)
+#define SNES_MASTER_CLOCK_HZ 21477272U
+#define SNES_LINE_NS ((SNES_H_TOTAL * 4ULL * 1000000000ULL) / SNES_MASTER_CLOCK_HZ)
+
+// =============================================================================
+// SNES PAL Timing Constants
+// =============================================================================
+// Same 341-dot line from a slower master clock (~64.1 us), 312 lines per
+// frame (313/312 interlaced). PAL games mostly run with overscan on, so a
+// PAL console is assumed to send 239 lines until the first frame is counted.
+
+#define SNES_V_TOTAL_PAL           312
+#define SNES_V_TOTAL_PAL_INTERLACE 313
+#define SNES_V_ACTIVE_PAL          SNES_V_ACTIVE_OVERSCAN
+
+#define SNES_MASTER_CLOCK_PAL_HZ 21281370U
+#define SNES_LINE_PAL_NS ((SNES_H_TOTAL * 4ULL * 1000000000ULL) / SNES_MASTER_CLOCK_PAL_HZ)
+
+typedef enum {
+    SNES_REGION_NTSC = 0,
+    SNES_REGION_PAL = 1,
+} snes_region_t;
+
+#define SNES_REGION_V_TOTAL(region)  (((region) == SNES_REGION_PAL) ? SNES_V_TOTAL_PAL : SNES_V_TOTAL)
+#define SNES_REGION_V_ACTIVE(region) (((region) == SNES_REGION_PAL) ? SNES_V_ACTIVE_PAL : SNES_V_ACTIVE)
+#define SNES_REGION_LINE_NS(region)  (((region) == SNES_REGION_PAL) ? SNES_LINE_PAL_NS : SNES_LINE_NS)
+
+// VBLANK-to-VBLANK period halfway between NTSC (~16.6 ms) and PAL (~20.0 ms)
+#define SNES_REGION_SPLIT_US                                                                      \
+    ((uint32_t)((((SNES_V_TOTAL_INTERLACE * SNES_LINE_NS) + (SNES_V_TOTAL_PAL * SNES_LINE_PAL_NS)) / 2U) / 1000U))
+
 // Capture tuning (relative to CSYNC falling edge)
 // These values determine which part of the horizontal line is captured.
 // Based on 341 total dots, 256 active. 
@@ -4,12 +4,21 @@
 #include "audio/audio_pipeline.h"
 #endif
 #include "freq_counter.h"
+#include "hardware/clocks.h"
 #include "hardware/dma.h"
+#include "hardware/interp.h"
+#include "hardware/irq.h"
 #include "hardware/pio.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
 #include "pico/stdlib.h"
 #include "snes_pins.h"
 #include "snes_timing.h"
+#if ENABLE_PIO_FRAME_SYNC
+#include "video_capture_frame_sync.pio.h"
+#else
 #include "video_capture.pio.h"
+#endif
 #include "video_pipeline.h"
 #include <stdio.h>
 #include <string.h>
@@ -18,21 +27,141 @@
 // State
 // =============================================================================
 
-static uint32_t g_snes_height = 0;
+static snes_region_t g_region = SNES_REGION_NTSC;
 static PIO g_pio_snes = pio1;
+static PIO g_pio_lines = pio2;
 
 static uint g_sm_pixel = 0;
 static uint g_offset_pixel = 0;
 static pio_sm_config g_pio_config;
-
-static int g_dma_chan = -1;
-static uint32_t g_line_buffers[2][SNES_H_TOTAL];
-static volatile uint32_t g_frame_count = 0;
+static uint g_sm_lines = 0;
 
 #ifndef ENABLE_AUDIO_REARM_ON_VIDEO_REACQUIRE
 #define ENABLE_AUDIO_REARM_ON_VIDEO_REACQUIRE 0
 #endif
 
+#ifndef ENABLE_BRIGHTNESS
+#define ENABLE_BRIGHTNESS 0
+#endif
+
+#ifndef ENABLE_FIELD_PIN
+#define ENABLE_FIELD_PIN 0
+#endif
+
+#ifndef ENABLE_PALMODE_PIN
+#define ENABLE_PALMODE_PIN 0
+#endif
+
+#ifndef ENABLE_INTERP_CONVERT
+#define ENABLE_INTERP_CONVERT 0
+#endif
+
+#ifndef ENABLE_PIO_FRAME_SYNC
+#define ENABLE_PIO_FRAME_SYNC 0
+#endif
+
+// Set by the SUPERPICO_LEAN_PIXEL_CONVERT CMake option.
+#ifndef ENABLE_LEAN_CONVERT
+#define ENABLE_LEAN_CONVERT 0
+#endif
+
+#if ENABLE_LEAN_CONVERT && ENABLE_INTERP_CONVERT
+#error "ENABLE_INTERP_CONVERT reads g_pixel_lut, which ENABLE_LEAN_CONVERT drops"
+#endif
+
+#ifndef ENABLE_PACKED_CAPTURE
+#define ENABLE_PACKED_CAPTURE 0
+#endif
+
+// The raw ring stores capture samples in place of RGB565 pixels, so they must
+// be the 16-bit packed ones; Core 1 converts them, and the interpolators are
+// per core, set up on Core 0.
+#if ENABLE_RAW_CAPTURE_RING && !ENABLE_PACKED_CAPTURE
+#error "ENABLE_RAW_CAPTURE_RING needs ENABLE_PACKED_CAPTURE"
+#endif
+#if ENABLE_RAW_CAPTURE_RING && ENABLE_INTERP_CONVERT
+#error "ENABLE_RAW_CAPTURE_RING converts on Core 1, ENABLE_INTERP_CONVERT only on Core 0"
+#endif
+
+#if ENABLE_HIRES
+#define CAPTURE_SAMPLES_PER_DOT 2
+#else
+#define CAPTURE_SAMPLES_PER_DOT 1
+#endif
+
+// A capture sample is one pixel as the PIO program stores it. Unpacked, it is
+// the full 19-bit pin word (RGB555 in bits 2-16); packed, it is a 16-bit half
+// of a FIFO word (RGB555 in bits 1-15, see video_capture.pio), so a line
+// takes half the DMA transfers and buffer space. Either way a zero sample is
+// an invalid (black) pixel.
+#if ENABLE_PACKED_CAPTURE
+typedef uint16_t capture_sample_t;
+#define CAPTURE_RGB_SHIFT 1
+#define CAPTURE_IN_BASE_PIN PIN_SNES_B4
+#define CAPTURE_PUSH_BITS 32
+#if ENABLE_HIRES
+#define CAPTURE_PROGRAM snes_hard_sync_hires_packed_program
+#define CAPTURE_PROGRAM_GET_DEFAULT_CONFIG                                     \
+  snes_hard_sync_hires_packed_program_get_default_config
+#define CAPTURE_OFFSET_SKIP snes_hard_sync_hires_packed_offset_skip
+#define CAPTURE_OFFSET_HOLD snes_hard_sync_hires_packed_offset_hold
+#define CAPTURE_OFFSET_SUB_HOLD snes_hard_sync_hires_packed_offset_sub_hold
+#else
+#define CAPTURE_PROGRAM snes_hard_sync_packed_program
+#define CAPTURE_PROGRAM_GET_DEFAULT_CONFIG                                     \
+  snes_hard_sync_packed_program_get_default_config
+#define CAPTURE_OFFSET_SKIP snes_hard_sync_packed_offset_skip
+#define CAPTURE_OFFSET_HOLD snes_hard_sync_packed_offset_hold
+#endif
+#else
+typedef uint32_t capture_sample_t;
+#define CAPTURE_RGB_SHIFT 2
+#define CAPTURE_IN_BASE_PIN PIN_SNES_BASE
+#define CAPTURE_PUSH_BITS SNES_CAPTURE_BITS
+#if ENABLE_HIRES
+#define CAPTURE_PROGRAM snes_hard_sync_hires_program
+#define CAPTURE_PROGRAM_GET_DEFAULT_CONFIG                                     \
+  snes_hard_sync_hires_program_get_default_config
+#define CAPTURE_OFFSET_SKIP snes_hard_sync_hires_offset_skip
+#define CAPTURE_OFFSET_HOLD snes_hard_sync_hires_offset_hold
+#define CAPTURE_OFFSET_SUB_HOLD snes_hard_sync_hires_offset_sub_hold
+#else
+#define CAPTURE_PROGRAM snes_hard_sync_program
+#define CAPTURE_PROGRAM_GET_DEFAULT_CONFIG snes_hard_sync_program_get_default_config
+#define CAPTURE_OFFSET_SKIP snes_hard_sync_offset_skip
+#define CAPTURE_OFFSET_HOLD snes_hard_sync_offset_hold
+#endif
+#endif
+
+#define CAPTURE_RGB(sample) (((uint32_t)(sample) >> CAPTURE_RGB_SHIFT) & 0x7FFFU)
+
+// Samples and raw capture words DMA'd per active line.
+#define CAPTURE_LINE_SAMPLES (SNES_H_ACTIVE * CAPTURE_SAMPLES_PER_DOT)
+#define CAPTURE_LINE_WORDS                                                     \
+  (CAPTURE_LINE_SAMPLES * sizeof(capture_sample_t) / sizeof(uint32_t))
+
+// Capture word bits that must match between the two samples of a lores dot:
+// B/G/R (bits 2-16) and PIXEL_VALID (bit 18). PCLK differs by design.
+#define CAPTURE_PIXEL_BITS ((0x7FFFu << 2) | (1u << 18))
+
+#if ENABLE_RAW_CAPTURE_RING
+_Static_assert(CAPTURE_LINE_WORDS * sizeof(uint32_t) == LINE_RING_RAW_LINE_BYTES,
+               "a raw captured line fills exactly one ring line");
+
+static int g_raw_dma_chan[2] = {-1, -1};
+static dma_channel_config g_raw_dma_config;       // A, frame fits before the end
+static dma_channel_config g_raw_dma_config_chain; // A, wraps into B
+#else
+static int g_dma_chan = -1;
+static uint32_t g_line_buffers[2][CAPTURE_LINE_WORDS];
+#endif
+static volatile uint32_t g_frame_count = 0;
+static volatile uint32_t g_hires_lines = 0;
+static volatile uint32_t g_field_flags = 0;
+#if ENABLE_HIRES && (ENABLE_INTERLACE || LINE_RING_FRAME_BUFFERS)
+static uint16_t g_hires_scratch[SNES_H_ACTIVE_HIRES] __attribute__((aligned(4)));
+#endif
+
 // =============================================================================
 // Pixel Conversion - RGB555 to RGB565 LUT
 // =============================================================================
@@ -44,12 +173,17 @@ static inline uint32_t snes_reverse_5bit(uint32_t x) {
          ((x & 16U) >> 4);
 }
 
+// RGB565 from three 5-bit channels. Green's MSB is replicated into the G6
+// LSB (bit 5), so full green is 0x3F and the blue bits stay blue's own.
 static inline uint16_t snes_pack_rgb565(uint32_t r5, uint32_t g5,
                                         uint32_t b5) {
-  return (uint16_t)((r5 << 11) | (g5 << 6) | (g5 >> 4) | b5);
+  return (uint16_t)((r5 << 11) | (g5 << 6) | ((g5 >> 4) << 5) | b5);
 }
 
+#if !ENABLE_LEAN_CONVERT
 // 32K LUT: raw RGB555 (with reversed bits) -> corrected RGB565.
+// Index 0 doubles as the invalid-pixel code: snes_hard_sync pushes a zero
+// word when PIXEL_VALID is low, so /OVER and TOUMEI resolve to black here.
 static uint16_t g_pixel_lut[32768] __attribute__((aligned(4)));
 
 static void generate_pixel_lut(void) {
@@ -60,31 +194,1284 @@ static void generate_pixel_lut(void) {
     g_pixel_lut[idx] = snes_pack_rgb565(r5, g5, b5);
   }
 }
+#endif
+
+// Table-free conversion (ENABLE_LEAN_CONVERT): RBIT reverses the whole
+// sample, which undoes the per-channel reversal and leaves B4-B0 at bits
+// 29-25, G at 24-20 and R at 19-15 (one higher for packed samples), so RGB565
+// is three masked shifts plus the replicated green LSB. A zero (invalid)
+// sample is still black.
+static inline uint32_t capture_rbit(uint32_t x) {
+#if defined(__arm__)
+  uint32_t r;
+  __asm__("rbit %0, %1" : "=r"(r) : "r"(x));
+  return r;
+#else
+  x = ((x >> 1) & 0x55555555U) | ((x & 0x55555555U) << 1);
+  x = ((x >> 2) & 0x33333333U) | ((x & 0x33333333U) << 2);
+  x = ((x >> 4) & 0x0F0F0F0FU) | ((x & 0x0F0F0F0FU) << 4);
+  x = ((x >> 8) & 0x00FF00FFU) | ((x & 0x00FF00FFU) << 8);
+  return (x >> 16) | (x << 16);
+#endif
+}
+
+static inline uint16_t capture_sample_to_rgb565(uint32_t w) {
+  const uint32_t r = capture_rbit(w);
+  return (uint16_t)(((r >> (6 - CAPTURE_RGB_SHIFT)) & 0xF800U) |
+                    ((r >> (16 - CAPTURE_RGB_SHIFT)) & 0x07C0U) |
+                    ((r >> (21 - CAPTURE_RGB_SHIFT)) & 0x0020U) |
+                    ((r >> (27 - CAPTURE_RGB_SHIFT)) & 0x001FU));
+}
+
+// =============================================================================
+// Master Brightness ($2100) - per-channel LUT bank
+// =============================================================================
+// One 96-entry table per brightness level: raw (bit-reversed) 5-bit channel
+// -> (c * level) / 15, already shifted into its RGB565 field, so a faded
+// pixel is three lookups ORed together. Sixteen copies of the 64 KB LUT
+// would need 1 MB of SRAM; the whole bank is 3 KB. Full-brightness lines
+// (nearly all of them) keep the single-lookup g_pixel_lut path.
+
+#define BRIGHT_LUT_B 0U
+#define BRIGHT_LUT_G 32U
+#define BRIGHT_LUT_R 64U
+
+static uint16_t g_bright_lut[SNES_BRIGHTNESS_MAX + 1][96]
+    __attribute__((aligned(4)));
+
+static void generate_brightness_luts(void) {
+  for (uint32_t level = 0; level <= SNES_BRIGHTNESS_MAX; level++) {
+    for (uint32_t raw = 0; raw < 32U; raw++) {
+      uint32_t c5 = (snes_reverse_5bit(raw) * level) / SNES_BRIGHTNESS_MAX;
+      g_bright_lut[level][BRIGHT_LUT_B + raw] = snes_pack_rgb565(0, 0, c5);
+      g_bright_lut[level][BRIGHT_LUT_G + raw] = snes_pack_rgb565(0, c5, 0);
+      g_bright_lut[level][BRIGHT_LUT_R + raw] = snes_pack_rgb565(c5, 0, 0);
+    }
+  }
+}
+
+static inline uint32_t read_brightness(void) {
+#if ENABLE_BRIGHTNESS
+  return (gpio_get_all() >> PIN_SNES_BRIGHT_BASE) & SNES_BRIGHTNESS_MAX;
+#else
+  return SNES_BRIGHTNESS_MAX;
+#endif
+}
+
+// =============================================================================
+// Line Conversion
+// =============================================================================
+
+// `stride` is the distance between consumed source words: 1 for every
+// sample, CAPTURE_SAMPLES_PER_DOT to keep only the main pixel of each dot.
+// It is a compile-time constant at every call site, so the loops stay as
+// tight as the single-sample versions.
+
+#if !ENABLE_LEAN_CONVERT
+static inline void convert_line_full_lut(uint16_t *dst,
+                                         const capture_sample_t *src,
+                                         int remaining, int stride) {
+  // Unrolled 4-pixel conversion (matches neopico-hd)
+  const uint16_t *lut = g_pixel_lut;
+  while (remaining >= 4) {
+    dst[0] = lut[CAPTURE_RGB(src[0 * stride])];
+    dst[1] = lut[CAPTURE_RGB(src[1 * stride])];
+    dst[2] = lut[CAPTURE_RGB(src[2 * stride])];
+    dst[3] = lut[CAPTURE_RGB(src[3 * stride])];
+    dst += 4;
+    src += 4 * stride;
+    remaining -= 4;
+  }
+  while (remaining-- > 0) {
+    *dst++ = lut[CAPTURE_RGB(*src)];
+    src += stride;
+  }
+}
+
+// Interpolator kernel: every lane of both Core 0 interpolators is set up to
+// map a capture sample straight to the address of its g_pixel_lut entry (the
+// RGB555 field shifted to bits 1-15 is the index times two, plus the LUT
+// base), so each pixel is a store to ACCUM and a load from PEEK with no shift
+// or mask in the loop. Four lanes give four pixels in flight per iteration.
+static void interp_convert_init(void) {
+  interp_config c = interp_default_config();
+  interp_config_set_shift(&c, CAPTURE_RGB_SHIFT - 1);
+  interp_config_set_mask(&c, 1, 15);
+  interp_set_config(interp0, 0, &c);
+  interp_set_config(interp0, 1, &c);
+  interp_set_config(interp1, 0, &c);
+  interp_set_config(interp1, 1, &c);
+  interp_set_base(interp0, 0, (uintptr_t)g_pixel_lut);
+  interp_set_base(interp0, 1, (uintptr_t)g_pixel_lut);
+  interp_set_base(interp1, 0, (uintptr_t)g_pixel_lut);
+  interp_set_base(interp1, 1, (uintptr_t)g_pixel_lut);
+}
+
+static inline uint16_t interp_lut_result(interp_hw_t *interp, uint lane) {
+  return *(const uint16_t *)(uintptr_t)interp_peek_lane_result(interp, lane);
+}
+
+static inline void convert_line_full_interp(uint16_t *dst,
+                                            const capture_sample_t *src,
+                                            int remaining, int stride) {
+  while (remaining >= 4) {
+    interp_set_accumulator(interp0, 0, src[0 * stride]);
+    interp_set_accumulator(interp0, 1, src[1 * stride]);
+    interp_set_accumulator(interp1, 0, src[2 * stride]);
+    interp_set_accumulator(interp1, 1, src[3 * stride]);
+    dst[0] = interp_lut_result(interp0, 0);
+    dst[1] = interp_lut_result(interp0, 1);
+    dst[2] = interp_lut_result(interp1, 0);
+    dst[3] = interp_lut_result(interp1, 1);
+    dst += 4;
+    src += 4 * stride;
+    remaining -= 4;
+  }
+  while (remaining-- > 0) {
+    interp_set_accumulator(interp0, 0, *src);
+    *dst++ = interp_lut_result(interp0, 0);
+    src += stride;
+  }
+}
+#endif // !ENABLE_LEAN_CONVERT
+
+static inline void convert_line_full_rbit(uint16_t *dst,
+                                          const capture_sample_t *src,
+                                          int remaining, int stride) {
+  while (remaining >= 4) {
+    dst[0] = capture_sample_to_rgb565(src[0 * stride]);
+    dst[1] = capture_sample_to_rgb565(src[1 * stride]);
+    dst[2] = capture_sample_to_rgb565(src[2 * stride]);
+    dst[3] = capture_sample_to_rgb565(src[3 * stride]);
+    dst += 4;
+    src += 4 * stride;
+    remaining -= 4;
+  }
+  while (remaining-- > 0) {
+    *dst++ = capture_sample_to_rgb565(*src);
+    src += stride;
+  }
+}
+
+static inline void convert_line_full(uint16_t *dst,
+                                     const capture_sample_t *src,
+                                     int remaining, int stride) {
+#if ENABLE_LEAN_CONVERT
+  convert_line_full_rbit(dst, src, remaining, stride);
+#elif ENABLE_INTERP_CONVERT
+  convert_line_full_interp(dst, src, remaining, stride);
+#else
+  convert_line_full_lut(dst, src, remaining, stride);
+#endif
+}
+
+static inline void convert_line_faded(uint16_t *dst,
+                                      const capture_sample_t *src,
+                                      int remaining, int stride,
+                                      uint32_t brightness) {
+  const uint16_t *lut = g_bright_lut[brightness];
+  while (remaining-- > 0) {
+    uint32_t w = CAPTURE_RGB(*src);
+    src += stride;
+    *dst++ = lut[BRIGHT_LUT_B + (w & 0x1F)] |
+             lut[BRIGHT_LUT_G + ((w >> 5) & 0x1F)] |
+             lut[BRIGHT_LUT_R + ((w >> 10) & 0x1F)];
+  }
+}
+
+static inline void convert_line(uint16_t *dst, const capture_sample_t *src,
+                                int count, int stride, uint32_t brightness) {
+  if (brightness >= SNES_BRIGHTNESS_MAX) {
+    convert_line_full(dst, src, count, stride);
+  } else if (brightness == 0) {
+    memset(dst, 0, (size_t)count * sizeof(uint16_t));
+  } else {
+    convert_line_faded(dst, src, count, stride, brightness);
+  }
+}
+
+#if ENABLE_HIRES
+// A lores dot yields two identical samples; any differing pair means the PPU
+// drew 512 pixels on this line (Mode 5/6, or pseudo-hires via SETINI).
+static inline bool captured_line_is_hires(const uint32_t *src) {
+  uint32_t diff = 0;
+#if ENABLE_PACKED_CAPTURE
+  // One word per dot: the main sample's half against the sub-sample's.
+  for (int i = 0; i < SNES_H_ACTIVE; i += 2) {
+    diff |= (src[0] ^ (src[0] << 16)) | (src[1] ^ (src[1] << 16));
+    src += 2;
+  }
+  return (diff >> 16) != 0;
+#else
+  for (int i = 0; i < SNES_H_ACTIVE; i += 2) {
+    diff |= (src[0] ^ src[1]) | (src[2] ^ src[3]);
+    src += 4;
+  }
+  return (diff & CAPTURE_PIXEL_BITS) != 0;
+#endif
+}
+#endif
+
+#if ENABLE_HIRES && (ENABLE_INTERLACE || LINE_RING_FRAME_BUFFERS)
+// Interlaced and frame-buffered frames store one 256-px unit per line; hires
+// lines (Mode 5 512x448 menus) are averaged pairwise to fit.
+static inline void blend_hires_pairs(uint16_t *dst, const uint16_t *src) {
+  const uint32_t *src32 = (const uint32_t *)src;
+  for (int i = 0; i < SNES_H_ACTIVE; i++) {
+    uint32_t p0 = src32[i] & 0xFFFF;
+    uint32_t p1 = src32[i] >> 16;
+    dst[i] = (uint16_t)((((p0 ^ p1) & 0xF7DEU) >> 1) + (p0 & p1));
+  }
+}
+#endif
+
+// Convert one raw captured line into `dst` and return its width in pixels
+// (at most `max_width`).
+static inline uint16_t convert_captured_line(uint16_t *dst,
+                                             const uint32_t *words,
+                                             uint32_t brightness,
+                                             uint16_t max_width) {
+  const capture_sample_t *src = (const capture_sample_t *)words;
+#if ENABLE_HIRES
+  if (captured_line_is_hires(words)) {
+    g_hires_lines++;
+#if ENABLE_INTERLACE || LINE_RING_FRAME_BUFFERS
+    if (max_width < SNES_H_ACTIVE_HIRES) {
+      convert_line(g_hires_scratch, src, SNES_H_ACTIVE_HIRES, 1, brightness);
+      blend_hires_pairs(dst, g_hires_scratch);
+      return SNES_H_ACTIVE;
+    }
+#endif
+    convert_line(dst, src, SNES_H_ACTIVE_HIRES, 1, brightness);
+    return SNES_H_ACTIVE_HIRES;
+  }
+#endif
+  (void)max_width;
+  convert_line(dst, src, SNES_H_ACTIVE, CAPTURE_SAMPLES_PER_DOT, brightness);
+  return SNES_H_ACTIVE;
+}
+
+#if ENABLE_INDEXED_LINES
+// =============================================================================
+// Indexed Line Store
+// =============================================================================
+// Each converted line gets its own palette. Colours go into a small
+// open-addressed hash whose entries carry the line's tag, so nothing is
+// cleared between lines, only when the 8-bit tag wraps. Runs of one colour
+// (most of any SNES line) skip the lookup.
+
+#define INDEX_HASH_BITS 10U
+#define INDEX_HASH_SIZE (1U << INDEX_HASH_BITS)
+
+static uint32_t g_index_hash[INDEX_HASH_SIZE]; // tag << 24 | rgb565 << 8 | index
+static uint32_t g_index_tag = 0;
+static uint8_t g_index_pixels[SNES_H_ACTIVE_HIRES] __attribute__((aligned(4)));
+static uint16_t g_index_palette[256] __attribute__((aligned(4)));
+static uint16_t g_index_line[SNES_H_ACTIVE_HIRES] __attribute__((aligned(4)));
+
+static volatile uint32_t g_indexed_lines = 0;
+static volatile uint32_t g_wide_lines = 0;
+static volatile uint32_t g_index_max_colors = 0;
+static uint64_t g_index_bytes = 0;
+
+// Index `width` pixels into g_index_pixels/g_index_palette. Returns the
+// palette size, or 0 as soon as the line needs more than `max_colors`.
+static uint32_t index_line(const uint16_t *pixels, uint32_t width,
+                           uint32_t max_colors) {
+  if (++g_index_tag > 0xFFU) {
+    memset(g_index_hash, 0, sizeof(g_index_hash));
+    g_index_tag = 1U;
+  }
+  const uint32_t tag = g_index_tag << 24;
+  uint32_t colors = 0;
+  uint32_t last = UINT32_MAX;
+  uint32_t index = 0;
+  for (uint32_t i = 0; i < width; i++) {
+    const uint32_t c = pixels[i];
+    if (c != last) {
+      uint32_t h = (c * 0x9E3779B1U) >> (32U - INDEX_HASH_BITS);
+      for (;;) {
+        const uint32_t e = g_index_hash[h];
+        if ((e & 0xFF000000U) != tag) {
+          if (colors == max_colors)
+            return 0;
+          index = colors++;
+          g_index_palette[index] = (uint16_t)c;
+          g_index_hash[h] = tag | (c << 8) | index;
+          break;
+        }
+        if (((e >> 8) & 0xFFFFU) == c) {
+          index = e & 0xFFU;
+          break;
+        }
+        h = (h + 1U) & (INDEX_HASH_SIZE - 1U);
+      }
+      last = c;
+    }
+    g_index_pixels[i] = (uint8_t)index;
+  }
+  return colors;
+}
+
+// Store a converted line: indexed while indices plus palette are smaller
+// than the RGB565 line (under width / 2 colours), RGB565 otherwise.
+static void store_line(uint16_t line, const uint16_t *pixels, uint16_t width) {
+  const uint32_t colors = index_line(pixels, width, (width / 2U) - 1U);
+  uint32_t bytes;
+  if (colors == 0) {
+    bytes = width * 2U;
+    memcpy(line_ring_alloc_line(line, bytes, width, 0), pixels, bytes);
+    g_wide_lines++;
+  } else {
+    bytes = width + (colors * 2U);
+    uint8_t *dst = line_ring_alloc_line(line, bytes, width, (uint16_t)colors);
+    memcpy(dst, g_index_pixels, width);
+    memcpy(dst + width, g_index_palette, colors * 2U);
+    g_indexed_lines++;
+    if (colors > g_index_max_colors)
+      g_index_max_colors = colors;
+  }
+  g_index_bytes += bytes;
+}
+#endif
+
+// =============================================================================
+// Interlace Field Detection
+// =============================================================================
+// Interlaced output alternates long and short fields (263/262 lines NTSC,
+// 313/312 PAL); progressive frames are always short. The VBLANK-to-VBLANK
+// period gives the length of the field that just ended, and a long field is
+// followed by the odd one. ENABLE_FIELD_PIN reads the parity from the PPU
+// instead; the period still decides whether the source is interlaced.
+// Thresholds depend on the region, so they are set up in video_capture_init.
+
+#define FIELD_LOCK_ALTERNATIONS 3U
+#define FIELD_SLACK_LINES 8U
+
+static uint32_t g_field_long_us = 0;
+static uint32_t g_field_min_us = 0;
+static uint32_t g_field_max_us = 0;
+#if ENABLE_INTERLACE
+static bool g_last_field_long = false;
+static uint32_t g_field_alternations = 0;
+#endif
+
+static void field_detect_init(snes_region_t region) {
+  const uint64_t line_ns = SNES_REGION_LINE_NS(region);
+  const uint32_t v_total = SNES_REGION_V_TOTAL(region);
+  g_field_long_us = (uint32_t)(((2U * v_total + 1U) * line_ns) / 2000U);
+  g_field_min_us = (uint32_t)(((v_total - FIELD_SLACK_LINES) * line_ns) / 1000U);
+  g_field_max_us =
+      (uint32_t)(((v_total + 1U + FIELD_SLACK_LINES) * line_ns) / 1000U);
+}
+
+#if ENABLE_INTERLACE
+static uint32_t field_detect_update(uint32_t period_us) {
+  if (period_us < g_field_min_us || period_us > g_field_max_us) {
+    // First frame after (re)acquire, or a missed VBLANK.
+    g_field_alternations = 0;
+    return 0;
+  }
+
+  const bool long_field = period_us > g_field_long_us;
+  if (long_field == g_last_field_long) {
+    g_field_alternations = 0;
+  } else if (g_field_alternations < FIELD_LOCK_ALTERNATIONS) {
+    g_field_alternations++;
+  }
+  g_last_field_long = long_field;
+  if (g_field_alternations < FIELD_LOCK_ALTERNATIONS)
+    return 0;
+
+#if ENABLE_FIELD_PIN
+  const bool odd = gpio_get(PIN_SNES_FIELD);
+#else
+  const bool odd = long_field;
+#endif
+  return LINE_RING_INTERLACED | (odd ? LINE_RING_FIELD_ODD : 0U);
+}
+#endif
+
+// =============================================================================
+// Region Detection
+// =============================================================================
+// The output mode and sysclk are fixed at boot, so main probes the region
+// before starting HDMI. The capture loop keeps classifying every VBLANK
+// period; if the console changes region (switchable consoles, or a board
+// that booted before the SNES), it reboots into the matching modes.
+
+#define REGION_SWITCH_FRAMES 30U
+
+static uint32_t g_region_mismatch_frames = 0;
+
+#if !ENABLE_PALMODE_PIN
+static bool region_period_plausible(uint32_t period_us) {
+  return period_us >=
+             (uint32_t)(((SNES_V_TOTAL - FIELD_SLACK_LINES) * SNES_LINE_NS) /
+                        1000U) &&
+         period_us <= (uint32_t)(((SNES_V_TOTAL_PAL_INTERLACE +
+                                   FIELD_SLACK_LINES) *
+                                  SNES_LINE_PAL_NS) /
+                                 1000U);
+}
+
+static snes_region_t region_from_period(uint32_t period_us) {
+  return (period_us > SNES_REGION_SPLIT_US) ? SNES_REGION_PAL
+                                            : SNES_REGION_NTSC;
+}
+#endif
+
+static void region_monitor_update(uint32_t period_us) {
+#if ENABLE_PALMODE_PIN
+  (void)period_us;
+  const snes_region_t seen =
+      gpio_get(PIN_SNES_PALMODE) ? SNES_REGION_PAL : SNES_REGION_NTSC;
+#else
+  if (!region_period_plausible(period_us)) {
+    return;
+  }
+  const snes_region_t seen = region_from_period(period_us);
+#endif
+  if (seen == g_region) {
+    g_region_mismatch_frames = 0;
+    return;
+  }
+  if (++g_region_mismatch_frames < REGION_SWITCH_FRAMES)
+    return;
+  printf("Video: source is now %s, rebooting\n",
+         (seen == SNES_REGION_PAL) ? "PAL" : "NTSC");
+#if ENABLE_REBOOT_MODE_SWITCH
+  video_pipeline_request_reboot_mode(video_pipeline_reboot_requested_mode());
+#else
+  watchdog_reboot(0, 0, 10);
+#endif
+}
+
+// =============================================================================
+// Frame Period
+// =============================================================================
+// The output genlock needs the console's frame period to well under a
+// microsecond: NTSC is 16639.3 us against 16666.7 us for 60 Hz HDMI, and a
+// 1 us error walks the phase a line every ~30 frames. The top of frame
+// timestamps of the last FRAME_PERIOD_WINDOW frames give it to
+// 1/FRAME_PERIOD_WINDOW us, a fresh value every frame. The window is an even
+// number of frames, so 448i's long and short fields average out. A period
+// outside the field limits (a reacquire, a missed edge) restarts the window
+// and keeps the last value until it is full again.
+
+#define FRAME_PERIOD_WINDOW 64U
+
+static uint32_t g_period_edges_us[FRAME_PERIOD_WINDOW];
+static uint32_t g_period_frames = 0;
+static volatile uint32_t g_frame_period_q8 = 0;
+
+static void frame_period_update(uint32_t edge_us, uint32_t period_us) {
+  if (period_us < g_field_min_us || period_us > g_field_max_us)
+    g_period_frames = 0;
+  const uint32_t slot = g_period_frames % FRAME_PERIOD_WINDOW;
+  if (g_period_frames >= FRAME_PERIOD_WINDOW)
+    g_frame_period_q8 = (edge_us - g_period_edges_us[slot]) *
+                        (256U / FRAME_PERIOD_WINDOW);
+  g_period_edges_us[slot] = edge_us;
+  g_period_frames++;
+}
+
+// =============================================================================
+// Active Line Count (Overscan)
+// =============================================================================
+// snes_line_count on PIO2 pushes the number of lines between each VBLANK
+// fall and rise. Every frame is captured as if it had 239 lines: a 224-line
+// frame is ended as soon as its count arrives (line 225), while the 239-line
+// count lands after the loop and is picked up at the next frame start. The
+// latest height is published with the line ring, where Core 1 latches it per
+// output frame to centre the picture, so a switch never costs a frame: at
+// worst the one frame being scanned out is placed for the old height.
+
+#define LINE_COUNT_SLACK 8U
+#define LINE_COUNT_OVERSCAN_SPLIT ((SNES_V_ACTIVE + SNES_V_ACTIVE_OVERSCAN + 1U) / 2U)
+
+static volatile uint32_t g_frame_lines = SNES_V_ACTIVE;
+
+static void line_count_init(void) {
+  pio_clear_instruction_memory(g_pio_lines);
+  *(volatile uint32_t *)((uintptr_t)g_pio_lines + 0x168) = 16;
+
+  const uint offset = pio_add_program(g_pio_lines, &snes_line_count_program);
+  g_sm_lines = pio_claim_unused_sm(g_pio_lines, true);
+  pio_sm_config c = snes_line_count_program_get_default_config(offset);
+  sm_config_set_clkdiv(&c, 1.0f);
+  pio_sm_init(g_pio_lines, g_sm_lines, offset, &c);
+  // Same IN_BASE as the capture SM (PIO input sync sees every GPIO whatever
+  // its function select); JMP_PIN = GP27 (VBLANK).
+  uint pin_idx = PIN_SNES_BASE - 16;
+  g_pio_lines->sm[g_sm_lines].pinctrl =
+      (g_pio_lines->sm[g_sm_lines].pinctrl & ~0x000f8000u) | (pin_idx << 15);
+  uint jmp_pin_idx = PIN_SNES_VBLANK - 16;
+  g_pio_lines->sm[g_sm_lines].execctrl =
+      (g_pio_lines->sm[g_sm_lines].execctrl & ~0x1f000000u) |
+      (jmp_pin_idx << 24);
+  pio_sm_set_enabled(g_pio_lines, g_sm_lines, true);
+}
+
+// Drain the counter's FIFO and publish the newest height. Returns false if
+// no frame has ended since the last call. Counts outside 224..239 (plus
+// slack) come from a glitched or partially seen frame and are ignored.
+static bool line_count_update(void) {
+  if (pio_sm_is_rx_fifo_empty(g_pio_lines, g_sm_lines))
+    return false;
+  uint32_t count = 0;
+  while (!pio_sm_is_rx_fifo_empty(g_pio_lines, g_sm_lines))
+    count = pio_sm_get(g_pio_lines, g_sm_lines);
+  if (count + LINE_COUNT_SLACK < SNES_V_ACTIVE ||
+      count > SNES_V_ACTIVE_OVERSCAN + LINE_COUNT_SLACK)
+    return true;
+
+  const uint32_t lines = (count >= LINE_COUNT_OVERSCAN_SPLIT)
+                             ? SNES_V_ACTIVE_OVERSCAN
+                             : SNES_V_ACTIVE;
+  if (lines != g_frame_lines) {
+    g_frame_lines = lines;
+    line_ring_set_lines(lines);
+  }
+  return true;
+}
+
+// =============================================================================
+// Core 0 Idle Time
+// =============================================================================
+// Time spent blocked on the SNES (waiting for the top of frame, line DMA)
+// over a ~1 s window, to compare the convert-at-capture and raw ring pipelines
+// on hardware.
+
+#define IDLE_WINDOW_US 1000000U
+
+static uint32_t g_idle_us = 0;
+static uint32_t g_idle_window_start_us = 0;
+static volatile uint32_t g_idle_permille = 0;
+
+static void idle_window_update(uint32_t now_us) {
+  const uint32_t elapsed_us = now_us - g_idle_window_start_us;
+  if (elapsed_us < IDLE_WINDOW_US)
+    return;
+  g_idle_permille = (uint32_t)(((uint64_t)g_idle_us * 1000U) / elapsed_us);
+  g_idle_us = 0;
+  g_idle_window_start_us = now_us;
+}
+
+// =============================================================================
+// Frame Sync
+// =============================================================================
+// With ENABLE_PIO_FRAME_SYNC the capture SM finds each top of frame (VBLANK
+// falling edge) itself and raises PIO IRQ 0 before it captures the frame's
+// first line, so capture starts with the same PIO latency every frame. Core 0
+// sleeps (WFE) through VBLANK; the interrupt timestamps the edge and wakes it
+// to set up the frame.
+//
+// Without it, Core 0 polls VBLANK for the edge and timestamps it, parks the
+// SM at its wrap target, and releases it with `irq 4` once the frame's DMA is
+// armed. The SM then captures every line until it is parked again.
+
+static volatile uint32_t g_frame_edges = 0;
+static volatile uint32_t g_frame_edge_us = 0;
+
+#if ENABLE_PIO_FRAME_SYNC
+#define CAPTURE_FRAME_IRQ 0U
+
+static void __not_in_flash_func(capture_frame_isr)(void) {
+  pio_interrupt_clear(g_pio_snes, CAPTURE_FRAME_IRQ);
+  g_frame_edge_us = time_us_32();
+  g_frame_edges++;
+}
+
+#if ENABLE_RAW_CAPTURE_RING
+// snes_line_count raises IRQ 0 on PIO2 after each push. Only the raw ring
+// sleeps on it; the count itself is still read by line_count_update().
+#define LINE_COUNT_IRQ 0U
+
+static void __not_in_flash_func(line_count_isr)(void) {
+  pio_interrupt_clear(g_pio_lines, LINE_COUNT_IRQ);
+}
+#endif
+
+static void frame_sync_init(void) {
+  const uint irq = pio_get_irq_num(g_pio_snes, 0);
+  pio_interrupt_clear(g_pio_snes, CAPTURE_FRAME_IRQ);
+  pio_set_irq0_source_enabled(g_pio_snes, pis_interrupt0, true);
+  irq_set_exclusive_handler(irq, capture_frame_isr);
+  irq_set_enabled(irq, true);
+#if ENABLE_RAW_CAPTURE_RING
+  const uint count_irq = pio_get_irq_num(g_pio_lines, 0);
+  pio_interrupt_clear(g_pio_lines, LINE_COUNT_IRQ);
+  pio_set_irq0_source_enabled(g_pio_lines, pis_interrupt0, true);
+  irq_set_exclusive_handler(count_irq, line_count_isr);
+  irq_set_enabled(count_irq, true);
+#endif
+}
+
+// The SM is already on its way to the first line.
+static void frame_sync_release(void) {}
+#else
+#define CAPTURE_RELEASE_IRQ 4U
+
+static void frame_sync_init(void) {}
+
+// Lightweight PIO reset at the top of frame: JMP back to wrap_target (skips
+// pull/mov y) with empty FIFOs, where the SM waits for the release.
+static void frame_sync_park(void) {
+  pio_sm_set_enabled(g_pio_snes, g_sm_pixel, false);
+  pio_sm_clear_fifos(g_pio_snes, g_sm_pixel);
+  pio_sm_exec(g_pio_snes, g_sm_pixel, pio_encode_jmp(g_offset_pixel + 2));
+  pio_sm_set_enabled(g_pio_snes, g_sm_pixel, true);
+}
+
+// Start capturing at the next HBLANK falling edge.
+static void frame_sync_release(void) {
+  pio_interrupt_clear(g_pio_snes, CAPTURE_RELEASE_IRQ);
+  pio_sm_exec(g_pio_snes, g_sm_pixel,
+              pio_encode_irq_set(false, CAPTURE_RELEASE_IRQ));
+}
+#endif
+
+// Every wait on the SNES is bounded: a console reset, cart swap or loose
+// cable stops PCLK, HBLANK or VBLANK, and the SM then never pushes the line
+// or raises the edge being waited for. A line is due within a couple of
+// line times, a top of frame within one frame of the last line.
+#define CAPTURE_LINE_TIMEOUT_US 500U
+#define CAPTURE_FRAME_TIMEOUT_US 25000U
+
+typedef enum {
+  CAPTURE_WAIT_OK,      // what was waited for arrived
+  CAPTURE_WAIT_SKIPPED, // the frame moved on first
+  CAPTURE_WAIT_TIMEOUT, // nothing came: the signal is gone
+} capture_wait_t;
+
+#if ENABLE_PIO_FRAME_SYNC
+// Sleep until the capture SM passes the next top of frame, for at most
+// timeout_us. Returns false on timeout; the edge's timestamp is
+// g_frame_edge_us.
+static bool wait_frame_start(uint32_t *edges_seen, uint32_t timeout_us) {
+  const uint32_t start_us = time_us_32();
+  const absolute_time_t deadline = make_timeout_time_us(timeout_us);
+  while (g_frame_edges == *edges_seen) {
+    if (best_effort_wfe_or_timeout(deadline))
+      break;
+  }
+  g_idle_us += time_us_32() - start_us;
+  if (g_frame_edges == *edges_seen)
+    return false;
+  *edges_seen = g_frame_edges;
+  return true;
+}
+#else
+// Poll VBLANK until it falls, for at most timeout_us; a frame joined with
+// VBLANK low is skipped. Returns false on timeout. On the edge, timestamps
+// it in g_frame_edge_us and parks the SM for the release.
+static bool wait_frame_start(uint32_t *edges_seen, uint32_t timeout_us) {
+  const uint32_t start_us = time_us_32();
+  bool vblank_seen = false;
+  while ((time_us_32() - start_us) < timeout_us) {
+    if (gpio_get(PIN_SNES_VBLANK)) {
+      vblank_seen = true;
+    } else if (vblank_seen) {
+      g_frame_edge_us = time_us_32();
+      g_frame_edges++;
+      break;
+    }
+    tight_loop_contents();
+  }
+  g_idle_us += time_us_32() - start_us;
+  if (g_frame_edges == *edges_seen)
+    return false;
+  *edges_seen = g_frame_edges;
+  frame_sync_park();
+  return true;
+}
+#endif
+
+#if ENABLE_RAW_CAPTURE_RING
+#if ENABLE_PIO_FRAME_SYNC
+// Sleep until the frame's line count arrives. SKIPPED if the next top of
+// frame comes first (a glitched frame whose count was dropped).
+static capture_wait_t wait_frame_end(uint32_t edges_seen) {
+  const uint32_t start_us = time_us_32();
+  const absolute_time_t deadline = make_timeout_time_us(CAPTURE_FRAME_TIMEOUT_US);
+  capture_wait_t result = CAPTURE_WAIT_SKIPPED;
+  while (g_frame_edges == edges_seen) {
+    if (line_count_update()) {
+      result = CAPTURE_WAIT_OK;
+      break;
+    }
+    if (best_effort_wfe_or_timeout(deadline)) {
+      result = line_count_update() ? CAPTURE_WAIT_OK : CAPTURE_WAIT_TIMEOUT;
+      break;
+    }
+  }
+  g_idle_us += time_us_32() - start_us;
+  return result;
+}
+#else
+// Poll for the frame's line count, pushed just after VBLANK rises. SKIPPED
+// if VBLANK rises and no count follows within a line timeout (a glitched
+// frame whose count was dropped).
+static capture_wait_t wait_frame_end(uint32_t edges_seen) {
+  (void)edges_seen;
+  const uint32_t start_us = time_us_32();
+  capture_wait_t result = CAPTURE_WAIT_TIMEOUT;
+  bool vblank_seen = false;
+  uint32_t vblank_us = 0;
+  while ((time_us_32() - start_us) < CAPTURE_FRAME_TIMEOUT_US) {
+    if (line_count_update()) {
+      result = CAPTURE_WAIT_OK;
+      break;
+    }
+    if (!vblank_seen) {
+      vblank_seen = gpio_get(PIN_SNES_VBLANK);
+      vblank_us = time_us_32();
+    } else if ((time_us_32() - vblank_us) >= CAPTURE_LINE_TIMEOUT_US) {
+      result = CAPTURE_WAIT_SKIPPED;
+      break;
+    }
+    tight_loop_contents();
+  }
+  g_idle_us += time_us_32() - start_us;
+  return result;
+}
+#endif
+#else
+// Wait for line y's DMA. The SM stops after the frame's last active line, so
+// past line 224 the line count decides instead: SKIPPED once it says the
+// frame ended before y.
+static capture_wait_t wait_line_dma(uint16_t y) {
+  const uint32_t start_us = time_us_32();
+  capture_wait_t result = CAPTURE_WAIT_OK;
+  while (dma_channel_is_busy(g_dma_chan)) {
+    if (y >= SNES_V_ACTIVE && line_count_update() && y >= g_frame_lines) {
+      result = CAPTURE_WAIT_SKIPPED;
+      break;
+    }
+    if ((time_us_32() - start_us) >= CAPTURE_LINE_TIMEOUT_US) {
+      result = CAPTURE_WAIT_TIMEOUT;
+      break;
+    }
+    tight_loop_contents();
+  }
+  g_idle_us += time_us_32() - start_us;
+  return result;
+}
+#endif
+
+// =============================================================================
+// Raw Capture Ring
+// =============================================================================
+// One DMA transfer per frame instead of one per line: channel A streams from
+// the frame's first ring line towards the end of the buffer and chains to B,
+// which carries on from the start. Together they take a 239-line frame plus
+// the line VBLANK rises in, which the SM still captures (blank, and the next
+// frame overwrites it), so the SM never stalls on a full FIFO mid-line. A
+// 224-line frame's stream is parked unfinished at the next top of frame.
+
+#define RAW_STREAM_LINES (SNES_V_ACTIVE_OVERSCAN + 1U)
+
+#if ENABLE_RAW_CAPTURE_RING
+static void raw_stream_init(void) {
+  const uint dreq = pio_get_dreq(g_pio_snes, g_sm_pixel, false);
+  for (int i = 0; i < 2; i++) {
+    g_raw_dma_chan[i] = dma_claim_unused_channel(true);
+    g_line_ring.raw_write_addr[i] = &dma_hw->ch[g_raw_dma_chan[i]].write_addr;
+  }
+  g_raw_dma_config = dma_channel_get_default_config(g_raw_dma_chan[0]);
+  channel_config_set_read_increment(&g_raw_dma_config, false);
+  channel_config_set_write_increment(&g_raw_dma_config, true);
+  channel_config_set_dreq(&g_raw_dma_config, dreq);
+  g_raw_dma_config_chain = g_raw_dma_config;
+  channel_config_set_chain_to(&g_raw_dma_config_chain, g_raw_dma_chan[1]);
+
+  dma_channel_config b = dma_channel_get_default_config(g_raw_dma_chan[1]);
+  channel_config_set_read_increment(&b, false);
+  channel_config_set_write_increment(&b, true);
+  channel_config_set_dreq(&b, dreq);
+  for (int i = 0; i < 2; i++) {
+    dma_channel_configure(g_raw_dma_chan[i], i ? &b : &g_raw_dma_config,
+                          g_line_ring.pixels, &g_pio_snes->rxf[g_sm_pixel], 0,
+                          false);
+  }
+}
+
+// Core 1 falls back to the committed write index until raw_stream_start().
+static void raw_stream_stop(void) {
+  g_line_ring.raw_seq |= 1U;
+  __dmb();
+  dma_channel_abort(g_raw_dma_chan[0]);
+  dma_channel_abort(g_raw_dma_chan[1]);
+}
+
+// Arm the stream for the frame line_ring_vsync() just opened.
+static void raw_stream_start(void) {
+  const uint32_t first_unit = line_ring_unit(g_line_ring.frame_base_idx);
+  const uint32_t lines_to_end =
+      (LINE_RING_UNITS - first_unit) / g_line_ring.units_per_line;
+  const uint32_t a_lines =
+      (lines_to_end < RAW_STREAM_LINES) ? lines_to_end : RAW_STREAM_LINES;
+  const uint32_t b_lines = RAW_STREAM_LINES - a_lines;
+  uint16_t *a_dst = &g_line_ring.pixels[first_unit * LINE_WIDTH];
+
+  dma_channel_set_config(g_raw_dma_chan[0],
+                         b_lines ? &g_raw_dma_config_chain : &g_raw_dma_config,
+                         false);
+  dma_channel_set_trans_count(g_raw_dma_chan[1], b_lines * CAPTURE_LINE_WORDS,
+                              false);
+  dma_channel_set_write_addr(g_raw_dma_chan[1], g_line_ring.pixels, false);
+  dma_channel_set_trans_count(g_raw_dma_chan[0], a_lines * CAPTURE_LINE_WORDS,
+                              false);
+  g_line_ring.raw_start[0] = (uint32_t)(uintptr_t)a_dst;
+  g_line_ring.raw_start[1] = (uint32_t)(uintptr_t)g_line_ring.pixels;
+  g_line_ring.raw_a_bytes = a_lines * LINE_RING_RAW_LINE_BYTES;
+  dma_channel_set_write_addr(g_raw_dma_chan[0], a_dst, true);
+  __dmb();
+  g_line_ring.raw_seq++;
+}
+#endif
 
 // =============================================================================
 // Internal Helpers
 // =============================================================================
 
+// Leaves the SM disabled with its line length queued: video_capture_run()
+// starts it once the DMA is in place.
 static void video_capture_reset_hardware(void) {
   pio_sm_set_enabled(g_pio_snes, g_sm_pixel, false);
   pio_sm_clear_fifos(g_pio_snes, g_sm_pixel);
   pio_sm_init(g_pio_snes, g_sm_pixel, g_offset_pixel, &g_pio_config);
   // Reapply IN_BASE after pio_sm_init (which resets pinctrl).
-  // pin index 11 = GP27 (VBLANK) with GPIOBASE=16.
-  uint pin_idx = PIN_SNES_BASE - 16;
+  // pin index 11 = GP27 (VBLANK) with GPIOBASE=16, or 13 = GP29 (B4) for the
+  // packed programs.
+  uint pin_idx = CAPTURE_IN_BASE_PIN - 16;
   g_pio_snes->sm[g_sm_pixel].pinctrl =
       (g_pio_snes->sm[g_sm_pixel].pinctrl & ~0x000f8000u) | (pin_idx << 15);
-  pio_sm_set_enabled(g_pio_snes, g_sm_pixel, true);
+  // JMP_PIN = GP45 (PIXEL_VALID), also GPIOBASE-relative.
+  uint jmp_pin_idx = PIN_SNES_PIXEL_VALID - 16;
+  g_pio_snes->sm[g_sm_pixel].execctrl =
+      (g_pio_snes->sm[g_sm_pixel].execctrl & ~0x1f000000u) |
+      (jmp_pin_idx << 24);
   pio_sm_put_blocking(g_pio_snes, g_sm_pixel, SNES_H_ACTIVE - 1);
 }
 
+// =============================================================================
+// Sampling Phase
+// =============================================================================
+// Where the TST bus is sampled: `skip` dot clocks after HBLANK falls (the
+// `set x` at the program's skip label counts down skip - 1), and `delay`
+// extra PIO cycles on the hold instruction between the PCLK edge and the
+// `in pins`. Consoles and wire lengths need different margins, so both are
+// rewritten in the loaded program while the SM is stopped, with no reflash.
+//
+// A PCLK edge reaches `in pins` after CAPTURE_SAMPLE_CYCLES plus the delay
+// (two cycles of input sync, the `wait`, the pin test and the hold), and
+// the loop must be back at the next PCLK wait CAPTURE_LOOP_CYCLES plus the
+// delay after the edge, within one sample period: half a dot when hires
+// sub-pixels are sampled after the falling edge. The persisted phase is the
+// edge-to-sample time in ns, which carries over between output modes'
+// sysclks.
+
+#define CAPTURE_SKIP_DEFAULT 20U
+#define CAPTURE_SKIP_MIN 16U
+#define CAPTURE_SKIP_MAX 24U
+#define CAPTURE_SAMPLE_CYCLES 5U
+#define CAPTURE_LOOP_CYCLES 7U
+#define CAPTURE_DELAY_LIMIT 31U // instruction delay field (no side-set)
+
+static uint32_t g_phase_skip = CAPTURE_SKIP_DEFAULT;
+static uint32_t g_phase_delay = 0;
+static uint32_t g_phase_delay_max = 0;
+static uint32_t g_phase_sample_ns = 0; // requested; 0 = no extra delay
+
+static uint32_t capture_cycles_to_ns(uint32_t cycles) {
+  return (uint32_t)(((uint64_t)cycles * 1000000000ULL) / clock_get_hz(clk_sys));
+}
+
+static void capture_phase_init(void) {
+  const uint32_t sys_hz = clock_get_hz(clk_sys);
+  const uint32_t master_hz = (g_region == SNES_REGION_PAL)
+                                 ? SNES_MASTER_CLOCK_PAL_HZ
+                                 : SNES_MASTER_CLOCK_HZ;
+  const uint32_t period_cycles = (uint32_t)(((uint64_t)sys_hz * 4U) /
+                                            ((uint64_t)master_hz *
+                                             CAPTURE_SAMPLES_PER_DOT));
+  g_phase_delay_max = (period_cycles > CAPTURE_LOOP_CYCLES)
+                          ? period_cycles - CAPTURE_LOOP_CYCLES
+                          : 0U;
+  if (g_phase_delay_max > CAPTURE_DELAY_LIMIT)
+    g_phase_delay_max = CAPTURE_DELAY_LIMIT;
+
+  g_phase_delay = 0;
+  if (g_phase_sample_ns != 0U) {
+    const uint32_t cycles = (uint32_t)((((uint64_t)g_phase_sample_ns * sys_hz) +
+                                        500000000ULL) /
+                                       1000000000ULL);
+    g_phase_delay = (cycles > CAPTURE_SAMPLE_CYCLES)
+                        ? cycles - CAPTURE_SAMPLE_CYCLES
+                        : 0U;
+    if (g_phase_delay > g_phase_delay_max)
+      g_phase_delay = g_phase_delay_max;
+  }
+}
+
+// Only with the SM stopped. PIO instruction memory is write-only, so the
+// patched words start from the program image (no jumps: nothing to
+// relocate).
+static void capture_phase_write(void) {
+  volatile uint32_t *mem = &g_pio_snes->instr_mem[g_offset_pixel];
+  const uint delay = pio_encode_delay(g_phase_delay);
+  mem[CAPTURE_OFFSET_SKIP] = pio_encode_set(pio_x, g_phase_skip - 1U);
+  mem[CAPTURE_OFFSET_HOLD] =
+      CAPTURE_PROGRAM.instructions[CAPTURE_OFFSET_HOLD] | delay;
+#ifdef CAPTURE_OFFSET_SUB_HOLD
+  mem[CAPTURE_OFFSET_SUB_HOLD] =
+      CAPTURE_PROGRAM.instructions[CAPTURE_OFFSET_SUB_HOLD] | delay;
+#endif
+}
+
+// Between frames (the SM is idle in VBLANK): the SM restarts at its
+// prologue and picks up the next top of frame as usual.
+static void capture_phase_apply(uint32_t skip, uint32_t delay) {
+  g_phase_skip = skip;
+  g_phase_delay = delay;
+  pio_sm_set_enabled(g_pio_snes, g_sm_pixel, false);
+  capture_phase_write();
+  video_capture_reset_hardware();
+  pio_sm_set_enabled(g_pio_snes, g_sm_pixel, true);
+}
+
+// Eye scan. After each phase change the first frame is a reference and the
+// next CAL_COMPARE_FRAMES are compared with the frame before, line by line,
+// as XOR folds of the captured words: a bit that toggles between frames
+// shows up in its line's fold. The delay sweep scores the line interior;
+// the skip sweep then scores the outermost word at either end, where a skip
+// off by a dot or more samples the undriven bus. Animation raises every
+// point's score alike, so the eye is the longest run of points within a
+// margin of the best.
+
+#define CAL_COMPARE_FRAMES 2U
+#define CAL_NOISE_BITS 16U
+#define CAL_SKIP_POINTS (CAPTURE_SKIP_MAX - CAPTURE_SKIP_MIN + 1U)
+// Words the skip sweep can move in or out of a line at either end.
+#define CAL_EDGE_WORDS                                                         \
+  ((((CAPTURE_SKIP_MAX - CAPTURE_SKIP_DEFAULT) * CAPTURE_LINE_WORDS) +         \
+    SNES_H_ACTIVE - 1U) /                                                      \
+   SNES_H_ACTIVE)
+
+typedef enum {
+  CAL_IDLE,
+  CAL_DELAY, // sweeping the delay at the starting skip
+  CAL_SKIP,  // sweeping the skip at the chosen delay
+} cal_stage_t;
+
+static volatile bool g_cal_requested = false;
+static volatile cal_stage_t g_cal_stage = CAL_IDLE;
+static volatile bool g_cal_done = false;
+static volatile uint32_t g_cal_points_done = 0;
+static volatile uint32_t g_cal_eye_lo_ns = 0;
+static volatile uint32_t g_cal_eye_hi_ns = 0;
+static uint32_t g_cal_point = 0; // delay, or skip - CAPTURE_SKIP_MIN
+static uint32_t g_cal_frame = 0; // frames captured at this point
+static uint32_t g_cal_errors = 0;
+static uint32_t g_cal_score[CAPTURE_DELAY_LIMIT + 1U];
+static uint32_t g_cal_start_skip = 0;
+static uint32_t g_cal_start_delay = 0;
+static uint32_t g_cal_interior[SNES_V_ACTIVE_OVERSCAN];
+static uint32_t g_cal_edges[SNES_V_ACTIVE_OVERSCAN];
+
+static void calibration_line(uint16_t y, const uint32_t *words) {
+  uint32_t interior = 0;
+  for (uint32_t i = CAL_EDGE_WORDS; i < CAPTURE_LINE_WORDS - CAL_EDGE_WORDS;
+       i++)
+    interior ^= words[i];
+  const uint32_t edges = words[0] ^ words[CAPTURE_LINE_WORDS - 1U];
+  if (g_cal_frame != 0U) {
+    const uint32_t diff = (g_cal_stage == CAL_DELAY)
+                              ? (interior ^ g_cal_interior[y])
+                              : (edges ^ g_cal_edges[y]);
+    g_cal_errors += (uint32_t)__builtin_popcount(diff);
+  }
+  g_cal_interior[y] = interior;
+  g_cal_edges[y] = edges;
+}
+
+// Highest score that still counts as stable: within a margin of the best.
+static uint32_t calibration_limit(uint32_t count) {
+  uint32_t best = UINT32_MAX;
+  for (uint32_t i = 0; i < count; i++) {
+    if (g_cal_score[i] < best)
+      best = g_cal_score[i];
+  }
+  return best + (best >> 2) + CAL_NOISE_BITS;
+}
+
+// Longest run of stable points.
+static void calibration_eye(uint32_t count, uint32_t *lo, uint32_t *hi) {
+  const uint32_t limit = calibration_limit(count);
+  uint32_t run_start = 0;
+  uint32_t best_len = 0;
+  for (uint32_t i = 0; i <= count; i++) {
+    if (i < count && g_cal_score[i] <= limit)
+      continue;
+    if (i - run_start > best_len) {
+      best_len = i - run_start;
+      *lo = run_start;
+      *hi = i - 1U;
+    }
+    run_start = i + 1U;
+  }
+}
+
+static void calibration_start(void) {
+  g_cal_requested = false;
+  g_cal_start_skip = g_phase_skip;
+  g_cal_start_delay = g_phase_delay;
+  g_cal_points_done = 0;
+  g_cal_point = 0;
+  g_cal_frame = 0;
+  g_cal_errors = 0;
+  g_cal_stage = CAL_DELAY;
+  capture_phase_apply(g_phase_skip, 0U);
+}
+
+// Scan over: keep the delay at the centre of the eye and, of the skips
+// whose edges held still, the one nearest where the scan started.
+static void calibration_finish(void) {
+  const uint32_t limit = calibration_limit(CAL_SKIP_POINTS);
+  uint32_t skip = g_cal_start_skip;
+  uint32_t skip_dist = UINT32_MAX;
+  for (uint32_t i = 0; i < CAL_SKIP_POINTS; i++) {
+    if (g_cal_score[i] > limit)
+      continue;
+    const uint32_t s = CAPTURE_SKIP_MIN + i;
+    const uint32_t dist =
+        (s > g_cal_start_skip) ? s - g_cal_start_skip : g_cal_start_skip - s;
+    if (dist < skip_dist) {
+      skip_dist = dist;
+      skip = s;
+    }
+  }
+  g_cal_stage = CAL_IDLE;
+  g_cal_done = true;
+  capture_phase_apply(skip, g_phase_delay);
+}
+
+// A frame was captured end to end. The raw ring's lines are still in the
+// ring until the next frame lands on them.
+static void calibration_frame_done(void) {
+  if (g_cal_stage == CAL_IDLE) {
+    if (g_cal_requested)
+      calibration_start();
+    return;
+  }
+#if ENABLE_RAW_CAPTURE_RING
+  for (uint16_t y = 0; y < g_frame_lines; y++)
+    calibration_line(y, (const uint32_t *)line_ring_write_ptr(y));
+#endif
+  if (g_cal_frame++ < CAL_COMPARE_FRAMES)
+    return;
+  g_cal_score[g_cal_point] = g_cal_errors;
+  g_cal_points_done++;
+  g_cal_frame = 0;
+  g_cal_errors = 0;
+
+  if (g_cal_stage == CAL_DELAY) {
+    if (g_cal_point < g_phase_delay_max) {
+      g_cal_point++;
+      capture_phase_apply(g_phase_skip, g_cal_point);
+      return;
+    }
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+    calibration_eye(g_phase_delay_max + 1U, &lo, &hi);
+    g_cal_eye_lo_ns = capture_cycles_to_ns(CAPTURE_SAMPLE_CYCLES + lo);
+    g_cal_eye_hi_ns = capture_cycles_to_ns(CAPTURE_SAMPLE_CYCLES + hi);
+    g_cal_stage = CAL_SKIP;
+    g_cal_point = 0;
+    capture_phase_apply(CAPTURE_SKIP_MIN, lo + ((hi - lo) / 2U));
+    return;
+  }
+  if (g_cal_point + 1U < CAL_SKIP_POINTS) {
+    g_cal_point++;
+    capture_phase_apply(CAPTURE_SKIP_MIN + g_cal_point, g_phase_delay);
+    return;
+  }
+  calibration_finish();
+}
+
+// The SM is about to be reset by the caller.
+static void calibration_abort(void) {
+  if (g_cal_stage == CAL_IDLE)
+    return;
+  g_cal_stage = CAL_IDLE;
+  g_phase_skip = g_cal_start_skip;
+  g_phase_delay = g_cal_start_delay;
+  pio_sm_set_enabled(g_pio_snes, g_sm_pixel, false);
+  capture_phase_write();
+}
+
+// =============================================================================
+// Signal Loss
+// =============================================================================
+// A timed-out wait means the SNES stopped mid-line or mid-frame. Capture then
+// drops what it has in flight, restarts the SM so it looks for a fresh top of
+// frame, and opens an empty NO_SIGNAL frame in the ring: Core 1 shows the
+// no-signal screen from its next vsync rather than freezing on the last
+// picture. The next top of frame starts reacquiring, and the first frame
+// captured without a timeout relocks.
+//
+// Time to relock runs from the first sign of the console clocking again
+// (an HBLANK edge, probed between frame waits, or the top of frame itself if
+// that comes first) to the end of that first good frame.
+
+#define NO_SIGNAL_POLL_US 1000U
+#define HBLANK_PROBE_US 130U // two lines
+
+typedef enum {
+  CAPTURE_LOCKED,
+  CAPTURE_NO_SIGNAL,
+  CAPTURE_REACQUIRE, // capturing the first frame since a top of frame came back
+} capture_state_t;
+
+// Boot counts as a reacquire from capture start, without a loss.
+static volatile capture_state_t g_capture_state = CAPTURE_NO_SIGNAL;
+static uint32_t g_signal_back_us = 0;
+static bool g_signal_back = false;
+static volatile uint32_t g_signal_losses = 0;
+static volatile uint32_t g_relock_us = 0;
+static volatile uint32_t g_relock_max_us = 0;
+
+static bool hblank_toggling(void) {
+  const bool level = gpio_get(PIN_SNES_HBLANK);
+  const uint32_t start_us = time_us_32();
+  while ((time_us_32() - start_us) < HBLANK_PROBE_US) {
+    if (gpio_get(PIN_SNES_HBLANK) != level)
+      return true;
+    tight_loop_contents();
+  }
+  return false;
+}
+
+static void capture_signal_lost(void) {
+#if ENABLE_RAW_CAPTURE_RING
+  raw_stream_stop();
+#else
+  dma_channel_abort(g_dma_chan);
+#endif
+  if (g_capture_state == CAPTURE_LOCKED)
+    g_signal_losses++;
+  g_capture_state = CAPTURE_NO_SIGNAL;
+  g_signal_back = false;
+  line_ring_vsync(g_field_flags | LINE_RING_NO_SIGNAL);
+  calibration_abort();
+  // The SM may be stalled mid-line on a stopped PCLK; start it over at its
+  // prologue, with empty FIFOs.
+  video_capture_reset_hardware();
+  pio_sm_set_enabled(g_pio_snes, g_sm_pixel, true);
+}
+
+// Between frame waits while there is no signal: note when the console comes
+// back.
+static void capture_signal_probe(void) {
+  if (!g_signal_back && hblank_toggling()) {
+    g_signal_back = true;
+    g_signal_back_us = time_us_32();
+  }
+}
+
+// A top of frame arrived. The period since the last one spans the outage,
+// which field detection and the region monitor already treat as a reacquire.
+static void capture_frame_started(uint32_t edge_us) {
+  if (g_capture_state != CAPTURE_NO_SIGNAL)
+    return;
+  g_capture_state = CAPTURE_REACQUIRE;
+  if (!g_signal_back) {
+    g_signal_back = true;
+    g_signal_back_us = edge_us;
+  }
+}
+
+// The frame was captured end to end.
+static void capture_frame_done(void) {
+  if (g_capture_state != CAPTURE_REACQUIRE)
+    return;
+  g_capture_state = CAPTURE_LOCKED;
+  const uint32_t relock_us = time_us_32() - g_signal_back_us;
+  g_relock_us = relock_us;
+  if (relock_us > g_relock_max_us)
+    g_relock_max_us = relock_us;
+}
+
 // =============================================================================
 // Public API
 // =============================================================================
 
-void video_capture_init(uint32_t height) {
-  g_snes_height = height;
+snes_region_t video_capture_detect_region(uint32_t timeout_ms) {
+#if ENABLE_PALMODE_PIN
+  (void)timeout_ms;
+  gpio_init(PIN_SNES_PALMODE);
+  gpio_set_dir(PIN_SNES_PALMODE, GPIO_IN);
+  gpio_pull_down(PIN_SNES_PALMODE);
+  sleep_us(10);
+  return gpio_get(PIN_SNES_PALMODE) ? SNES_REGION_PAL : SNES_REGION_NTSC;
+#else
+  gpio_init(PIN_SNES_VBLANK);
+  gpio_set_dir(PIN_SNES_VBLANK, GPIO_IN);
+
+  // Time two consecutive VBLANK falling edges. No console (or no clock)
+  // within the timeout means NTSC; the capture loop corrects it later.
+  const uint32_t start_us = time_us_32();
+  const uint32_t timeout_us = timeout_ms * 1000U;
+  uint32_t last_fall_us = 0;
+  bool have_fall = false;
+  while ((time_us_32() - start_us) < timeout_us) {
+    while (!gpio_get(PIN_SNES_VBLANK)) {
+      if ((time_us_32() - start_us) >= timeout_us)
+        return SNES_REGION_NTSC;
+      tight_loop_contents();
+    }
+    while (gpio_get(PIN_SNES_VBLANK)) {
+      if ((time_us_32() - start_us) >= timeout_us)
+        return SNES_REGION_NTSC;
+      tight_loop_contents();
+    }
+    const uint32_t now_us = time_us_32();
+    if (have_fall && region_period_plausible(now_us - last_fall_us)) {
+      return region_from_period(now_us - last_fall_us);
+    }
+    last_fall_us = now_us;
+    have_fall = true;
+  }
+  return SNES_REGION_NTSC;
+#endif
+}
+
+void video_capture_init(snes_region_t region) {
+  g_region = region;
+  g_frame_lines = SNES_REGION_V_ACTIVE(region);
+  line_ring_set_lines(g_frame_lines);
+  field_detect_init(region);
+#if !ENABLE_LEAN_CONVERT
   generate_pixel_lut();
+  interp_convert_init(); // Core 0, like the capture loop and the benchmark
+#endif
+  generate_brightness_luts();
+
+#if ENABLE_FIELD_PIN
+  gpio_init(PIN_SNES_FIELD);
+  gpio_set_dir(PIN_SNES_FIELD, GPIO_IN);
+#endif
+
+#if ENABLE_BRIGHTNESS
+  // Pulled up so a board without the QSB latch reads full brightness.
+  for (uint pin = PIN_SNES_BRIGHT0; pin <= PIN_SNES_BRIGHT3; pin++) {
+    gpio_init(pin);
+    gpio_set_dir(pin, GPIO_IN);
+    gpio_pull_up(pin);
+  }
+#endif
 
   pio_clear_instruction_memory(g_pio_snes);
 
@@ -94,45 +1481,103 @@ void video_capture_init(uint32_t height) {
   pio_set_gpio_base(pio0, 0);
   pio_set_gpio_base(pio1, 0);
   *(volatile uint32_t *)((uintptr_t)g_pio_snes + 0x168) = 16;
+  line_count_init();
 
-  g_offset_pixel = pio_add_program(g_pio_snes, &snes_hard_sync_program);
+  g_offset_pixel = pio_add_program(g_pio_snes, &CAPTURE_PROGRAM);
   g_sm_pixel = pio_claim_unused_sm(g_pio_snes, true);
+  capture_phase_init();
+  capture_phase_write();
 
-  // Initialize all capture GPIOs GP27-GP44 (VBLANK, PCLK, B, G, R, HBLANK).
+  // Initialize all capture GPIOs GP27-GP45 (VBLANK, PCLK, B, G, R, HBLANK,
+  // PIXEL_VALID).
   for (uint pin = PIN_SNES_BASE; pin <= SNES_CAPTURE_PIN_LAST; pin++) {
     pio_gpio_init(g_pio_snes, pin);
     gpio_disable_pulls(pin);
     gpio_set_input_enabled(pin, true);
     gpio_set_input_hysteresis_enabled(pin, true);
   }
+  // Pulled up so a board without the QSB AND gate reads every pixel valid.
+  gpio_pull_up(PIN_SNES_PIXEL_VALID);
 
-  g_pio_config = snes_hard_sync_program_get_default_config(g_offset_pixel);
+  g_pio_config = CAPTURE_PROGRAM_GET_DEFAULT_CONFIG(g_offset_pixel);
   sm_config_set_clkdiv(&g_pio_config, 1.0f);
-  // Autopush every 18 bits (one full capture word per pixel).
-  sm_config_set_in_shift(&g_pio_config, false, true, SNES_CAPTURE_BITS);
+#if ENABLE_PACKED_CAPTURE
+  // Right shift, autopush every 32 bits: two 16-bit samples per word, the
+  // first in the low half.
+  sm_config_set_in_shift(&g_pio_config, true, true, CAPTURE_PUSH_BITS);
+#else
+  // Autopush every 19 bits (one full capture word per sample).
+  sm_config_set_in_shift(&g_pio_config, false, true, CAPTURE_PUSH_BITS);
+#endif
 
   // video_capture_reset_hardware() calls pio_sm_init and applies IN_BASE.
   video_capture_reset_hardware();
 
+#if ENABLE_RAW_CAPTURE_RING
+  raw_stream_init();
+#else
   g_dma_chan = dma_claim_unused_channel(true);
   dma_channel_config dc = dma_channel_get_default_config(g_dma_chan);
   channel_config_set_read_increment(&dc, false);
   channel_config_set_write_increment(&dc, true);
   channel_config_set_dreq(&dc, pio_get_dreq(g_pio_snes, g_sm_pixel, false));
   dma_channel_configure(g_dma_chan, &dc, g_line_buffers[0],
-                        &g_pio_snes->rxf[g_sm_pixel], SNES_H_ACTIVE, false);
+                        &g_pio_snes->rxf[g_sm_pixel], CAPTURE_LINE_WORDS,
+                        false);
+#endif
+  frame_sync_init();
 }
 
 void video_capture_run(void) {
 #if ENABLE_AUDIO && ENABLE_AUDIO_REARM_ON_VIDEO_REACQUIRE
   uint32_t last_frame_ms = 0;
 #endif
+  uint32_t last_vblank_us = 0;
+  uint32_t edges_seen = g_frame_edges;
+  g_idle_window_start_us = time_us_32();
+  g_signal_back_us = g_idle_window_start_us;
+  g_signal_back = true;
+#if ENABLE_RAW_CAPTURE_RING
+  bool frame_closed = false;
+#else
+  uint32_t buf_idx = 0;
+  dma_channel_set_trans_count(g_dma_chan, CAPTURE_LINE_WORDS, false);
+  dma_channel_set_write_addr(g_dma_chan, g_line_buffers[0], true);
+#endif
+  // From here on the SM syncs to the SNES on its own, or waits for Core 0's
+  // release.
+  pio_sm_set_enabled(g_pio_snes, g_sm_pixel, true);
+
   while (1) {
-    // 1. Detect VSync Falling Edge (Active Video Start) in C
-    while (!gpio_get(PIN_SNES_VBLANK))
-      tight_loop_contents(); // Wait for Blanking
-    while (gpio_get(PIN_SNES_VBLANK))
-      tight_loop_contents(); // Wait for Active Video
+    // 1. Wait for the top of a frame (VBLANK falling edge). Its first line
+    //    is still most of a line away. Without a signal, give up every
+    //    millisecond to look for the console coming back.
+    if (g_capture_state == CAPTURE_NO_SIGNAL) {
+      if (!wait_frame_start(&edges_seen, NO_SIGNAL_POLL_US)) {
+        capture_signal_probe();
+        continue;
+      }
+    } else if (!wait_frame_start(&edges_seen, CAPTURE_FRAME_TIMEOUT_US)) {
+      capture_signal_lost();
+#if ENABLE_RAW_CAPTURE_RING
+      frame_closed = true;
+#endif
+      continue;
+    }
+    const uint32_t edge_us = g_frame_edge_us;
+    capture_frame_started(edge_us);
+#if ENABLE_RAW_CAPTURE_RING
+    // Park the last frame's stream before the ring moves on to the next.
+    raw_stream_stop();
+#else
+    // The armed buffer holds nothing, or the line VBLANK rose in: restart the
+    // ping-pong so line 0 lands in buffer 0.
+    dma_channel_abort(g_dma_chan);
+    buf_idx = 0;
+    dma_channel_set_trans_count(g_dma_chan, CAPTURE_LINE_WORDS, false);
+    dma_channel_set_write_addr(g_dma_chan, g_line_buffers[0], true);
+    frame_sync_release();
+#endif
 
     g_frame_count++;
 #if ENABLE_AUDIO && ENABLE_AUDIO_REARM_ON_VIDEO_REACQUIRE
@@ -149,55 +1594,239 @@ void video_capture_run(void) {
     }
     // freq_counter_update(); // TODO: enable after debugging
 
-    // 2. Lightweight PIO reset — JMP back to wrap_target (skips pull/mov y)
-    pio_sm_set_enabled(g_pio_snes, g_sm_pixel, false);
-    pio_sm_clear_fifos(g_pio_snes, g_sm_pixel);
-    pio_sm_exec(g_pio_snes, g_sm_pixel,
-                pio_encode_jmp(g_offset_pixel + 2));
-    pio_sm_set_enabled(g_pio_snes, g_sm_pixel, true);
-    dma_channel_set_trans_count(g_dma_chan, SNES_H_ACTIVE, false);
-    dma_channel_set_write_addr(g_dma_chan, g_line_buffers[0], true);
-
-    // Signal VSYNC to Core 1
-    line_ring_vsync();
+    // 2. Signal VSYNC to Core 1. The period comes from the edge timestamps,
+    //    so it does not depend on how soon Core 0 woke.
+    const uint32_t period_us = edge_us - last_vblank_us;
+    last_vblank_us = edge_us;
+    idle_window_update(time_us_32());
+    region_monitor_update(period_us);
+    frame_period_update(edge_us, period_us);
+#if ENABLE_INTERLACE
+    g_field_flags = field_detect_update(period_us);
+#endif
+    line_count_update();
+#if ENABLE_RAW_CAPTURE_RING
+    // A frame whose count never came is closed at the last known height.
+    // Brightness is sampled once per frame here, since no CPU sees the lines
+    // go by.
+    if (!frame_closed)
+      line_ring_end_frame((uint16_t)g_frame_lines);
+    line_ring_vsync(g_field_flags |
+                    (read_brightness() << LINE_RING_BRIGHTNESS_SHIFT));
+    raw_stream_start();
+    frame_sync_release();
 
-    // 3. Release PIO to start capturing lines
-    pio_interrupt_clear(g_pio_snes, 4);
-    pio_sm_exec(g_pio_snes, g_sm_pixel, pio_encode_irq_set(false, 4));
+    // 3. Close the frame when its count arrives: the SM captures nothing
+    //    past it, and Core 1 must see the tail of a 224-line frame in a
+    //    239-line window as out of frame, not as lines still to come.
+    const capture_wait_t end = wait_frame_end(edges_seen);
+    frame_closed = (end == CAPTURE_WAIT_OK);
+    if (frame_closed) {
+      line_ring_end_frame((uint16_t)g_frame_lines);
+      capture_frame_done();
+      calibration_frame_done();
+    } else if (end == CAPTURE_WAIT_TIMEOUT) {
+      capture_signal_lost();
+      frame_closed = true;
+    }
+#else
+    line_ring_vsync(g_field_flags);
+    const uint16_t max_width = line_ring_max_width();
 
-    uint32_t buf_idx = 0;
-    for (uint16_t y = 0; y < g_snes_height; y++) {
+    // 3. Convert lines as the SM delivers them.
+    capture_wait_t wait = CAPTURE_WAIT_OK;
+    for (uint16_t y = 0; y < SNES_V_ACTIVE_OVERSCAN; y++) {
+#if ENABLE_INDEXED_LINES
+      uint16_t *dst = g_index_line;
+#else
       uint16_t *dst = line_ring_write_ptr(y);
+#endif
+
+      // Past line 224 a pending count means VBLANK has begun: end the frame
+      // here so it takes no more of the ring than it needs. A timeout ends
+      // it too, with what has landed.
+      wait = wait_line_dma(y);
+      if (wait != CAPTURE_WAIT_OK) {
+        line_ring_end_frame(y);
+        break;
+      }
 
-      dma_channel_wait_for_finish_blocking(g_dma_chan);
+      // Sample the $2100 latch as the line's DMA completes: still the value
+      // this line was drawn with, since HDMA writes land later in HBLANK.
+      const uint32_t brightness = read_brightness();
 
       uint32_t *captured_buf = g_line_buffers[buf_idx];
       buf_idx ^= 1U;
 
-      if (y + 1 < g_snes_height) {
-        dma_channel_set_trans_count(g_dma_chan, SNES_H_ACTIVE, false);
-        dma_channel_set_write_addr(g_dma_chan, g_line_buffers[buf_idx], true);
-      }
+      // Always re-arm: after the last active line the SM still pushes the
+      // line VBLANK rises in (or, polled, every line until it is parked),
+      // and must not stall mid-line on a full FIFO.
+      dma_channel_set_trans_count(g_dma_chan, CAPTURE_LINE_WORDS, false);
+      dma_channel_set_write_addr(g_dma_chan, g_line_buffers[buf_idx], true);
 
-      // Unrolled 4-pixel conversion (matches neopico-hd)
-      const uint16_t *lut = g_pixel_lut;
-      const uint32_t *src = captured_buf;
-      int remaining = SNES_H_ACTIVE;
-      while (remaining >= 4) {
-        dst[0] = lut[(src[0] >> 2) & 0x7FFF];
-        dst[1] = lut[(src[1] >> 2) & 0x7FFF];
-        dst[2] = lut[(src[2] >> 2) & 0x7FFF];
-        dst[3] = lut[(src[3] >> 2) & 0x7FFF];
-        dst += 4;
-        src += 4;
-        remaining -= 4;
-      }
-      while (remaining-- > 0)
-        *dst++ = lut[(*src++ >> 2) & 0x7FFF];
+      const uint16_t width =
+          convert_captured_line(dst, captured_buf, brightness, max_width);
 
+#if ENABLE_INDEXED_LINES
+      store_line(y, dst, width);
+#else
+      line_ring_set_width(y, width);
+#endif
+      line_ring_stamp(y, time_us_32());
       line_ring_commit(y + 1);
+      if (g_cal_stage != CAL_IDLE)
+        calibration_line(y, captured_buf);
     }
+    if (wait == CAPTURE_WAIT_TIMEOUT) {
+      capture_signal_lost();
+    } else {
+      line_ring_frame_done();
+      capture_frame_done();
+      calibration_frame_done();
+    }
+#endif
   }
 }
 
 uint32_t video_capture_get_frame_count(void) { return g_frame_count; }
+
+uint32_t video_capture_get_hires_line_count(void) { return g_hires_lines; }
+
+uint32_t video_capture_get_idle_permille(void) { return g_idle_permille; }
+
+uint32_t video_capture_get_frame_edge_us(void) { return g_frame_edge_us; }
+
+uint32_t video_capture_get_frame_period_q8(void) { return g_frame_period_q8; }
+
+bool video_capture_has_signal(void) {
+  return g_capture_state != CAPTURE_NO_SIGNAL;
+}
+
+uint32_t video_capture_get_signal_losses(void) { return g_signal_losses; }
+
+uint32_t video_capture_get_relock_us(void) { return g_relock_us; }
+
+uint32_t video_capture_get_relock_max_us(void) { return g_relock_max_us; }
+
+void video_capture_set_phase(uint32_t skip, uint32_t sample_ns) {
+  g_phase_skip = (skip >= CAPTURE_SKIP_MIN && skip <= CAPTURE_SKIP_MAX)
+                     ? skip
+                     : CAPTURE_SKIP_DEFAULT;
+  g_phase_sample_ns = sample_ns;
+}
+
+void video_capture_start_calibration(void) { g_cal_requested = true; }
+
+void video_capture_get_calibration(video_capture_calibration_t *out) {
+  out->busy = g_cal_requested || g_cal_stage != CAL_IDLE;
+  out->done = g_cal_done;
+  out->skip = (uint8_t)g_phase_skip;
+  out->delay = (uint8_t)g_phase_delay;
+  out->delay_max = (uint8_t)g_phase_delay_max;
+  out->sample_ns =
+      (uint8_t)capture_cycles_to_ns(CAPTURE_SAMPLE_CYCLES + g_phase_delay);
+  out->eye_lo_ns = (uint8_t)g_cal_eye_lo_ns;
+  out->eye_hi_ns = (uint8_t)g_cal_eye_hi_ns;
+  out->points_done = (uint8_t)g_cal_points_done;
+  out->points_total = (uint8_t)(g_phase_delay_max + 1U + CAL_SKIP_POINTS);
+}
+
+uint32_t video_capture_line_words(void) { return CAPTURE_LINE_WORDS; }
+
+snes_region_t video_capture_get_region(void) { return g_region; }
+
+uint32_t video_capture_get_height(void) { return g_frame_lines; }
+
+bool video_capture_is_interlaced(void) {
+  return (g_field_flags & LINE_RING_INTERLACED) != 0;
+}
+
+void video_capture_convert_line(uint16_t *dst, const uint32_t *src,
+                                uint32_t count, uint32_t brightness) {
+  convert_line(dst, (const capture_sample_t *)src, (int)count, 1, brightness);
+}
+
+uint32_t video_capture_line_samples(void) { return CAPTURE_LINE_SAMPLES; }
+
+void video_capture_pack_samples(uint32_t *dst, const uint32_t *pins,
+                                uint32_t count) {
+  capture_sample_t *out = (capture_sample_t *)dst;
+  for (uint32_t i = 0; i < count; i++) {
+    const uint32_t w = pins[i];
+    const bool valid = (w >> (PIN_SNES_PIXEL_VALID - PIN_SNES_BASE)) & 1U;
+#if ENABLE_PACKED_CAPTURE
+    out[i] = valid ? (capture_sample_t)(((w >> 2) & 0x7FFFU) << 1) : 0U;
+#else
+    out[i] = valid ? w : 0U;
+#endif
+  }
+}
+
+video_capture_kernel_t video_capture_kernel(void) {
+#if ENABLE_LEAN_CONVERT
+  return VIDEO_CAPTURE_KERNEL_RBIT;
+#elif ENABLE_INTERP_CONVERT
+  return VIDEO_CAPTURE_KERNEL_INTERP;
+#else
+  return VIDEO_CAPTURE_KERNEL_LUT;
+#endif
+}
+
+bool video_capture_kernel_available(video_capture_kernel_t kernel) {
+  return !ENABLE_LEAN_CONVERT || kernel == VIDEO_CAPTURE_KERNEL_RBIT;
+}
+
+void video_capture_convert_line_kernel(uint16_t *dst, const uint32_t *words,
+                                       uint32_t count,
+                                       video_capture_kernel_t kernel) {
+  const capture_sample_t *src = (const capture_sample_t *)words;
+  switch (kernel) {
+#if !ENABLE_LEAN_CONVERT
+  case VIDEO_CAPTURE_KERNEL_LUT:
+    convert_line_full_lut(dst, src, (int)count, 1);
+    break;
+  case VIDEO_CAPTURE_KERNEL_INTERP:
+    convert_line_full_interp(dst, src, (int)count, 1);
+    break;
+#endif
+  default:
+    convert_line_full_rbit(dst, src, (int)count, 1);
+    break;
+  }
+}
+
+uint32_t video_capture_table_bytes(void) {
+#if ENABLE_LEAN_CONVERT
+  return (uint32_t)sizeof(g_bright_lut);
+#else
+  return (uint32_t)(sizeof(g_pixel_lut) + sizeof(g_bright_lut));
+#endif
+}
+
+uint16_t video_capture_convert_captured_line(uint16_t *dst, const uint32_t *src,
+                                             uint32_t brightness) {
+  return convert_captured_line(dst, src, brightness, SNES_H_ACTIVE_HIRES);
+}
+
+#if !ENABLE_RAW_CAPTURE_RING
+void video_capture_store_line(uint16_t line, const uint16_t *pixels,
+                              uint16_t width) {
+#if ENABLE_INDEXED_LINES
+  store_line(line, pixels, width);
+#else
+  memcpy(line_ring_write_ptr(line), pixels, width * sizeof(uint16_t));
+  line_ring_set_width(line, width);
+#endif
+}
+#endif
+
+void video_capture_get_line_store(video_capture_line_store_t *out) {
+#if ENABLE_INDEXED_LINES
+  out->indexed_lines = g_indexed_lines;
+  out->wide_lines = g_wide_lines;
+  out->bytes = g_index_bytes;
+  out->max_colors = g_index_max_colors;
+#else
+  memset(out, 0, sizeof(*out));
+#endif
+}
@@ -1,12 +1,21 @@
 #ifndef VIDEO_CAPTURE_H
 #define VIDEO_CAPTURE_H
 
+#include "snes_timing.h"
+#include <stdbool.h>
 #include <stdint.h>
 
 /**
- * Initialize SNES video capture hardware
+ * Probe the console region before the output mode is chosen: PALMODE pin
+ * with ENABLE_PALMODE_PIN, otherwise the VBLANK period. Returns NTSC if no
+ * frame arrives within timeout_ms.
  */
-void video_capture_init(uint32_t height);
+snes_region_t video_capture_detect_region(uint32_t timeout_ms);
+
+/**
+ * Initialize SNES video capture hardware for a region (224 or 239 lines)
+ */
+void video_capture_init(snes_region_t region);
 
 /**
  * Run video capture loop (never returns)
@@ -18,4 +27,179 @@ void video_capture_run(void);
  */
 uint32_t video_capture_get_frame_count(void);
 
+/**
+ * Convert `count` capture samples to RGB565 at a $2100 brightness level
+ * (0-15). Same path the capture loop uses; exposed for the conversion
+ * benchmark.
+ */
+void video_capture_convert_line(uint16_t *dst, const uint32_t *src,
+                                uint32_t count, uint32_t brightness);
+
+/**
+ * Samples per active line (two per dot with ENABLE_HIRES), and a helper that
+ * stores pin words (GP27-45, as read with IN_BASE = GP27) in the capture
+ * format the PIO program produces: one word per sample, or two 16-bit samples
+ * per word with ENABLE_PACKED_CAPTURE. `dst` needs room for `count` samples.
+ */
+uint32_t video_capture_line_samples(void);
+void video_capture_pack_samples(uint32_t *dst, const uint32_t *pins,
+                                uint32_t count);
+
+/**
+ * Full-brightness conversion kernels. ENABLE_INTERP_CONVERT or the
+ * SUPERPICO_LEAN_PIXEL_CONVERT CMake option picks the one the capture loop
+ * uses; the benchmark times every kernel the build has.
+ */
+typedef enum {
+  VIDEO_CAPTURE_KERNEL_LUT,    // unrolled shift/mask/LUT loop
+  VIDEO_CAPTURE_KERNEL_INTERP, // interpolators generate the LUT addresses
+  VIDEO_CAPTURE_KERNEL_RBIT,   // bit reverse and shifts, no 64 KB LUT
+  VIDEO_CAPTURE_KERNEL_COUNT
+} video_capture_kernel_t;
+
+/**
+ * Kernel the capture loop was built with.
+ */
+video_capture_kernel_t video_capture_kernel(void);
+
+/**
+ * False for the LUT-based kernels in a lean build, which has no LUT.
+ */
+bool video_capture_kernel_available(video_capture_kernel_t kernel);
+
+/**
+ * Convert `count` consecutive samples at full brightness with a specific
+ * kernel. Must run on Core 0 (the interpolators are per core).
+ */
+void video_capture_convert_line_kernel(uint16_t *dst, const uint32_t *src,
+                                       uint32_t count,
+                                       video_capture_kernel_t kernel);
+
+/**
+ * SRAM taken by the conversion tables (pixel LUT and brightness bank).
+ */
+uint32_t video_capture_table_bytes(void);
+
+/**
+ * Raw capture words DMA'd per active line: one per sample, or one per two
+ * samples with ENABLE_PACKED_CAPTURE.
+ */
+uint32_t video_capture_line_words(void);
+
+/**
+ * Convert one raw captured line exactly as the capture loop does, including
+ * hires detection. Returns the stored width: 256, or 512 for hires lines.
+ * With ENABLE_RAW_CAPTURE_RING, Core 1 converts ring lines through this.
+ */
+uint16_t video_capture_convert_captured_line(uint16_t *dst, const uint32_t *src,
+                                             uint32_t brightness);
+
+/**
+ * Store a converted line (`width` RGB565 pixels) as line `line` of the frame
+ * being captured, in the ring's format; commit it with the ring. Capture
+ * does this for every line; exposed for the benchmarks, which fill the ring
+ * before capture starts. Not in the raw capture ring.
+ */
+void video_capture_store_line(uint16_t line, const uint16_t *pixels,
+                              uint16_t width);
+
+/**
+ * Indexed line store (ENABLE_INDEXED_LINES) since boot: lines stored as
+ * 8-bit indices and as RGB565, the bytes they took (palettes included; an
+ * RGB565 lores line takes 512), and the most colours in an indexed line.
+ * All zero without the indexed store.
+ */
+typedef struct {
+  uint32_t indexed_lines;
+  uint32_t wide_lines;
+  uint64_t bytes;
+  uint32_t max_colors;
+} video_capture_line_store_t;
+
+void video_capture_get_line_store(video_capture_line_store_t *out);
+
+/**
+ * Number of lines stored at hires width since boot.
+ */
+uint32_t video_capture_get_hires_line_count(void);
+
+/**
+ * Share of the last ~1 s Core 0 spent waiting on the SNES (for the top of
+ * frame, or on line DMA), in permille.
+ */
+uint32_t video_capture_get_idle_permille(void);
+
+/**
+ * time_us_32() at the latest top of frame, taken when Core 0 sees VBLANK
+ * fall (in the capture SM's frame interrupt with ENABLE_PIO_FRAME_SYNC).
+ */
+uint32_t video_capture_get_frame_edge_us(void);
+
+/**
+ * SNES frame period averaged over the last 64 top of frame timestamps, in
+ * 1/256 us (for 448i, the mean of a long and a short field). 0 until 64
+ * frames in a row have been seen.
+ */
+uint32_t video_capture_get_frame_period_q8(void);
+
+/**
+ * False while capture has lost the SNES (a line or top of frame timed out)
+ * and Core 1 shows the no-signal screen; true again from the next top of
+ * frame.
+ */
+bool video_capture_has_signal(void);
+
+/**
+ * Signal losses since boot, and the time to relock after the latest and the
+ * slowest: from the console clocking again to the end of the first frame
+ * captured whole. Boot counts as a relock without a loss.
+ */
+uint32_t video_capture_get_signal_losses(void);
+uint32_t video_capture_get_relock_us(void);
+uint32_t video_capture_get_relock_max_us(void);
+
+/**
+ * Sampling phase of the capture program: dot clocks skipped after HBLANK
+ * falls before the first pixel, and the time from each PCLK edge to the
+ * sample in ns. Call before video_capture_init with the persisted phase;
+ * 0 (or out of range) keeps the default of each. The time is rounded to
+ * whole PIO cycles at the running sysclk.
+ */
+void video_capture_set_phase(uint32_t skip, uint32_t sample_ns);
+
+/**
+ * Eye scan: Core 0 sweeps the sample delay, then the skip count, over a few
+ * frames per point, scores frame-to-frame bit changes and settles on the
+ * centre of the stable eye. Wants a still picture (a title or pause screen).
+ * The new phase applies as soon as the scan ends; persisting it is up to
+ * the caller. A signal loss aborts the scan and restores the old phase.
+ */
+typedef struct {
+  bool busy;
+  bool done;           // a scan has completed since boot
+  uint8_t skip;        // current phase
+  uint8_t delay;       // extra PIO cycles on the hold instruction
+  uint8_t delay_max;
+  uint8_t sample_ns;   // PCLK edge to sample, for video_capture_set_phase
+  uint8_t eye_lo_ns;   // stable window of the last scan
+  uint8_t eye_hi_ns;
+  uint8_t points_done; // progress of a running scan
+  uint8_t points_total;
+} video_capture_calibration_t;
+
+void video_capture_start_calibration(void);
+void video_capture_get_calibration(video_capture_calibration_t *out);
+
+/**
+ * Region set by video_capture_init, and the active height of the latest
+ * counted frame (224, or 239 with overscan on).
+ */
+snes_region_t video_capture_get_region(void);
+uint32_t video_capture_get_height(void);
+
+/**
+ * True while the source is sending alternating 448i fields.
+ */
+bool video_capture_is_interlaced(void);
+
 #endif // VIDEO_CAPTURE_H
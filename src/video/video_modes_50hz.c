@@ -0,0 +1,31 @@
+#include "video_modes_50hz.h"
+
+const video_mode_t video_mode_576_p = {
+    .h_active_pixels = 720,
+    .h_front_porch = 12,
+    .h_sync_width = 64,
+    .h_back_porch = 68,
+    .h_total_pixels = 864,
+    .v_active_lines = 576,
+    .v_front_porch = 5,
+    .v_sync_width = 5,
+    .v_back_porch = 39,
+    .v_total_lines = 625,
+    .pixel_clock_hz = 27000000,
+    .name = "576p",
+};
+
+const video_mode_t video_mode_720_p50 = {
+    .h_active_pixels = 1280,
+    .h_front_porch = 440,
+    .h_sync_width = 40,
+    .h_back_porch = 220,
+    .h_total_pixels = 1980,
+    .v_active_lines = 720,
+    .v_front_porch = 5,
+    .v_sync_width = 5,
+    .v_back_porch = 20,
+    .v_total_lines = 750,
+    .pixel_clock_hz = 74250000,
+    .name = "720p50",
+};
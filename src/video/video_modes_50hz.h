@@ -0,0 +1,32 @@
+#ifndef VIDEO_MODES_50HZ_H
+#define VIDEO_MODES_50HZ_H
+
+#include "pico_hdmi/video_output_rt.h"
+
+// =============================================================================
+// 50 Hz HDMI modes for PAL consoles (CEA-861 timings)
+// =============================================================================
+// pico_hdmi ships the 60 Hz set only. A PAL SNES runs at ~50.007 Hz, so
+// these keep output pacing 1:1 with the source instead of repeating every
+// fifth frame at 60 Hz.
+//
+//   576p:    720x576,  27 MHz,    sysclk 270 MHz, HSTX clk div 2 (as 480p)
+//   720p50:  1280x720, 74.25 MHz, sysclk 372 MHz, HSTX clk div 1 (as 720p)
+//
+// There is no 50 Hz direct mode. CEA-861's 288p (VIC 23) needs pixel
+// repetition flagged in the AVI infoframe, and nudging its line length to
+// track the console made it a timing no sink is known to accept, so Direct
+// on a PAL console shows 576p.
+//
+// Checked: the timings against CEA-861 (VIC 17/18, 19) and the line and
+// frame rates in the host sim. Not yet checked, because pico_hdmi is not in
+// this tree and the firmware has not been built against it:
+// - the field set. The designated initialisers use the sim shim's
+//   video_mode_t fields; a field pico_hdmi has and the shim lacks is left 0.
+// - the AVI infoframe pico_hdmi sends for each mode. It needs to carry the
+//   VIC above.
+
+extern const video_mode_t video_mode_576_p;
+extern const video_mode_t video_mode_720_p50;
+
+#endif // VIDEO_MODES_50HZ_H
@@ -2,6 +2,8 @@
 #include "config.h"
 #include "snes_timing.h"
 #include "pico_hdmi/video_output_rt.h"
+#include "hardware/structs/m33.h"
+#include "genlock.h"
 #include "hardware/structs/watchdog.h"
 #include "hardware/watchdog.h"
 #include "pico/stdlib.h"
@@ -13,6 +15,9 @@
 #if ENABLE_AUDIO
 #include "audio/audio_pipeline.h"
 #endif
+#if ENABLE_RAW_CAPTURE_RING || ENABLE_GENLOCK
+#include "video_capture.h"
+#endif
 
 #define OVERSCAN_COLOR_RGB565    0x0000   // black border
 #define NO_SIGNAL_COLOR_RGB565   0x7BEF   // mid gray (~50%) - no-signal indicator
@@ -41,8 +46,97 @@ static inline uint32_t reboot_mode_boot_check(uint32_t mode)
 
 line_ring_t g_line_ring __attribute__((aligned(64)));
 
+// Source picture for the output frame being scanned out: 224 lines at
+// V_OFFSET, or the 239-line overscan window, centred in the 240-row canvas.
+// Latched on the first canvas line from the height Core 0 published with the
+// line ring, along with whether capture has lost the SNES.
+static snes_region_t s_region = SNES_REGION_NTSC;
+static uint32_t s_source_lines = SNES_V_ACTIVE;
+static uint32_t s_source_top = V_OFFSET;
+static bool s_no_signal = false;
+
+void video_pipeline_set_region(snes_region_t region)
+{
+    s_region = region;
+}
+
+snes_region_t video_pipeline_get_region(void)
+{
+    return s_region;
+}
+
+#if ENABLE_INTERLACE
+static volatile video_pipeline_deinterlace_t s_deinterlace_mode = VIDEO_PIPELINE_DEINTERLACE_WEAVE;
+static video_pipeline_deinterlace_t s_deinterlace_latched = VIDEO_PIPELINE_DEINTERLACE_WEAVE;
+
+void video_pipeline_set_deinterlace(video_pipeline_deinterlace_t mode)
+{
+    if (mode > VIDEO_PIPELINE_DEINTERLACE_BOB) {
+        mode = VIDEO_PIPELINE_DEINTERLACE_WEAVE;
+    }
+    s_deinterlace_mode = mode;
+}
+
+video_pipeline_deinterlace_t video_pipeline_get_deinterlace(void)
+{
+    return s_deinterlace_mode;
+}
+#endif
+
+static volatile video_pipeline_scaler_t s_scaler_mode = VIDEO_PIPELINE_SCALER_INTEGER;
+static video_pipeline_scaler_t s_scaler_latched = VIDEO_PIPELINE_SCALER_INTEGER;
+
+void video_pipeline_set_scaler(video_pipeline_scaler_t mode)
+{
+    if (mode >= VIDEO_PIPELINE_SCALER_COUNT) {
+        mode = VIDEO_PIPELINE_SCALER_INTEGER;
+    }
+    s_scaler_mode = mode;
+}
+
+video_pipeline_scaler_t video_pipeline_get_scaler(void)
+{
+    return s_scaler_mode;
+}
+
+static volatile video_pipeline_latency_t s_latency_mode = VIDEO_PIPELINE_LATENCY_LOW;
+
+bool video_pipeline_latency_supported(video_pipeline_latency_t mode)
+{
+    switch (mode) {
+    case VIDEO_PIPELINE_LATENCY_LOW:
+        return true;
+    case VIDEO_PIPELINE_LATENCY_FRAME:
+        return LINE_RING_FRAME_BUFFERS;
+    case VIDEO_PIPELINE_LATENCY_RACE:
+        return ENABLE_GENLOCK && !ENABLE_RAW_CAPTURE_RING;
+    default:
+        return false;
+    }
+}
+
+void video_pipeline_set_latency(video_pipeline_latency_t mode)
+{
+    if (!video_pipeline_latency_supported(mode)) {
+        mode = VIDEO_PIPELINE_LATENCY_LOW;
+    }
+    s_latency_mode = mode;
+}
+
+video_pipeline_latency_t video_pipeline_get_latency(void)
+{
+    return s_latency_mode;
+}
+
+#if ENABLE_OSD && ENABLE_INDEXED_OSD
+static void osd_nibble_masks_build(void);
+#endif
+
 void video_pipeline_init(void) {
-    memset(&g_line_ring, 0, sizeof(g_line_ring));
+    line_ring_init();
+#if ENABLE_OSD && ENABLE_INDEXED_OSD
+    osd_nibble_masks_build();
+#endif
 }
 
 static inline void __scratch_y("")
@@ -99,80 +193,620 @@ quadruple_pixels_fast(uint32_t *dst, const uint16_t *src, int count) {
     }
 }
 
+// One pixel (the low half) repeated across a word.
+static inline uint32_t pack_low_pixel(uint32_t two) {
+    return (two & 0xFFFFU) | (two << 16);
+}
+
 typedef void (*pixel_scale_fn_t)(uint32_t *dst, const uint16_t *src, int count);
 
-#if ENABLE_OSD
+#if ENABLE_HIRES
+// Hires lines (512 px) fill the same output span as a scaled lores line.
+
+// 480p: 1:1.
+static inline void __scratch_y("")
+copy_pixels_fast(uint32_t *dst, const uint16_t *src, int count) {
+    memcpy(dst, src, (size_t)count * sizeof(uint16_t));
+}
+
+// 720p: 2 -> 3 nearest (a a b c c d per four source pixels).
+static inline void __scratch_y("")
+hires_3_2_pixels_fast(uint32_t *dst, const uint16_t *src, int count) {
+    const uint32_t *src32 = (const uint32_t *)src;
+    int quads = count / 4;
+
+    for (int i = 0; i < quads; i++) {
+        uint32_t ab = src32[i * 2];
+        uint32_t cd = src32[(i * 2) + 1];
+        uint32_t a = ab & 0xFFFF;
+        uint32_t c = cd & 0xFFFF;
+        dst[(i * 3) + 0] = a | (a << 16);
+        dst[(i * 3) + 1] = (ab >> 16) | (c << 16);
+        dst[(i * 3) + 2] = cd;
+    }
+}
+
+// 240p and OSD lines: average each pair down to 256 px for the lores path.
+static inline void __scratch_y("")
+blend_hires_pairs(uint16_t *dst, const uint16_t *src, int count) {
+    const uint32_t *src32 = (const uint32_t *)src;
+    int pairs = count / 2;
+
+    for (int i = 0; i < pairs; i++) {
+        uint32_t two = src32[i];
+        uint32_t p0 = two & 0xFFFF;
+        uint32_t p1 = two >> 16;
+        dst[i] = (uint16_t)((((p0 ^ p1) & 0xF7DEU) >> 1) + (p0 & p1));
+    }
+}
+
+static uint16_t s_hires_blend_line[SNES_H_ACTIVE] __attribute__((aligned(4)));
+#endif
+
+#if ENABLE_INDEXED_LINES
+// Indexed ring lines (ENABLE_INDEXED_LINES): the lores scalers look each
+// index up as they go; hires lines, OSD rows and the fill scaler expand the
+// line to RGB565 first.
+typedef void (*indexed_scale_fn_t)(uint32_t *dst, const uint8_t *src, const uint16_t *palette, int count);
+
+static inline void __scratch_y("")
+expand_indexed(uint16_t *dst, const uint8_t *src, const uint16_t *palette, int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = palette[src[i]];
+    }
+}
+
+static inline void __scratch_y("")
+double_indexed(uint32_t *dst, const uint8_t *src, const uint16_t *palette, int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = pack_low_pixel(palette[src[i]]);
+    }
+}
+
+static inline void __scratch_y("")
+triple_indexed(uint32_t *dst, const uint8_t *src, const uint16_t *palette, int count) {
+    for (int i = 0; i < count / 2; i++) {
+        const uint32_t p0 = palette[src[(i * 2) + 0]];
+        const uint32_t p1 = palette[src[(i * 2) + 1]];
+        dst[(i * 3) + 0] = pack_low_pixel(p0);
+        dst[(i * 3) + 1] = p0 | (p1 << 16);
+        dst[(i * 3) + 2] = pack_low_pixel(p1);
+    }
+}
+
+static inline void __scratch_y("")
+quadruple_indexed(uint32_t *dst, const uint8_t *src, const uint16_t *palette, int count) {
+    for (int i = 0; i < count; i++) {
+        const uint32_t p = pack_low_pixel(palette[src[i]]);
+        dst[(i * 2) + 0] = p;
+        dst[(i * 2) + 1] = p;
+    }
+}
+
+static uint16_t s_index_line[SNES_H_ACTIVE_HIRES] __attribute__((aligned(4)));
+#endif
+
 static bool s_osd_visible_latched = false;
 
-static inline bool __scratch_x("")
-osd_line_active(uint32_t source_line) {
-    return s_osd_visible_latched && source_line >= OSD_BOX_Y && source_line < (OSD_BOX_Y + OSD_BOX_H);
+#if ENABLE_OSD && ENABLE_INDEXED_OSD
+// Indexed OSD (ENABLE_INDEXED_OSD): each cell's glyph row goes out a nibble
+// (four font pixels) at a time. For each horizontal scale, 2x to 4x, the
+// nibble table holds the nibble's 4, 6 or 8 output words as foreground
+// masks; a word is the background with the cell's colour masked in.
+#define OSD_NIBBLE_SCALES 3U
+#define OSD_NIBBLE_WORDS_MAX 8U
+
+static uint32_t s_osd_nibble_mask[OSD_NIBBLE_SCALES][16][OSD_NIBBLE_WORDS_MAX];
+
+static void osd_nibble_masks_build(void)
+{
+    for (uint32_t h_scale = 2U; h_scale < 2U + OSD_NIBBLE_SCALES; h_scale++) {
+        for (uint32_t nibble = 0; nibble < 16U; nibble++) {
+            for (uint32_t w = 0; w < h_scale * 2U; w++) {
+                // Output pixels 2w and 2w+1 repeat font pixels 2w/h_scale and (2w+1)/h_scale.
+                const uint32_t lo = (nibble >> (3U - ((w * 2U) / h_scale))) & 1U;
+                const uint32_t hi = (nibble >> (3U - (((w * 2U) + 1U) / h_scale))) & 1U;
+                s_osd_nibble_mask[h_scale - 2U][nibble][w] = (lo ? 0x0000FFFFU : 0U) | (hi ? 0xFFFF0000U : 0U);
+            }
+        }
+    }
 }
 
+static inline __attribute__((always_inline)) void
+draw_osd_line_scaled(uint32_t *dst, uint32_t source_line, uint32_t osd_x_words, uint32_t h_scale) {
+    const uint32_t y = source_line - OSD_BOX_Y;
+    const char *text = fast_osd_text[y / 8U];
+    const uint16_t *color = fast_osd_color[y / 8U];
+    const uint32_t (*masks)[OSD_NIBBLE_WORDS_MAX] = s_osd_nibble_mask[h_scale - 2U];
+    const uint32_t words = h_scale * 2U;
+    const uint32_t bg = ((uint32_t)OSD_COLOR_BG << 16) | OSD_COLOR_BG;
+    dst += osd_x_words;
+    for (uint32_t col = 0; col < FAST_OSD_COLS; col++) {
+        const uint32_t bits = fast_osd_font[(uint8_t)text[col]][y % 8U];
+        if (bits == 0U) {
+            // Spaces, and the blank top and bottom rows of most glyphs.
+            for (uint32_t w = 0; w < words * 2U; w++) {
+                dst[w] = bg;
+            }
+        } else {
+            const uint32_t ink = (((uint32_t)color[col] << 16) | color[col]) ^ bg;
+            const uint32_t *left = masks[bits >> 4];
+            const uint32_t *right = masks[bits & 0x0FU];
+            for (uint32_t w = 0; w < words; w++) {
+                dst[w] = bg ^ (ink & left[w]);
+            }
+            for (uint32_t w = 0; w < words; w++) {
+                dst[words + w] = bg ^ (ink & right[w]);
+            }
+        }
+        dst += words * 2U;
+    }
+}
+#elif ENABLE_OSD
 static inline void __scratch_x("")
 draw_osd_line_scaled(uint32_t *dst, uint32_t source_line, uint32_t osd_x_words, pixel_scale_fn_t scale_pixels) {
     const uint16_t *osd_src = osd_framebuffer[source_line - OSD_BOX_Y];
     scale_pixels(dst + osd_x_words, osd_src, OSD_BOX_W);
 }
-#else
-static inline bool __scratch_x("")
-osd_line_active(uint32_t source_line) {
-    (void)source_line;
+#endif
+
+#if ENABLE_RAW_CAPTURE_RING
+// Raw capture ring: ring lines hold capture samples. Each is converted once
+// into s_raw_line; 480p reads every source line twice in a row.
+static uint16_t s_raw_line[SNES_H_ACTIVE_HIRES] __attribute__((aligned(4)));
+static uint16_t s_raw_line_width = SNES_H_ACTIVE;
+static uint32_t s_raw_line_idx = UINT32_MAX;
+
+static inline const uint16_t *__scratch_x("")
+raw_line_convert(uint16_t snes_line) {
+    const uint32_t idx = line_ring_read_index(snes_line);
+    if (idx != s_raw_line_idx) {
+        s_raw_line_width = video_capture_convert_captured_line(
+            s_raw_line, (const uint32_t *)line_ring_read_ptr(snes_line), line_ring_read_brightness());
+        s_raw_line_idx = idx;
+    }
+    return s_raw_line;
+}
+#endif
+
+// Slowest scanline since the last video_pipeline_take_scanline_max_cycles(),
+// timed with Core 1's DWT cycle counter (enabled from vsync_callback, since
+// each core has its own).
+static volatile uint32_t s_scanline_max_cycles = 0;
+
+// Scanline plan: what the output mode means for every line, worked out when
+// the mode is first scanned out instead of on each line. The geometry lives
+// in s_plan; the scale picks one of the callbacks below, each compiled for
+// its scale with the OSD open or closed, and vsync swaps them as the OSD
+// opens and closes.
+typedef enum {
+    SCANLINE_SCALE_2X, // 480p/576p: two output lines per canvas row
+    SCANLINE_SCALE_4X, // 240p: one line per row, four pixels per dot
+    SCANLINE_SCALE_3X, // 720p (60 or 50 Hz): three lines per row
+    SCANLINE_SCALE_COUNT
+} scanline_scale_t;
+
+#define SCANLINE_H_SCALE(scale) \
+    (((scale) == SCANLINE_SCALE_3X) ? 3U : ((scale) == SCANLINE_SCALE_4X) ? 4U : 2U)
+
+typedef struct {
+    const video_mode_t *mode; // mode the plan was built for
+    scanline_scale_t scale;
+    uint32_t first_line;      // output line of canvas row 0
+    uint32_t lines_per_row;   // output lines per canvas row
+    uint32_t row_offset;      // rows above the 240-row canvas (576p's 288 rows)
+    uint32_t h_words;
+    uint32_t image_x_words;   // left edge of the picture
+#if ENABLE_OSD
+    uint32_t osd_x_words;
+#endif
+    video_pipeline_scaler_t scaler; // setting the plan was built with
+    bool fit;                 // 720p fill scaler: the fit tables below apply
+    uint32_t fit_top;         // canvas row of fit row 0
+    uint32_t fit_x_words;     // fill scaler picture span
+    uint32_t fit_w_words;
+} scanline_plan_t;
+
+static scanline_plan_t s_plan;
+
+// Line cache: the last line rendered this output frame and what it was made
+// from. 480p asks for every source line twice in a row, and bob shows each
+// field line twice in 480p and 720p; a request with the same inputs reuses
+// that line's buffer, or copies it if the scanout handed over a different
+// one. Cleared at vsync.
+typedef struct {
+    bool valid;
+    bool osd_active;
+    uint16_t fallback_color;
+    uint32_t source_line;
+    const uint16_t *src;
+#if ENABLE_RAW_CAPTURE_RING
+    uint32_t raw_idx; // s_raw_line holds this ring line
+#endif
+    const uint32_t *dst;
+} scanline_cache_t;
+
+static scanline_cache_t s_line_cache;
+
+// True if the line the cache holds was made from the same inputs, with `dst`
+// then holding it; otherwise records them for the line about to be rendered.
+static inline __attribute__((always_inline)) bool
+line_cache_reuse(uint32_t source_line, const uint16_t *src, uint16_t fallback_color, bool osd_active, uint32_t *dst,
+                 uint32_t h_words)
+{
+    if (s_line_cache.valid && source_line == s_line_cache.source_line && src == s_line_cache.src &&
+#if ENABLE_RAW_CAPTURE_RING
+        (!src || s_raw_line_idx == s_line_cache.raw_idx) &&
+#endif
+        fallback_color == s_line_cache.fallback_color && osd_active == s_line_cache.osd_active) {
+        if (dst != s_line_cache.dst) {
+            memcpy(dst, s_line_cache.dst, h_words * sizeof(uint32_t));
+        }
+        return true;
+    }
+    s_line_cache.valid = true;
+    s_line_cache.source_line = source_line;
+    s_line_cache.src = src;
+#if ENABLE_RAW_CAPTURE_RING
+    s_line_cache.raw_idx = s_raw_line_idx;
+#endif
+    s_line_cache.fallback_color = fallback_color;
+    s_line_cache.osd_active = osd_active;
+    s_line_cache.dst = dst;
     return false;
 }
+
+// Capture-to-scanout latency, sampled the first time an output frame reads
+// each source line: later rows of a 2x or 3x line come from the same read.
+// Core 1 keeps the sums; readers on the other core take them as they find
+// them, as with s_scanline_max_cycles.
+typedef struct {
+    uint32_t lines;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+} latency_acc_t;
+
+static latency_acc_t s_latency_boot;
+static latency_acc_t s_latency_window;
+static uint32_t s_latency_hist[VIDEO_PIPELINE_LATENCY_BINS];
+static uint32_t s_latency_next_line;                  // first line not sampled this frame
+static uint32_t s_latency_frame_min_us = UINT32_MAX; // smallest this output frame
+
+static inline __attribute__((always_inline)) void latency_acc_add(latency_acc_t *acc, uint32_t us)
+{
+    if (acc->lines == 0U || us < acc->min_us) {
+        acc->min_us = us;
+    }
+    if (us > acc->max_us) {
+        acc->max_us = us;
+    }
+    acc->sum_us += us;
+    acc->lines++;
+}
+
+static inline __attribute__((always_inline)) void latency_sample(uint16_t snes_line)
+{
+#if ENABLE_RAW_CAPTURE_RING
+    (void)snes_line;
+#else
+    if (snes_line < s_latency_next_line) {
+        return;
+    }
+    s_latency_next_line = snes_line + 1U;
+    const uint32_t us = time_us_32() - line_ring_read_stamp(snes_line);
+    latency_acc_add(&s_latency_boot, us);
+    latency_acc_add(&s_latency_window, us);
+    const uint32_t bin = us / VIDEO_PIPELINE_LATENCY_BIN_US;
+    s_latency_hist[(bin < VIDEO_PIPELINE_LATENCY_BINS) ? bin : (VIDEO_PIPELINE_LATENCY_BINS - 1U)]++;
+    if (us < s_latency_frame_min_us) {
+        s_latency_frame_min_us = us;
+    }
 #endif
+}
 
-void __scratch_x("") scanline_callback(uint32_t v_scanline, uint32_t active_line, uint32_t *dst)
+static void latency_stats_from(const latency_acc_t *acc, video_pipeline_latency_stats_t *out)
 {
-    (void)v_scanline;
+    out->lines = acc->lines;
+    out->min_us = acc->lines ? acc->min_us : 0U;
+    out->avg_us = acc->lines ? (uint32_t)(acc->sum_us / acc->lines) : 0U;
+    out->max_us = acc->max_us;
+}
+
+void video_pipeline_get_latency_stats(video_pipeline_latency_stats_t *out)
+{
+    latency_stats_from(&s_latency_boot, out);
+}
+
+void video_pipeline_take_latency_stats(video_pipeline_latency_stats_t *out)
+{
+    latency_stats_from(&s_latency_window, out);
+    memset(&s_latency_window, 0, sizeof(s_latency_window));
+}
+
+const uint32_t *video_pipeline_get_latency_histogram(void)
+{
+    return s_latency_hist;
+}
+
+// Output lines from canvas row 0 to the top of a picture `top` rows down,
+// and the source line shown there: the fill scaler shows its rows from
+// fit_top, cropping a taller picture (at about lines_per_row lines a row).
+static inline uint32_t race_picture_lines(uint32_t top, uint32_t *first_source_line)
+{
+    const uint32_t start = s_plan.fit ? s_plan.fit_top : 0U;
+    *first_source_line = (top < start) ? (start - top) : 0U;
+    return (top > start) ? ((top - start) * s_plan.lines_per_row) : 0U;
+}
+
+#if ENABLE_GENLOCK && !ENABLE_RAW_CAPTURE_RING
+// Race the beam: the genlock holds each frame's smallest latency at
+// LATENCY_RACE_LINES SNES lines. That latency less the phase of the vsync
+// before it, less the picture's lead (race_lead_us), is when the scanout
+// reaches canvas row 0 less when capture commits a line: fixed by the mode, and
+// tracked (1/8 per frame, wrapped against frames the late latch shows one
+// later) rather than tabled. A taller picture starts higher up and needs
+// the vsync earlier, so the target holds for the tallest picture of the
+// last RACE_TOP_HOLD_FRAMES: a game switching overscan then costs one late
+// frame, not one per switch. The phase error is cut a line below the late
+// latch, so pulling in never sweeps across where it switches frames.
+#define RACE_OFFSET_SHIFT 3
+#define RACE_TOP_HOLD_FRAMES 300U
+
+static int32_t s_race_offset_us;
+static bool s_race_offset_valid = false;
+static uint32_t s_race_top;        // picture top (canvas rows) the target is for
+static uint32_t s_race_top_frames; // frames left holding it
+
+// How much later than at canvas row 0 the output first reads a line of the
+// frame, counted from that line's commit.
+static int32_t __not_in_flash_func(race_lead_us)(uint32_t top)
+{
+    const video_mode_t *mode = video_output_active_mode;
+    uint32_t first_source_line;
+    const uint32_t lines = race_picture_lines(top, &first_source_line);
+    return (int32_t)(((uint64_t)lines * mode->h_total_pixels * 1000000ULL) / mode->pixel_clock_hz) -
+           (int32_t)((first_source_line * SNES_REGION_LINE_NS(s_region)) / 1000U);
+}
+
+static void __not_in_flash_func(race_vsync)(uint32_t frame_min_us)
+{
+    if (s_latency_mode != VIDEO_PIPELINE_LATENCY_RACE) {
+        s_race_offset_valid = false;
+        genlock_set_target_us(0, -1);
+        return;
+    }
+    const uint32_t top = s_source_top;
+    const int32_t period_us = (int32_t)(video_capture_get_frame_period_q8() >> 8);
+    if (frame_min_us != UINT32_MAX && period_us != 0) {
+        int32_t offset_us = (int32_t)frame_min_us - genlock_get_phase_us() - race_lead_us(top);
+        if (!s_race_offset_valid) {
+            s_race_offset_us = offset_us;
+            s_race_offset_valid = true;
+            s_race_top = top;
+        }
+        while (offset_us - s_race_offset_us > period_us / 2) {
+            offset_us -= period_us;
+        }
+        while (offset_us - s_race_offset_us < -(period_us / 2)) {
+            offset_us += period_us;
+        }
+        s_race_offset_us += (offset_us - s_race_offset_us) / (1 << RACE_OFFSET_SHIFT);
+    }
+    if (!s_race_offset_valid) {
+        return;
+    }
+    if (top <= s_race_top) {
+        s_race_top = top;
+        s_race_top_frames = RACE_TOP_HOLD_FRAMES;
+    } else if (s_race_top_frames != 0U) {
+        s_race_top_frames--;
+    } else {
+        s_race_top = top;
+    }
+    const int32_t line_us = (int32_t)(SNES_REGION_LINE_NS(s_region) / 1000U);
+    genlock_set_target_us(((int32_t)LATENCY_RACE_LINES * line_us) - s_race_offset_us - race_lead_us(s_race_top),
+                          ((int32_t)LATENCY_RACE_LINES - (int32_t)LINE_RING_LATE_LATCH_LINES + 1) * line_us);
+}
+#endif
+
+// Output line of the top of the picture when racing the beam, else never.
+static uint32_t s_race_latch_line = UINT32_MAX;
 
-    const bool mode_is_240p = (video_output_active_mode->v_active_lines == 240U);
-    const bool mode_is_720p = (video_output_active_mode->v_active_lines == 720U);
-    const uint32_t h_words = video_output_active_mode->h_active_pixels / 2U;
-    const uint32_t h_scale = mode_is_720p ? 3U : mode_is_240p ? 4U : 2U;
+// First output line of the canvas: pick the newest frame if Core 0 is
+// already a few lines into it, then place the picture for its height.
+static inline __attribute__((always_inline)) void latch_source_frame(void)
+{
+    s_latency_next_line = 0U;
+    line_ring_output_late_latch();
+    s_source_lines = line_ring_read_lines();
+    s_source_top = (SNES_CANVAS_HEIGHT - s_source_lines) / 2U;
+    s_no_signal = (line_ring_read_flags() & LINE_RING_NO_SIGNAL) != 0U;
+    // Racing the beam, the output runs only a few lines behind capture, so
+    // above a 224-line picture the newest frame has not got far enough in
+    // yet: try again where the picture starts, keeping the place worked out
+    // here.
+    s_race_latch_line = UINT32_MAX;
+    if (s_latency_mode == VIDEO_PIPELINE_LATENCY_RACE) {
+        uint32_t first_source_line;
+        const uint32_t lines = race_picture_lines(s_source_top, &first_source_line);
+        if (lines != 0U) {
+            s_race_latch_line = s_plan.first_line + lines;
+        }
+    }
+}
+
+static inline __attribute__((always_inline)) void race_latch_source_frame(void)
+{
+    line_ring_output_late_latch();
+    s_source_lines = line_ring_read_lines();
+    s_no_signal = (line_ring_read_flags() & LINE_RING_NO_SIGNAL) != 0U;
+}
+
+typedef void (*scanline_render_fn_t)(uint32_t active_line, uint32_t *dst);
+
+// One body for every variant; `scale`, `osd` and `use_cache` are constants
+// in each, so the branches and scale functions for other modes drop out.
+static inline __attribute__((always_inline)) void
+render_scanline(scanline_scale_t scale, bool osd, bool use_cache, uint32_t active_line, uint32_t *dst)
+{
+    const bool mode_is_720p = (scale == SCANLINE_SCALE_3X);
+    const bool mode_is_240p = (scale == SCANLINE_SCALE_4X);
+    const uint32_t h_scale = SCANLINE_H_SCALE(scale);
+    const uint32_t h_words = s_plan.h_words;
     const pixel_scale_fn_t scale_pixels =
         mode_is_720p ? triple_pixels_fast : mode_is_240p ? quadruple_pixels_fast : double_pixels_fast;
+#if ENABLE_HIRES
+    const pixel_scale_fn_t scale_hires_pixels = mode_is_720p ? hires_3_2_pixels_fast : copy_pixels_fast;
+#endif
+#if ENABLE_INDEXED_LINES
+    const indexed_scale_fn_t scale_indexed =
+        mode_is_720p ? triple_indexed : mode_is_240p ? quadruple_indexed : double_indexed;
+#endif
 
-    if (mode_is_720p && ((active_line % 3U) != 0U)) {
-        return;
+    if (active_line == s_plan.first_line) {
+        latch_source_frame();
+    } else if (active_line == s_race_latch_line) {
+        race_latch_source_frame();
     }
 
-    const uint32_t source_line = mode_is_720p ? (active_line / 3U) : mode_is_240p ? active_line : (active_line >> 1);
-    const uint32_t canvas_words = (SNES_CANVAS_WIDTH * h_scale) / 2U;
-    const uint32_t canvas_margin_words = (h_words > canvas_words) ? ((h_words - canvas_words) / 2U) : 0U;
+    uint32_t source_line;
+#if ENABLE_INTERLACE
+    // 448i in 480p/720p: each output line maps to one interlaced line, two per
+    // canvas row. 240p shows the current field as-is.
+    const uint32_t frame_flags = line_ring_read_flags();
+    const bool deinterlace = ((frame_flags & LINE_RING_INTERLACED) != 0U) && !mode_is_240p;
+    uint32_t cur_field = frame_flags & LINE_RING_FIELD_ODD;
+    uint32_t want_field = cur_field;
+    if (deinterlace) {
+        // 720p: 3 output lines per 2 interlaced lines; the middle one repeats
+        // the line above, so at most one line is scaled per output line.
+        if (mode_is_720p && ((active_line % 3U) == 1U)) {
+            return;
+        }
+        const uint32_t il_line = mode_is_720p ? ((active_line * 2U) / 3U) : active_line;
+        if (s_deinterlace_latched == VIDEO_PIPELINE_DEINTERLACE_BOB) {
+            // Current field only, shifted down one line on the odd field.
+            source_line = (il_line >= cur_field) ? ((il_line - cur_field) >> 1) : UINT32_MAX;
+        } else {
+            source_line = il_line >> 1;
+            want_field = il_line & 1U;
+        }
+    } else
+#endif
+    {
+        if (mode_is_720p && ((active_line % 3U) != 0U)) {
+            return;
+        }
+        source_line = mode_is_720p ? (active_line / 3U) : mode_is_240p ? active_line : (active_line >> 1);
+    }
+    // 576p has 288 rows; the 240-row canvas sits in the middle.
+    source_line -= s_plan.row_offset;
     const uint32_t image_words = (SNES_H_ACTIVE * h_scale) / 2U;
-    const uint32_t image_x_words = canvas_margin_words + ((SNES_CANVAS_H_MARGIN * h_scale) / 2U);
+    const uint32_t image_x_words = s_plan.image_x_words;
 #if ENABLE_OSD
-    const uint32_t osd_x_words = canvas_margin_words + (((uint32_t)OSD_BOX_X * h_scale) / 2U);
+    const uint32_t osd_x_words = s_plan.osd_x_words;
     const uint32_t osd_w_words = ((uint32_t)OSD_BOX_W * h_scale) / 2U;
+#if ENABLE_INDEXED_OSD
+    const uint32_t osd_scale = h_scale; // glyph rows expand at the mode's scale
+#else
+    const pixel_scale_fn_t osd_scale = scale_pixels; // framebuffer rows scale like the picture
+#endif
+    const bool osd_active = osd && source_line >= OSD_BOX_Y && source_line < (OSD_BOX_Y + OSD_BOX_H);
+#else
+    (void)osd;
+    const bool osd_active = false;
 #endif
-
-    const bool osd_active = osd_line_active(source_line);
 
     uint16_t fallback_color = OVERSCAN_COLOR_RGB565;
     const uint16_t *src = NULL;
-    const uint32_t snes_line_u32 = source_line - V_OFFSET;
-    if (source_line < SNES_CANVAS_HEIGHT && snes_line_u32 < SNES_V_ACTIVE) {
+#if ENABLE_INDEXED_LINES
+    const uint16_t *src_palette = NULL;
+#endif
+    bool src_hires = false;
+    const uint32_t snes_line_u32 = source_line - s_source_top;
+    const bool in_picture = source_line < SNES_CANVAS_HEIGHT && snes_line_u32 < s_source_lines;
+    if (in_picture && s_no_signal) {
+        // No-signal screen until capture relocks.
+        fallback_color = NO_SIGNAL_COLOR_RGB565;
+    } else if (in_picture) {
         const uint16_t snes_line = (uint16_t)snes_line_u32;
-        if (line_ring_ready(snes_line)) {
+#if ENABLE_INTERLACE
+        // Weave: the other half of the 448i frame is the previous field,
+        // already complete in the ring (interlaced lines are always 256 px).
+        // If Core 0 has lapped it, the newest field has the wanted parity.
+        bool weave = want_field != cur_field && line_ring_prev_field_ready(snes_line);
+        if (want_field != cur_field && !weave) {
+            if (line_ring_catch_up(snes_line)) {
+                cur_field = line_ring_read_flags() & LINE_RING_FIELD_ODD;
+            }
+            weave = want_field != cur_field && line_ring_prev_field_ready(snes_line);
+            if (want_field != cur_field && !weave) {
+                line_ring_count_prev_field_miss(snes_line);
+            }
+        }
+        if (weave) {
+            src = line_ring_prev_field_ptr(snes_line);
+#if ENABLE_INDEXED_LINES
+            src_palette = line_ring_prev_field_palette(snes_line);
+#endif
+        } else
+#endif
+        if (!line_ring_in_frame(snes_line)) {
+            // Tail of a 224-line frame in a 239-line window: border.
+        } else if (line_ring_ready(snes_line) || line_ring_catch_up(snes_line)) {
+            latency_sample(snes_line);
+#if ENABLE_RAW_CAPTURE_RING
+            src = raw_line_convert(snes_line);
+            src_hires = s_raw_line_width > SNES_H_ACTIVE;
+#else
             src = line_ring_read_ptr(snes_line);
+            src_hires = line_ring_read_width(snes_line) > SNES_H_ACTIVE;
+#if ENABLE_INDEXED_LINES
+            src_palette = line_ring_read_palette(snes_line);
+#endif
+#endif
         } else {
+            line_ring_count_read_miss(snes_line);
             fallback_color = NO_SIGNAL_COLOR_RGB565;
         }
     }
 
+    if (use_cache && line_cache_reuse(source_line, src, fallback_color, osd_active, dst, h_words)) {
+        return;
+    }
+
+#if ENABLE_INDEXED_LINES
+    if (src_palette && (src_hires || osd_active)) {
+        expand_indexed(s_index_line, (const uint8_t *)src, src_palette,
+                       src_hires ? SNES_H_ACTIVE_HIRES : SNES_H_ACTIVE);
+        src = s_index_line;
+        src_palette = NULL;
+    }
+#endif
+
+#if ENABLE_HIRES
+    if (src_hires && (mode_is_240p || osd_active)) {
+        blend_hires_pairs(s_hires_blend_line, src, SNES_H_ACTIVE_HIRES);
+        src = s_hires_blend_line;
+        src_hires = false;
+    }
+#else
+    (void)src_hires;
+#endif
+
 #if ENABLE_OSD
     if (osd_active) {
         if (!src) {
             fill_rgb565(dst, osd_x_words, fallback_color);
-            draw_osd_line_scaled(dst, source_line, osd_x_words, scale_pixels);
+            draw_osd_line_scaled(dst, source_line, osd_x_words, osd_scale);
             fill_rgb565(dst + osd_x_words + osd_w_words, h_words - osd_x_words - osd_w_words, fallback_color);
             return;
         }
 
         fill_rgb565(dst, image_x_words, OVERSCAN_COLOR_RGB565);
         scale_pixels(dst + image_x_words, src, OSD_BOX_X - SNES_CANVAS_H_MARGIN);
-        draw_osd_line_scaled(dst, source_line, osd_x_words, scale_pixels);
+        draw_osd_line_scaled(dst, source_line, osd_x_words, osd_scale);
         scale_pixels(dst + osd_x_words + osd_w_words,
                      src + (OSD_BOX_X + OSD_BOX_W - SNES_CANVAS_H_MARGIN),
                      SNES_CANVAS_H_MARGIN + SNES_H_ACTIVE - OSD_BOX_X - OSD_BOX_W);
@@ -187,18 +821,484 @@ void __scratch_x("") scanline_callback(uint32_t v_scanline, uint32_t active_line
     }
 
     fill_rgb565(dst, image_x_words, OVERSCAN_COLOR_RGB565);
-    scale_pixels(dst + image_x_words, src, SNES_H_ACTIVE);
+#if ENABLE_HIRES
+    if (src_hires) {
+        scale_hires_pixels(dst + image_x_words, src, SNES_H_ACTIVE_HIRES);
+    } else
+#endif
+#if ENABLE_INDEXED_LINES
+    if (src_palette) {
+        scale_indexed(dst + image_x_words, (const uint8_t *)src, src_palette, SNES_H_ACTIVE);
+    } else
+#endif
+    {
+        scale_pixels(dst + image_x_words, src, SNES_H_ACTIVE);
+    }
     fill_rgb565(dst + image_x_words + image_words, h_words - image_x_words - image_words, OVERSCAN_COLOR_RGB565);
 }
 
+static void __scratch_x("") render_2x(uint32_t active_line, uint32_t *dst)
+{
+    render_scanline(SCANLINE_SCALE_2X, false, true, active_line, dst);
+}
+
+static void __scratch_x("") render_4x(uint32_t active_line, uint32_t *dst)
+{
+    render_scanline(SCANLINE_SCALE_4X, false, false, active_line, dst);
+}
+
+static void __scratch_x("") render_3x(uint32_t active_line, uint32_t *dst)
+{
+    render_scanline(SCANLINE_SCALE_3X, false, true, active_line, dst);
+}
+
+#if ENABLE_OSD
+// Only while the menu is up: main SRAM, leaving scratch X to the above.
+static void __not_in_flash_func(render_2x_osd)(uint32_t active_line, uint32_t *dst)
+{
+    render_scanline(SCANLINE_SCALE_2X, true, true, active_line, dst);
+}
+
+static void __not_in_flash_func(render_4x_osd)(uint32_t active_line, uint32_t *dst)
+{
+    render_scanline(SCANLINE_SCALE_4X, true, false, active_line, dst);
+}
+
+static void __not_in_flash_func(render_3x_osd)(uint32_t active_line, uint32_t *dst)
+{
+    render_scanline(SCANLINE_SCALE_3X, true, true, active_line, dst);
+}
+#else
+#define render_2x_osd render_2x
+#define render_4x_osd render_4x
+#define render_3x_osd render_3x
+#endif
+
+// 720p fill scaler: the picture window (224 rows, 239 for PAL) stretched to
+// all 720 lines and to the setting's width. Each output pixel covers
+// 256/width source pixels and each line rows/720 source rows, under one in
+// both axes: inside a source pixel it is a copy, across an edge it blends the
+// two by the share of each (in 32nds), so edges stay one pixel soft and
+// nothing else is filtered (sharp bilinear). The column table holds, per
+// source pixel, how many copies to write and the weight of the blend that
+// follows them, if any; the row table the source row and the weight of the
+// row below. Menu frames use the integer callback, and 448i sources show
+// the current field, as at 240p.
+#define FIT_LINES 720U
+#define FIT_MAX_WIDTH 960U // 4:3; under 4x, so at most three copies per source pixel
+
+typedef struct {
+    uint8_t run;    // output pixels that copy this source pixel
+    uint8_t weight; // then one pixel with this much of the next one, if nonzero
+} fit_col_t;
+
+typedef struct {
+    uint16_t row;   // window row
+    uint8_t weight; // of the row below, 0 = none
+} fit_row_t;
+
+static fit_col_t s_fit_cols[SNES_H_ACTIVE];
+static fit_row_t s_fit_rows[FIT_LINES];
+static uint16_t s_fit_line[SNES_H_ACTIVE] __attribute__((aligned(4)));
+static uint16_t s_fit_below[SNES_H_ACTIVE] __attribute__((aligned(4)));
+
+// 5-bit blend of two RGB565 pixels: each spread over a word with gaps wide
+// enough to take the multiply.
+static inline uint32_t blend_rgb565(uint32_t a, uint32_t b, uint32_t weight)
+{
+    a = (a | (a << 16)) & 0x07E0F81FU;
+    b = (b | (b << 16)) & 0x07E0F81FU;
+    const uint32_t m = (((a * (32U - weight)) + (b * weight)) >> 5) & 0x07E0F81FU;
+    return (m | (m >> 16)) & 0xFFFFU;
+}
+
+// Two pixels per word: the fields of one mask, then those of the other
+// shifted down into the same gaps.
+static inline void blend_lines(uint16_t *dst, const uint16_t *a, const uint16_t *b, uint32_t weight)
+{
+    const uint32_t *a32 = (const uint32_t *)a;
+    const uint32_t *b32 = (const uint32_t *)b;
+    uint32_t *dst32 = (uint32_t *)dst;
+    const uint32_t inv = 32U - weight;
+
+    for (uint32_t i = 0; i < SNES_H_ACTIVE / 2U; i++) {
+        const uint32_t x = a32[i];
+        const uint32_t y = b32[i];
+        const uint32_t lo = ((((x & 0x07E0F81FU) * inv) + ((y & 0x07E0F81FU) * weight)) >> 5) & 0x07E0F81FU;
+        const uint32_t hi = ((((x >> 5) & 0x07C0F83FU) * inv) + (((y >> 5) & 0x07C0F83FU) * weight)) & 0xF81F07E0U;
+        dst32[i] = lo | hi;
+    }
+}
+
+static inline void fit_pixels(uint16_t *dst, const uint16_t *src)
+{
+    for (uint32_t i = 0; i < SNES_H_ACTIVE; i++) {
+        const uint32_t c = src[i];
+        const fit_col_t col = s_fit_cols[i];
+        // Always three copies; any past the run are written over next.
+        dst[0] = (uint16_t)c;
+        dst[1] = (uint16_t)c;
+        dst[2] = (uint16_t)c;
+        dst += col.run;
+        if (col.weight != 0U) {
+            *dst++ = (uint16_t)blend_rgb565(c, src[i + 1U], col.weight);
+        }
+    }
+}
+
+// Canvas row `source_line` of the frame scanned out at 256 px, or NULL with
+// the colour to show instead. Hires lines are averaged into `buf`, and
+// indexed lines expanded into it.
+static inline const uint16_t *fit_source(uint32_t source_line, uint16_t *fallback_color, uint16_t *buf)
+{
+    const uint32_t snes_line_u32 = source_line - s_source_top;
+    if (source_line >= SNES_CANVAS_HEIGHT || snes_line_u32 >= s_source_lines) {
+        return NULL;
+    }
+    const uint16_t snes_line = (uint16_t)snes_line_u32;
+    if (s_no_signal) {
+        *fallback_color = NO_SIGNAL_COLOR_RGB565;
+        return NULL;
+    }
+    if (!line_ring_in_frame(snes_line)) {
+        return NULL;
+    }
+    if (!line_ring_ready(snes_line) && !line_ring_catch_up(snes_line)) {
+        line_ring_count_read_miss(snes_line);
+        *fallback_color = NO_SIGNAL_COLOR_RGB565;
+        return NULL;
+    }
+    latency_sample(snes_line);
+#if ENABLE_RAW_CAPTURE_RING
+    const uint16_t *src = raw_line_convert(snes_line);
+    const bool hires = s_raw_line_width > SNES_H_ACTIVE;
+#else
+    const uint16_t *src = line_ring_read_ptr(snes_line);
+    const bool hires = line_ring_read_width(snes_line) > SNES_H_ACTIVE;
+#endif
+#if ENABLE_INDEXED_LINES
+    const uint16_t *palette = line_ring_read_palette(snes_line);
+    if (palette && !hires) {
+        expand_indexed(buf, (const uint8_t *)src, palette, SNES_H_ACTIVE);
+        return buf;
+    }
+    if (palette) {
+        expand_indexed(s_index_line, (const uint8_t *)src, palette, SNES_H_ACTIVE_HIRES);
+        src = s_index_line;
+    }
+#endif
+#if ENABLE_HIRES
+    if (hires) {
+        blend_hires_pairs(buf, src, SNES_H_ACTIVE_HIRES);
+        return buf;
+    }
+#else
+    (void)hires;
+    (void)buf;
+#endif
+    return src;
+}
+
+// The row below can be blended in without waiting on Core 0.
+static inline bool fit_source_ready(uint32_t source_line)
+{
+    const uint32_t snes_line_u32 = source_line - s_source_top;
+    return source_line < SNES_CANVAS_HEIGHT && snes_line_u32 < s_source_lines &&
+           line_ring_in_frame((uint16_t)snes_line_u32) && line_ring_ready((uint16_t)snes_line_u32);
+}
+
+static void __not_in_flash_func(render_3x_fit)(uint32_t active_line, uint32_t *dst)
+{
+    if (active_line == s_plan.first_line) {
+        latch_source_frame();
+    } else if (active_line == s_race_latch_line) {
+        race_latch_source_frame();
+    }
+
+    const uint32_t h_words = s_plan.h_words;
+    const fit_row_t row = s_fit_rows[active_line];
+    const uint32_t source_line = s_plan.fit_top + row.row;
+    uint16_t fallback_color = OVERSCAN_COLOR_RGB565;
+    const uint16_t *src = fit_source(source_line, &fallback_color, s_fit_line);
+    uint32_t weight = row.weight;
+    if (!src || (weight != 0U && !fit_source_ready(source_line + 1U))) {
+        weight = 0U;
+    }
+
+    if (line_cache_reuse((source_line << 5) | weight, src, fallback_color, false, dst, h_words)) {
+        return;
+    }
+    if (!src) {
+        fill_rgb565(dst, h_words, fallback_color);
+        return;
+    }
+    if (weight != 0U) {
+        if (src != s_fit_line) {
+            // The row below may take the raw ring's conversion buffer.
+            memcpy(s_fit_line, src, sizeof(s_fit_line));
+        }
+        const uint16_t *below = fit_source(source_line + 1U, &fallback_color, s_fit_below);
+        blend_lines(s_fit_line, s_fit_line, below, weight);
+        src = s_fit_line;
+    }
+
+    const uint32_t x_words = s_plan.fit_x_words;
+    const uint32_t w_words = s_plan.fit_w_words;
+    fill_rgb565(dst, x_words, OVERSCAN_COLOR_RGB565);
+    fit_pixels((uint16_t *)(dst + x_words), src);
+    fill_rgb565(dst + x_words + w_words, h_words - x_words - w_words, OVERSCAN_COLOR_RGB565);
+}
+
+// Output width for a fill setting with the window `rows` tall: 256 pixels
+// at the height's scale times the pixel aspect, or 4:3 of the height, in
+// whole words on either side.
+static uint32_t fit_width(video_pipeline_scaler_t scaler, uint32_t rows)
+{
+    uint32_t width;
+    switch (scaler) {
+    case VIDEO_PIPELINE_SCALER_8_7:
+        width = (SNES_H_ACTIVE * 8U * FIT_LINES) / (7U * rows);
+        break;
+    case VIDEO_PIPELINE_SCALER_4_3:
+        width = (FIT_LINES * 4U) / 3U;
+        break;
+    default:
+        width = (SNES_H_ACTIVE * FIT_LINES) / rows;
+        break;
+    }
+    width = (width + 2U) & ~3U;
+    return (width > FIT_MAX_WIDTH) ? FIT_MAX_WIDTH : width;
+}
+
+// Share of the far source pixel in an output pixel ending `over` past the
+// edge, in 32nds of an output pixel `step` long; 0 or 32 make it a copy.
+static inline uint32_t fit_edge_weight(uint32_t over, uint32_t step)
+{
+    return ((over * 32U) + (step / 2U)) / step;
+}
+
+static void __not_in_flash_func(fit_tables_build)(uint32_t width, uint32_t rows)
+{
+    // Positions in 1/width source pixels and 1/720 source rows.
+    memset(s_fit_cols, 0, sizeof(s_fit_cols));
+    for (uint32_t x = 0; x < width; x++) {
+        const uint32_t start = x * SNES_H_ACTIVE;
+        const uint32_t i = start / width;
+        const uint32_t edge = (i + 1U) * width;
+        const uint32_t end = start + SNES_H_ACTIVE;
+        const uint32_t weight = (end > edge) ? fit_edge_weight(end - edge, SNES_H_ACTIVE) : 0U;
+        if (weight == 0U) {
+            s_fit_cols[i].run++;
+        } else if (weight == 32U) {
+            s_fit_cols[i + 1U].run++;
+        } else {
+            s_fit_cols[i].weight = (uint8_t)weight;
+        }
+    }
+    for (uint32_t y = 0; y < FIT_LINES; y++) {
+        const uint32_t start = y * rows;
+        const uint32_t r = start / FIT_LINES;
+        const uint32_t edge = (r + 1U) * FIT_LINES;
+        const uint32_t end = start + rows;
+        const uint32_t weight = (end > edge) ? fit_edge_weight(end - edge, rows) : 0U;
+        s_fit_rows[y].row = (uint16_t)((weight == 32U) ? r + 1U : r);
+        s_fit_rows[y].weight = (uint8_t)((weight == 32U) ? 0U : weight);
+    }
+}
+
+static const scanline_render_fn_t s_render_fns[SCANLINE_SCALE_COUNT][2] = {
+    [SCANLINE_SCALE_2X] = {render_2x, render_2x_osd},
+    [SCANLINE_SCALE_4X] = {render_4x, render_4x_osd},
+    [SCANLINE_SCALE_3X] = {render_3x, render_3x_osd},
+};
+
+static void scanline_plan_install(uint32_t active_line, uint32_t *dst);
+static scanline_render_fn_t s_render = scanline_plan_install;
+
+static void __not_in_flash_func(scanline_plan_build)(const video_mode_t *mode)
+{
+    const uint32_t v_active = mode->v_active_lines;
+    const scanline_scale_t scale = (v_active == 720U) ? SCANLINE_SCALE_3X
+                                   : (v_active <= 288U) ? SCANLINE_SCALE_4X
+                                                        : SCANLINE_SCALE_2X;
+    const uint32_t h_scale = SCANLINE_H_SCALE(scale);
+    const uint32_t lines_per_row = (scale == SCANLINE_SCALE_3X) ? 3U : (scale == SCANLINE_SCALE_4X) ? 1U : 2U;
+    const uint32_t mode_rows = v_active / lines_per_row;
+    const uint32_t h_words = mode->h_active_pixels / 2U;
+    const uint32_t canvas_words = (SNES_CANVAS_WIDTH * h_scale) / 2U;
+    const uint32_t canvas_margin_words = (h_words > canvas_words) ? ((h_words - canvas_words) / 2U) : 0U;
+
+    s_plan.scale = scale;
+    s_plan.row_offset = (mode_rows - SNES_CANVAS_HEIGHT) / 2U;
+    s_plan.first_line = s_plan.row_offset * lines_per_row;
+    s_plan.lines_per_row = lines_per_row;
+    s_plan.h_words = h_words;
+    s_plan.image_x_words = canvas_margin_words + ((SNES_CANVAS_H_MARGIN * h_scale) / 2U);
+#if ENABLE_OSD
+    s_plan.osd_x_words = canvas_margin_words + (((uint32_t)OSD_BOX_X * h_scale) / 2U);
+#endif
+    s_plan.scaler = s_scaler_latched;
+    s_plan.fit = (scale == SCANLINE_SCALE_3X) && (s_scaler_latched != VIDEO_PIPELINE_SCALER_INTEGER);
+    if (s_plan.fit) {
+        const uint32_t rows = SNES_REGION_V_ACTIVE(s_region);
+        const uint32_t width = fit_width(s_scaler_latched, rows);
+        fit_tables_build(width, rows);
+        s_plan.fit_top = (SNES_CANVAS_HEIGHT - rows) / 2U;
+        s_plan.fit_w_words = width / 2U;
+        s_plan.fit_x_words = (h_words - s_plan.fit_w_words) / 2U;
+    }
+    s_plan.mode = mode;
+}
+
+// At vsync, and in place of the callback until the first one has run.
+static void __not_in_flash_func(scanline_plan_select)(void)
+{
+    if (s_plan.mode != video_output_active_mode || s_plan.scaler != s_scaler_latched) {
+        scanline_plan_build(video_output_active_mode);
+    }
+    s_render = (s_plan.fit && !s_osd_visible_latched) ? render_3x_fit
+                                                      : s_render_fns[s_plan.scale][s_osd_visible_latched ? 1 : 0];
+}
+
+static void __not_in_flash_func(scanline_plan_install)(uint32_t active_line, uint32_t *dst)
+{
+    scanline_plan_select();
+    s_render(active_line, dst);
+}
+
+void __scratch_x("") scanline_callback(uint32_t v_scanline, uint32_t active_line, uint32_t *dst)
+{
+    (void)v_scanline;
+    const uint32_t start = m33_hw->dwt_cyccnt;
+    s_render(active_line, dst);
+    const uint32_t cycles = m33_hw->dwt_cyccnt - start;
+    if (cycles > s_scanline_max_cycles) {
+        s_scanline_max_cycles = cycles;
+    }
+}
+
+uint32_t video_pipeline_take_scanline_max_cycles(void)
+{
+    const uint32_t cycles = s_scanline_max_cycles;
+    s_scanline_max_cycles = 0;
+    return cycles;
+}
+
+uint32_t video_pipeline_get_ring_overruns(void)
+{
+    return g_line_ring.read_overruns;
+}
+
+uint32_t video_pipeline_get_ring_not_ready(void)
+{
+    return g_line_ring.read_not_ready;
+}
+
+uint32_t video_pipeline_get_frames_dropped(void)
+{
+    return g_line_ring.frames_dropped;
+}
+
+uint32_t video_pipeline_get_frames_repeated(void)
+{
+    return g_line_ring.frames_repeated;
+}
+
+uint32_t video_pipeline_get_ring_bytes(void)
+{
+    return (uint32_t)sizeof(g_line_ring);
+}
+
+// Benchmark reference: the same body with the scale and OSD state read on
+// every line rather than compiled in, as one callback for all modes has to,
+// and no line cache.
+static void render_generic(uint32_t active_line, uint32_t *dst)
+{
+    render_scanline(s_plan.scale, s_osd_visible_latched, false, active_line, dst);
+}
+
+void video_pipeline_bench_scanline(uint32_t active_line, uint32_t *dst, bool osd,
+                                   video_pipeline_bench_path_t path)
+{
+    const bool osd_was_visible = s_osd_visible_latched;
+    s_osd_visible_latched = osd && ENABLE_OSD;
+    s_scaler_latched = s_scaler_mode;
+    scanline_plan_select();
+    if (active_line == 0U || path == VIDEO_PIPELINE_BENCH_UNCACHED) {
+        s_line_cache.valid = false;
+    }
+    if (path == VIDEO_PIPELINE_BENCH_GENERIC) {
+        render_generic(active_line, dst);
+    } else {
+        s_render(active_line, dst);
+    }
+    s_osd_visible_latched = osd_was_visible;
+    scanline_plan_select();
+}
+
+#if ENABLE_OSD && ENABLE_INDEXED_OSD
+void video_pipeline_bench_osd_row(uint32_t scale, bool copy, uint32_t *dst, uint32_t osd_y, const uint16_t *rgb565_row)
+{
+    switch (scale) {
+    case 3U:
+        if (copy) {
+            triple_pixels_fast(dst, rgb565_row, OSD_BOX_W);
+        } else {
+            draw_osd_line_scaled(dst, OSD_BOX_Y + osd_y, 0U, 3U);
+        }
+        break;
+    case 4U:
+        if (copy) {
+            quadruple_pixels_fast(dst, rgb565_row, OSD_BOX_W);
+        } else {
+            draw_osd_line_scaled(dst, OSD_BOX_Y + osd_y, 0U, 4U);
+        }
+        break;
+    default:
+        if (copy) {
+            double_pixels_fast(dst, rgb565_row, OSD_BOX_W);
+        } else {
+            draw_osd_line_scaled(dst, OSD_BOX_Y + osd_y, 0U, 2U);
+        }
+        break;
+    }
+}
+#endif
+
 void __scratch_x("") vsync_callback(void) {
-    line_ring_output_vsync();
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+#if ENABLE_GENLOCK
+#if !ENABLE_RAW_CAPTURE_RING
+    race_vsync(s_latency_frame_min_us);
+#endif
+    genlock_vsync();
+#endif
+    s_latency_frame_min_us = UINT32_MAX;
+    const bool frame_buffered = LINE_RING_FRAME_BUFFERS && s_latency_mode == VIDEO_PIPELINE_LATENCY_FRAME;
+    if (frame_buffered) {
+        line_ring_output_vsync_frame();
+    } else {
+        line_ring_output_vsync();
+    }
+#if ENABLE_INTERLACE && ENABLE_RAW_CAPTURE_RING
+    // The raw ring holds one field at capture width, not the pair weave needs.
+    s_deinterlace_latched = VIDEO_PIPELINE_DEINTERLACE_BOB;
+#elif ENABLE_INTERLACE
+    // Whole frames hold one field at a time.
+    s_deinterlace_latched = frame_buffered ? VIDEO_PIPELINE_DEINTERLACE_BOB : s_deinterlace_mode;
+#else
+    (void)frame_buffered;
+#endif
 #if ENABLE_AUDIO
     audio_pipeline_step();
 #endif
 #if ENABLE_OSD
     s_osd_visible_latched = osd_visible;
 #endif
+    s_scaler_latched = s_scaler_mode;
+    scanline_plan_select();
+    s_line_cache.valid = false;
 }
 
 #if ENABLE_REBOOT_MODE_SWITCH
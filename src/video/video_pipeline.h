@@ -5,12 +5,117 @@
 #include <stdint.h>
 #include "video_config.h"
 #include "line_ring.h"
+#include "snes_timing.h"
 #include "config.h"
 
 void video_pipeline_init(void);
 void scanline_callback(uint32_t v_scanline, uint32_t active_line, uint32_t *dst);
 void vsync_callback(void);
 
+// Slowest scanline_callback since the previous call, in Core 1 cycles.
+uint32_t video_pipeline_take_scanline_max_cycles(void);
+
+// Output lines scanout lost since boot because the line ring did not hold
+// them: lapped by Core 0 before Core 1 read them (LINE_RING_SIZE too shallow
+// for the mode), or not yet written. Also the ring's SRAM in bytes: its
+// storage plus per-line widths or descriptors and commit stamps.
+uint32_t video_pipeline_get_ring_overruns(void);
+uint32_t video_pipeline_get_ring_not_ready(void);
+uint32_t video_pipeline_get_ring_bytes(void);
+
+// Scanline benchmark: render one output line of the active mode with the OSD
+// open or closed. Lines go in order from 0, as scanout asks for them. Not
+// while Core 1 is scanning out.
+typedef enum {
+    VIDEO_PIPELINE_BENCH_INSTALLED, // the mode's callback, as scanned out
+    VIDEO_PIPELINE_BENCH_UNCACHED,  // same, with every line rendered in full
+    VIDEO_PIPELINE_BENCH_GENERIC,   // unspecialised body, no line cache
+} video_pipeline_bench_path_t;
+
+void video_pipeline_bench_scanline(uint32_t active_line, uint32_t *dst, bool osd,
+                                   video_pipeline_bench_path_t path);
+
+#if ENABLE_OSD && ENABLE_INDEXED_OSD
+// OSD row benchmark: row `osd_y` of the OSD box at 2x, 3x or 4x, expanded
+// from the text grid as scanout does, or (copy) scaled from the same row
+// pre-rendered in RGB565, as the framebuffer OSD scans out.
+void video_pipeline_bench_osd_row(uint32_t scale, bool copy, uint32_t *dst, uint32_t osd_y, const uint16_t *rgb565_row);
+#endif
+
+// Console region detected at boot: selects the 224- or 239-line capture
+// window the scanline callback centres.
+void video_pipeline_set_region(snes_region_t region);
+snes_region_t video_pipeline_get_region(void);
+
+#if ENABLE_INTERLACE
+// How 448i sources are shown in 480p/720p; latched at output vsync.
+typedef enum {
+    VIDEO_PIPELINE_DEINTERLACE_WEAVE = 0, // both fields, full 448 lines
+    VIDEO_PIPELINE_DEINTERLACE_BOB = 1,   // current field line-doubled, no combing
+} video_pipeline_deinterlace_t;
+
+void video_pipeline_set_deinterlace(video_pipeline_deinterlace_t mode);
+video_pipeline_deinterlace_t video_pipeline_get_deinterlace(void);
+#endif
+
+// 720p picture size; latched at output vsync. The fill settings stretch the
+// 224-line window (239 for PAL) to all 720 lines with sharp bilinear edges;
+// the menu is drawn over the integer picture.
+typedef enum {
+    VIDEO_PIPELINE_SCALER_INTEGER = 0, // 3x, 768x672
+    VIDEO_PIPELINE_SCALER_SQUARE = 1,  // fill, square pixels (824x720)
+    VIDEO_PIPELINE_SCALER_8_7 = 2,     // fill, 8:7 pixels (940x720)
+    VIDEO_PIPELINE_SCALER_4_3 = 3,     // fill, 4:3 picture (960x720)
+    VIDEO_PIPELINE_SCALER_COUNT
+} video_pipeline_scaler_t;
+
+void video_pipeline_set_scaler(video_pipeline_scaler_t mode);
+video_pipeline_scaler_t video_pipeline_get_scaler(void);
+
+// How far scanout trails capture; latched at output vsync. LOW reads the
+// line ring a few lines behind Core 0 and can tear when the two frame rates
+// drift past each other. FRAME ("safe") shows only whole frames, one frame
+// later, dropping or repeating a frame instead (needs LINE_RING_FRAME_BUFFERS;
+// hires lines are averaged and 448i shown as bob). RACE reads the line ring
+// too, with the genlock holding the output LATENCY_RACE_LINES SNES lines
+// behind capture (needs ENABLE_GENLOCK, and not the raw ring). Unsupported
+// modes fall back to LOW.
+typedef enum {
+    VIDEO_PIPELINE_LATENCY_LOW = 0,   // line ring, a few lines
+    VIDEO_PIPELINE_LATENCY_FRAME = 1, // whole frames, no tearing
+    VIDEO_PIPELINE_LATENCY_RACE = 2,  // line ring, phase-locked close behind
+    VIDEO_PIPELINE_LATENCY_COUNT
+} video_pipeline_latency_t;
+
+bool video_pipeline_latency_supported(video_pipeline_latency_t mode);
+void video_pipeline_set_latency(video_pipeline_latency_t mode);
+video_pipeline_latency_t video_pipeline_get_latency(void);
+
+// Capture-to-scanout latency: for each source line, the time from Core 0
+// committing it to Core 1 first reading it for an output frame (not with
+// the raw ring, whose lines land by DMA).
+typedef struct {
+    uint32_t lines;  // lines measured
+    uint32_t min_us; // 0 when none were
+    uint32_t avg_us;
+    uint32_t max_us;
+} video_pipeline_latency_stats_t;
+
+#define VIDEO_PIPELINE_LATENCY_BINS 64U
+#define VIDEO_PIPELINE_LATENCY_BIN_US 512U // the last bin takes the rest
+
+// Since boot, and since the previous take.
+void video_pipeline_get_latency_stats(video_pipeline_latency_stats_t *out);
+void video_pipeline_take_latency_stats(video_pipeline_latency_stats_t *out);
+
+// Lines per VIDEO_PIPELINE_LATENCY_BIN_US-wide bin since boot.
+const uint32_t *video_pipeline_get_latency_histogram(void);
+
+// Frame-buffered scanout since boot: frames Core 0 finished that were never
+// shown, and output frames that showed the previous one again.
+uint32_t video_pipeline_get_frames_dropped(void);
+uint32_t video_pipeline_get_frames_repeated(void);
+
 #if ENABLE_REBOOT_MODE_SWITCH
 typedef enum {
     VIDEO_PIPELINE_REBOOT_MODE_480P = 0,